@@ -338,6 +338,25 @@ struct file_event_handlers {
     std::function<void(const filename_t &filename)> after_close;
 };
 
+//* @log4sp hack *//
+// Called by the rotating and daily file sinks when a file is rotated out, e.g. to compress it
+// on a background thread.
+// rotating_file_sink: the current file is renamed to a unique temporary name and passed to
+//     on_rotated, which then owns it and is responsible for moving it into the rotation chain.
+//     Temporary files left over by a crash are passed to on_rotated when the sink is created.
+// daily_file_sink: the closed file is passed to on_rotated. When scanning and deleting old
+//     files, "filename + archived_ext" is considered as well. If on_remove is set, deleting
+//     an old file and its archive is handed to it, so it can run after a pending on_rotated.
+struct rotated_file_handlers {
+    rotated_file_handlers()
+        : on_rotated(nullptr),
+          on_remove(nullptr) {}
+
+    std::function<void(const filename_t &filename)> on_rotated;
+    std::function<void(const filename_t &filename)> on_remove;
+    filename_t archived_ext;
+};
+
 namespace details {
 
 // to_string_view
@@ -71,6 +71,9 @@ SPDLOG_INLINE void file_helper::reopen(bool truncate) {
 }
 
 SPDLOG_INLINE void file_helper::flush() {
+    if (!write_pending_()) {
+        throw_spdlog_ex("Failed writing to file " + os::filename_to_str(filename_), errno);
+    }
     if (std::fflush(fd_) != 0) {
         throw_spdlog_ex("Failed flush to file " + os::filename_to_str(filename_), errno);
     }
@@ -84,6 +87,8 @@ SPDLOG_INLINE void file_helper::sync() {
 
 SPDLOG_INLINE void file_helper::close() {
     if (fd_ != nullptr) {
+        write_pending_();   //* @log4sp hack *// errors are ignored, like fclose's
+
         if (event_handlers_.before_close) {
             event_handlers_.before_close(filename_, fd_);
         }
@@ -99,6 +104,22 @@ SPDLOG_INLINE void file_helper::close() {
 
 SPDLOG_INLINE void file_helper::write(const memory_buf_t &buf) {
     if (fd_ == nullptr) return;
+
+    //* @log4sp hack *//
+    if (buffer_size_ > 0) {
+        if (pending_.size() == 0) {
+            pending_since_ = std::chrono::steady_clock::now();
+        }
+        pending_.append(buf.begin(), buf.end());
+
+        if (pending_.size() >= buffer_size_ ||
+            (flush_interval_.count() > 0 &&
+             std::chrono::steady_clock::now() - pending_since_ >= flush_interval_)) {
+            flush();
+        }
+        return;
+    }
+
     size_t msg_size = buf.size();
     auto data = buf.data();
 
@@ -107,11 +128,35 @@ SPDLOG_INLINE void file_helper::write(const memory_buf_t &buf) {
     }
 }
 
+//* @log4sp hack *//
+SPDLOG_INLINE void file_helper::set_write_buffer(size_t buffer_size,
+                                                 std::chrono::milliseconds flush_interval) {
+    if (fd_ != nullptr && pending_.size() > 0) {
+        flush();
+    }
+    buffer_size_ = buffer_size;
+    flush_interval_ = flush_interval;
+    pending_.clear();
+    if (buffer_size_ > 0) {
+        pending_.reserve(buffer_size_);
+    }
+}
+
+//* @log4sp hack *//
+SPDLOG_INLINE bool file_helper::write_pending_() {
+    if (pending_.size() == 0) {
+        return true;
+    }
+    bool ok = details::os::fwrite_bytes(pending_.data(), pending_.size(), fd_);
+    pending_.clear();
+    return ok;
+}
+
 SPDLOG_INLINE size_t file_helper::size() const {
     if (fd_ == nullptr) {
         throw_spdlog_ex("Cannot use size() on closed file " + os::filename_to_str(filename_));
     }
-    return os::filesize(fd_);
+    return os::filesize(fd_) + pending_.size();     //* @log4sp hack *//
 }
 
 SPDLOG_INLINE const filename_t &file_helper::filename() const { return filename_; }
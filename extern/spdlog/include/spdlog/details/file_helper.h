@@ -4,6 +4,7 @@
 #pragma once
 
 #include <spdlog/common.h>
+#include <chrono>
 #include <tuple>
 
 namespace spdlog {
@@ -31,6 +32,19 @@ public:
     size_t size() const;
     const filename_t &filename() const;
 
+    //* @log4sp hack *//
+    // Keep writes in a user-space buffer and hand them to the file in one fwrite + fflush
+    // once buffer_size bytes have accumulated, or once the oldest buffered write is older
+    // than flush_interval (checked on write and by write_buffer_due). buffer_size == 0 disables the buffer.
+    void set_write_buffer(size_t buffer_size, std::chrono::milliseconds flush_interval);
+    size_t write_buffer_size() const { return buffer_size_; }
+    std::chrono::milliseconds write_buffer_interval() const { return flush_interval_; }
+    // return true if the oldest buffered write is older than flush_interval,
+    // lets the owner flush an idle file that receives no more writes
+    bool write_buffer_due(std::chrono::steady_clock::time_point now) const {
+        return flush_interval_.count() > 0 && pending_.size() > 0 && now - pending_since_ >= flush_interval_;
+    }
+
     //
     // return file path and its extension:
     //
@@ -52,6 +66,13 @@ private:
     std::FILE *fd_{nullptr};
     filename_t filename_;
     file_event_handlers event_handlers_;
+
+    //* @log4sp hack *//
+    bool write_pending_();
+    size_t buffer_size_{0};
+    std::chrono::milliseconds flush_interval_{0};
+    std::chrono::steady_clock::time_point pending_since_;
+    memory_buf_t pending_;
 };
 }  // namespace details
 }  // namespace spdlog
@@ -147,6 +147,45 @@ public:
 
 #endif
 
+    //* @log4sp hack *//
+    // 以下方法返回入队后的队列长度 (未入队时返回 0)，用于统计最大队列长度，不需要再次加锁调用 size()
+    // 为了兼容 mingw，在释放锁之前通知
+
+    // try to enqueue and block if no room left
+    size_t log4sp_enqueue(T &&item) {
+        std::unique_lock<std::mutex> lock(queue_mutex_);
+        pop_cv_.wait(lock, [this] { return !this->q_.full(); });
+        q_.push_back(std::move(item));
+        push_cv_.notify_one();
+        return q_.size();
+    }
+
+    // enqueue immediately. overrun oldest message in the queue if no room left.
+    // the overrun message is moved to overwritten, so the caller can tell what kind of message was lost.
+    size_t log4sp_enqueue_nowait(T &&item, T &overwritten, bool &overrun) {
+        std::unique_lock<std::mutex> lock(queue_mutex_);
+        overrun = q_.full();
+        if (overrun) {
+            overwritten = std::move(q_.front());
+            q_.pop_front();
+        }
+        q_.push_back(std::move(item));
+        push_cv_.notify_one();
+        return q_.size();
+    }
+
+    // enqueue immediately. discard the new message if no room left.
+    size_t log4sp_enqueue_if_have_room(T &&item) {
+        std::unique_lock<std::mutex> lock(queue_mutex_);
+        if (q_.full()) {
+            ++discard_counter_;
+            return 0;
+        }
+        q_.push_back(std::move(item));
+        push_cv_.notify_one();
+        return q_.size();
+    }
+
     size_t overrun_counter() {
         std::lock_guard<std::mutex> lock(queue_mutex_);
         return q_.overrun_counter();
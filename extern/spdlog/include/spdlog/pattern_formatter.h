@@ -89,6 +89,16 @@ public:
     void set_pattern(std::string pattern);
     void need_localtime(bool need = true);
 
+    //* @log4sp hack *//
+    // 返回 true 表示两个 formatter 对同一条消息的格式化结果相同 (用于 logger 的共享格式化)
+    // 自定义 flag 的 formatter 无法比较，总是返回 false
+    [[nodiscard]] bool same_pattern(const pattern_formatter &other) const {
+        return custom_handlers_.empty() && other.custom_handlers_.empty() &&
+               pattern_time_type_ == other.pattern_time_type_ &&
+               need_localtime_ == other.need_localtime_ &&
+               pattern_ == other.pattern_ && eol_ == other.eol_;
+    }
+
 private:
     std::string pattern_;
     std::string eol_;
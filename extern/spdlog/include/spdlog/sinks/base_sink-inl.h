@@ -66,3 +66,24 @@ template <typename Mutex>
     formatter_->format(log_msg, formatted);
     return fmt_lib::to_string(formatted);
 }
+
+//* @log4sp hack *//
+template <typename Mutex>
+[[nodiscard]] std::unique_ptr<spdlog::formatter> SPDLOG_INLINE spdlog::sinks::base_sink<Mutex>::clone_formatter() {
+    std::lock_guard<Mutex> lock(mutex_);
+    return formatter_->clone();
+}
+
+//* @log4sp hack *//
+template <typename Mutex>
+void SPDLOG_INLINE spdlog::sinks::base_sink<Mutex>::log_formatted(const details::log_msg &msg, const memory_buf_t &formatted) {
+    std::lock_guard<Mutex> lock(mutex_);
+    sink_formatted_(msg, formatted);
+}
+
+//* @log4sp hack *//
+template <typename Mutex>
+void SPDLOG_INLINE spdlog::sinks::base_sink<Mutex>::sink_formatted_(const details::log_msg &msg, const memory_buf_t &formatted) {
+    (void)formatted;
+    sink_it_(msg);
+}
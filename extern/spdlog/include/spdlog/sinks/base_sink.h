@@ -35,6 +35,8 @@ public:
 
     //* @log4sp hack *//
     [[nodiscard]] std::string to_pattern(const details::log_msg &log_msg) final override;
+    [[nodiscard]] std::unique_ptr<spdlog::formatter> clone_formatter() final override;
+    void log_formatted(const details::log_msg &msg, const memory_buf_t &formatted) final override;
 
 protected:
     // sink formatter
@@ -45,6 +47,10 @@ protected:
     virtual void flush_() = 0;
     virtual void set_pattern_(const std::string &pattern);
     virtual void set_formatter_(std::unique_ptr<spdlog::formatter> sink_formatter);
+
+    //* @log4sp hack *//
+    // 重写 accepts_formatted 的 sink 需要同时重写此方法，直接写入已格式化的消息
+    virtual void sink_formatted_(const details::log_msg &msg, const memory_buf_t &formatted);
 };
 }  // namespace sinks
 }  // namespace spdlog
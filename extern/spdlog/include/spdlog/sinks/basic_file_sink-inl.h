@@ -36,6 +36,13 @@ template <typename Mutex>
 SPDLOG_INLINE void basic_file_sink<Mutex>::sink_it_(const details::log_msg &msg) {
     memory_buf_t formatted;
     base_sink<Mutex>::formatter_->format(msg, formatted);
+    sink_formatted_(msg, formatted);
+}
+
+//* @log4sp hack *//
+template <typename Mutex>
+SPDLOG_INLINE void basic_file_sink<Mutex>::sink_formatted_(const details::log_msg &msg, const memory_buf_t &formatted) {
+    (void)msg;
     file_helper_.write(formatted);
 }
 
@@ -25,10 +25,34 @@ public:
     const filename_t &filename() const;
     void truncate();
 
+    //* @log4sp hack *//
+    [[nodiscard]] bool accepts_formatted() const override { return true; }
+
+    //* @log4sp hack *//
+    void set_write_buffer(size_t buffer_size, std::chrono::milliseconds flush_interval) {
+        std::lock_guard<Mutex> lock(base_sink<Mutex>::mutex_);
+        file_helper_.set_write_buffer(buffer_size, flush_interval);
+    }
+    size_t write_buffer_size() {
+        std::lock_guard<Mutex> lock(base_sink<Mutex>::mutex_);
+        return file_helper_.write_buffer_size();
+    }
+    std::chrono::milliseconds write_buffer_interval() {
+        std::lock_guard<Mutex> lock(base_sink<Mutex>::mutex_);
+        return file_helper_.write_buffer_interval();
+    }
+    bool write_buffer_due(std::chrono::steady_clock::time_point now) {
+        std::lock_guard<Mutex> lock(base_sink<Mutex>::mutex_);
+        return file_helper_.write_buffer_due(now);
+    }
+
 protected:
     void sink_it_(const details::log_msg &msg) override;
     void flush_() override;
 
+    //* @log4sp hack *//
+    void sink_formatted_(const details::log_msg &msg, const memory_buf_t &formatted) override;
+
 private:
     details::file_helper file_helper_;
 };
@@ -13,12 +13,14 @@
 #include <spdlog/fmt/fmt.h>
 #include <spdlog/sinks/base_sink.h>
 
+#include <algorithm>
 #include <chrono>
 #include <cstdio>
 #include <iomanip>
 #include <mutex>
 #include <sstream>
 #include <string>
+#include <vector>
 
 namespace spdlog {
 namespace sinks {
@@ -81,7 +83,9 @@ public:
                     //* @log4sp hack *//
                     log4sp_daily_filename_calculator calculator = [](const filename_t &filename, const tm &now_tm) {
                         return FileNameCalc::calc_filename(filename, now_tm);
-                    })
+                    },
+                    //* @log4sp hack *//
+                    const rotated_file_handlers &rotated_handlers = {})
         : base_filename_(std::move(base_filename)),
           rotation_h_(rotation_hour),
           rotation_m_(rotation_minute),
@@ -89,7 +93,8 @@ public:
           truncate_(truncate),
           max_files_(max_files),
           filenames_q_(),
-          calculator_(calculator) {
+          calculator_(calculator),
+          rotated_handlers_(rotated_handlers) {
         if (rotation_hour < 0 || rotation_hour > 23 || rotation_minute < 0 ||
             rotation_minute > 59) {
             throw_spdlog_ex("daily_file_sink: Invalid rotation time in ctor");
@@ -103,6 +108,11 @@ public:
         if (max_files_ > 0) {
             init_filenames_q_();
         }
+
+        //* @log4sp hack *//
+        if (rotated_handlers_.on_rotated) {
+            recover_rotated_(now);
+        }
     }
 
     filename_t filename() {
@@ -110,17 +120,48 @@ public:
         return file_helper_.filename();
     }
 
+    //* @log4sp hack *//
+    [[nodiscard]] bool accepts_formatted() const override { return true; }
+
+    //* @log4sp hack *//
+    void set_write_buffer(size_t buffer_size, std::chrono::milliseconds flush_interval) {
+        std::lock_guard<Mutex> lock(base_sink<Mutex>::mutex_);
+        file_helper_.set_write_buffer(buffer_size, flush_interval);
+    }
+    size_t write_buffer_size() {
+        std::lock_guard<Mutex> lock(base_sink<Mutex>::mutex_);
+        return file_helper_.write_buffer_size();
+    }
+    std::chrono::milliseconds write_buffer_interval() {
+        std::lock_guard<Mutex> lock(base_sink<Mutex>::mutex_);
+        return file_helper_.write_buffer_interval();
+    }
+    bool write_buffer_due(std::chrono::steady_clock::time_point now) {
+        std::lock_guard<Mutex> lock(base_sink<Mutex>::mutex_);
+        return file_helper_.write_buffer_due(now);
+    }
+
 protected:
     void sink_it_(const details::log_msg &msg) override {
+        memory_buf_t formatted;
+        base_sink<Mutex>::formatter_->format(msg, formatted);
+        sink_formatted_(msg, formatted);
+    }
+
+    //* @log4sp hack *//
+    void sink_formatted_(const details::log_msg &msg, const memory_buf_t &formatted) override {
         auto time = msg.time;
         bool should_rotate = time >= rotation_tp_;
         if (should_rotate) {
             auto filename = calculator_(base_filename_, now_tm(time));
+            //* @log4sp hack *//
+            auto closed = file_helper_.filename();
             file_helper_.open(filename, truncate_);
             rotation_tp_ = next_rotation_tp_();
+            if (rotated_handlers_.on_rotated && closed != filename) {
+                rotated_handlers_.on_rotated(closed);
+            }
         }
-        memory_buf_t formatted;
-        base_sink<Mutex>::formatter_->format(msg, formatted);
         file_helper_.write(formatted);
 
         // Do the cleaning only at the end because it might throw on failure.
@@ -140,7 +181,9 @@ private:
         auto now = log_clock::now();
         while (filenames.size() < max_files_) {
             auto filename = calculator_(base_filename_, now_tm(now));
-            if (!path_exists(filename)) {
+            //* @log4sp hack *//
+            if (!path_exists(filename) && !(rotated_handlers_.on_rotated &&
+                                            path_exists(filename + rotated_handlers_.archived_ext))) {
                 break;
             }
             filenames.emplace_back(filename);
@@ -151,6 +194,28 @@ private:
         }
     }
 
+    //* @log4sp hack *//
+    // the files of the days the program was not running at the rotation time (e.g. stopped on day N
+    // and started on day N+1) were never passed to on_rotated. pass the ones still uncompressed
+    // within the last max_files days (or only the previous day if max_files is 0), oldest first.
+    void recover_rotated_(log_clock::time_point now) {
+        using details::os::path_exists;
+
+        filename_t current_file = file_helper_.filename();
+        std::vector<filename_t> filenames;
+        for (size_t i = 1, days = max_files_ > 0 ? max_files_ : 1; i <= days; ++i) {
+            now -= std::chrono::hours(24);
+            auto filename = calculator_(base_filename_, now_tm(now));
+            if (filename != current_file && path_exists(filename) &&
+                std::find(filenames.begin(), filenames.end(), filename) == filenames.end()) {
+                filenames.emplace_back(filename);
+            }
+        }
+        for (auto iter = filenames.rbegin(); iter != filenames.rend(); ++iter) {
+            rotated_handlers_.on_rotated(*iter);
+        }
+    }
+
     tm now_tm(log_clock::time_point tp) {
         time_t tnow = log_clock::to_time_t(tp);
         return spdlog::details::os::localtime(tnow);
@@ -179,7 +244,18 @@ private:
         if (filenames_q_.full()) {
             auto old_filename = std::move(filenames_q_.front());
             filenames_q_.pop_front();
+            //* @log4sp hack *//
+            if (rotated_handlers_.on_remove) {
+                // the file may still be waiting for on_rotated, let the handler delete it after that
+                filenames_q_.push_back(std::move(current_file));
+                rotated_handlers_.on_remove(old_filename);
+                return;
+            }
             bool ok = remove_if_exists(old_filename) == 0;
+            //* @log4sp hack *//
+            if (ok && rotated_handlers_.on_rotated) {
+                ok = remove_if_exists(old_filename + rotated_handlers_.archived_ext) == 0;
+            }
             if (!ok) {
                 filenames_q_.push_back(std::move(current_file));
                 throw_spdlog_ex("Failed removing daily file " + filename_to_str(old_filename),
@@ -198,6 +274,7 @@ private:
     uint16_t max_files_;
     details::circular_q<filename_t> filenames_q_;
     log4sp_daily_filename_calculator calculator_;       //* @log4sp hack *//
+    rotated_file_handlers rotated_handlers_;            //* @log4sp hack *//
 };
 
 using daily_file_sink_mt = daily_file_sink<std::mutex>;
@@ -13,12 +13,15 @@
 #include <spdlog/details/null_mutex.h>
 #include <spdlog/fmt/fmt.h>
 
+#include <algorithm>
 #include <cerrno>
 #include <chrono>
 #include <ctime>
+#include <filesystem>
 #include <mutex>
 #include <string>
 #include <tuple>
+#include <vector>
 
 namespace spdlog {
 namespace sinks {
@@ -29,8 +32,11 @@ SPDLOG_INLINE rotating_file_sink<Mutex>::rotating_file_sink(
     std::size_t max_size,
     std::size_t max_files,
     bool rotate_on_open,
-    const file_event_handlers &event_handlers)
-    : base_filename_(std::move(base_filename)),
+    const file_event_handlers &event_handlers,
+    //* @log4sp hack *//
+    const rotated_file_handlers &rotated_handlers)
+    : rotated_handlers_(rotated_handlers),
+      base_filename_(std::move(base_filename)),
       max_size_(max_size),
       max_files_(max_files),
       file_helper_{event_handlers} {
@@ -41,6 +47,10 @@ SPDLOG_INLINE rotating_file_sink<Mutex>::rotating_file_sink(
     if (max_files > 200000) {
         throw_spdlog_ex("rotating sink constructor: max_files arg cannot exceed 200000");
     }
+    //* @log4sp hack *//
+    if (rotated_handlers_.on_rotated && max_files_ > 0) {
+        recover_rotated_();
+    }
     file_helper_.open(calc_filename(base_filename_, 0));
     current_size_ = file_helper_.size();  // expensive. called only once
     if (rotate_on_open && current_size_ > 0) {
@@ -79,6 +89,13 @@ template <typename Mutex>
 SPDLOG_INLINE void rotating_file_sink<Mutex>::sink_it_(const details::log_msg &msg) {
     memory_buf_t formatted;
     base_sink<Mutex>::formatter_->format(msg, formatted);
+    sink_formatted_(msg, formatted);
+}
+
+//* @log4sp hack *//
+template <typename Mutex>
+SPDLOG_INLINE void rotating_file_sink<Mutex>::sink_formatted_(const details::log_msg &msg, const memory_buf_t &formatted) {
+    (void)msg;
     auto new_size = current_size_ + formatted.size();
 
     // rotate if the new estimated file size exceeds max size.
@@ -110,6 +127,12 @@ SPDLOG_INLINE void rotating_file_sink<Mutex>::rotate_() {
     using details::os::filename_to_str;
     using details::os::path_exists;
 
+    //* @log4sp hack *//
+    if (rotated_handlers_.on_rotated) {
+        rotate_handed_off_();
+        return;
+    }
+
     file_helper_.close();
     for (auto i = max_files_; i > 0; --i) {
         filename_t src = calc_filename(base_filename_, i - 1);
@@ -136,6 +159,82 @@ SPDLOG_INLINE void rotating_file_sink<Mutex>::rotate_() {
     file_helper_.reopen(true);
 }
 
+//* @log4sp hack *//
+template <typename Mutex>
+SPDLOG_INLINE void rotating_file_sink<Mutex>::rotate_handed_off_() {
+    using details::os::filename_to_str;
+
+    file_helper_.close();
+    if (max_files_ == 0) {
+        file_helper_.reopen(true);
+        return;
+    }
+
+    // the handler may still be busy with earlier files, so every rotated file gets its own name.
+    // pid and time keep it unique across sinks of the same file and across restarts.
+    filename_t src = calc_filename(base_filename_, 0);
+    auto time = std::chrono::duration_cast<std::chrono::microseconds>(
+                    std::chrono::system_clock::now().time_since_epoch())
+                    .count();
+    filename_t target =
+        fmt_lib::format(SPDLOG_FMT_STRING(SPDLOG_FILENAME_T("{}.{}-{}-{}.rotated")), src,
+                        details::os::pid(), time, ++rotated_count_);
+    if (!rename_file_(src, target)) {
+        details::os::sleep_for_millis(100);
+        if (!rename_file_(src, target)) {
+            file_helper_.reopen(true);
+            current_size_ = 0;
+            throw_spdlog_ex("rotating_file_sink: failed renaming " + filename_to_str(src) + " to " +
+                                filename_to_str(target),
+                            errno);
+        }
+    }
+    file_helper_.reopen(true);
+    rotated_handlers_.on_rotated(target);
+}
+
+//* @log4sp hack *//
+template <typename Mutex>
+SPDLOG_INLINE void rotating_file_sink<Mutex>::recover_rotated_() {
+    namespace fs = std::filesystem;
+    auto to_filename = [](const fs::path &path) { return path.string<filename_t::value_type>(); };
+
+    filename_t src = calc_filename(base_filename_, 0);
+    filename_t dir = details::os::dir_name(src);
+    filename_t prefix = to_filename(fs::path(src).filename()) + SPDLOG_FILENAME_T(".");
+    filename_t suffix = SPDLOG_FILENAME_T(".rotated");
+
+    std::vector<std::pair<fs::file_time_type, filename_t>> leftovers;
+    std::error_code ec;
+    for (fs::directory_iterator it(dir.empty() ? fs::path(SPDLOG_FILENAME_T(".")) : fs::path(dir), ec), end;
+         !ec && it != end; it.increment(ec)) {
+        filename_t name = to_filename(it->path().filename());
+        if (name.size() <= prefix.size() + suffix.size() ||
+            name.compare(0, prefix.size(), prefix) != 0 ||
+            name.compare(name.size() - suffix.size(), suffix.size(), suffix) != 0) {
+            continue;
+        }
+
+        // only <pid>-<time>-<n> (or <n> from older versions), not the temporary files of another
+        // sink whose base name starts with ours
+        auto tag = name.substr(prefix.size(), name.size() - prefix.size() - suffix.size());
+        if (!std::all_of(tag.begin(), tag.end(), [](filename_t::value_type c) {
+                return (c >= '0' && c <= '9') || c == '-';
+            })) {
+            continue;
+        }
+
+        std::error_code time_ec;
+        auto time = it->last_write_time(time_ec);
+        leftovers.emplace_back(time, to_filename(it->path()));
+    }
+
+    std::sort(leftovers.begin(), leftovers.end());
+    for (auto &leftover : leftovers) {
+        rotated_handlers_.on_rotated(leftover.second);
+    }
+}
+
 // delete the target if exists, and rename the src file  to target
 // return true on success, false otherwise.
 template <typename Mutex>
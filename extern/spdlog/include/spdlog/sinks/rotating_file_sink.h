@@ -25,15 +25,41 @@ public:
                        std::size_t max_size,
                        std::size_t max_files,
                        bool rotate_on_open = false,
-                       const file_event_handlers &event_handlers = {});
+                       const file_event_handlers &event_handlers = {},
+                       //* @log4sp hack *//
+                       const rotated_file_handlers &rotated_handlers = {});
     static filename_t calc_filename(const filename_t &filename, std::size_t index);
     filename_t filename();
     void rotate_now();
 
+    //* @log4sp hack *//
+    [[nodiscard]] bool accepts_formatted() const override { return true; }
+
+    //* @log4sp hack *//
+    void set_write_buffer(size_t buffer_size, std::chrono::milliseconds flush_interval) {
+        std::lock_guard<Mutex> lock(base_sink<Mutex>::mutex_);
+        file_helper_.set_write_buffer(buffer_size, flush_interval);
+    }
+    size_t write_buffer_size() {
+        std::lock_guard<Mutex> lock(base_sink<Mutex>::mutex_);
+        return file_helper_.write_buffer_size();
+    }
+    std::chrono::milliseconds write_buffer_interval() {
+        std::lock_guard<Mutex> lock(base_sink<Mutex>::mutex_);
+        return file_helper_.write_buffer_interval();
+    }
+    bool write_buffer_due(std::chrono::steady_clock::time_point now) {
+        std::lock_guard<Mutex> lock(base_sink<Mutex>::mutex_);
+        return file_helper_.write_buffer_due(now);
+    }
+
 protected:
     void sink_it_(const details::log_msg &msg) override;
     void flush_() override;
 
+    //* @log4sp hack *//
+    void sink_formatted_(const details::log_msg &msg, const memory_buf_t &formatted) override;
+
 private:
     // Rotate files:
     // log.txt -> log.1.txt
@@ -46,6 +72,15 @@ private:
     // return true on success, false otherwise.
     bool rename_file_(const filename_t &src_filename, const filename_t &target_filename);
 
+    //* @log4sp hack *//
+    // Rotate files when rotated_handlers_.on_rotated is set:
+    // log.txt -> log.txt.<pid>-<time>-<n>.rotated -> on_rotated
+    void rotate_handed_off_();
+    // pass log.txt.*.rotated files left over by a crash to on_rotated, oldest first
+    void recover_rotated_();
+    rotated_file_handlers rotated_handlers_;
+    std::size_t rotated_count_{0};
+
     filename_t base_filename_;
     std::size_t max_size_;
     std::size_t max_files_;
@@ -20,6 +20,16 @@ public:
     //* @log4sp hack *//
     [[nodiscard]] virtual std::string to_pattern(const details::log_msg &log_msg) = 0;
 
+    //* @log4sp hack *//
+    // 共享格式化: logger 将 pattern 相同的 sinks 分为一组，每条消息每组只格式化一次
+    // accepts_formatted 返回 true 时，logger 使用 clone_formatter 的拷贝格式化消息，然后调用 log_formatted
+    [[nodiscard]] virtual bool accepts_formatted() const { return false; }
+    [[nodiscard]] virtual std::unique_ptr<spdlog::formatter> clone_formatter() { return nullptr; }
+    virtual void log_formatted(const details::log_msg &msg, const memory_buf_t &formatted) {
+        (void)formatted;
+        log(msg);
+    }
+
     void set_level(level::level_enum log_level);
     level::level_enum level() const;
     bool should_log(level::level_enum msg_level) const;
@@ -54,9 +54,37 @@ SPDLOG_INLINE void stdout_sink_base<ConsoleMutex>::log(const details::log_msg &m
     if (handle_ == INVALID_HANDLE_VALUE) {
         return;
     }
+#endif                // _WIN32
     std::lock_guard<mutex_t> lock(mutex_);
     memory_buf_t formatted;
     formatter_->format(msg, formatted);
+    write_formatted_(formatted);
+}
+
+//* @log4sp hack *//
+template <typename ConsoleMutex>
+SPDLOG_INLINE void stdout_sink_base<ConsoleMutex>::log_formatted(const details::log_msg &msg, const memory_buf_t &formatted) {
+    (void)msg;
+#ifdef _WIN32
+    if (handle_ == INVALID_HANDLE_VALUE) {
+        return;
+    }
+#endif                // _WIN32
+    std::lock_guard<mutex_t> lock(mutex_);
+    write_formatted_(formatted);
+}
+
+//* @log4sp hack *//
+template <typename ConsoleMutex>
+[[nodiscard]] SPDLOG_INLINE std::unique_ptr<spdlog::formatter> stdout_sink_base<ConsoleMutex>::clone_formatter() {
+    std::lock_guard<mutex_t> lock(mutex_);
+    return formatter_->clone();
+}
+
+//* @log4sp hack *//
+template <typename ConsoleMutex>
+SPDLOG_INLINE void stdout_sink_base<ConsoleMutex>::write_formatted_(const memory_buf_t &formatted) {
+#ifdef _WIN32
     auto size = static_cast<DWORD>(formatted.size());
     DWORD bytes_written = 0;
     bool ok = ::WriteFile(handle_, formatted.data(), size, &bytes_written, nullptr) != 0;
@@ -65,9 +93,6 @@ SPDLOG_INLINE void stdout_sink_base<ConsoleMutex>::log(const details::log_msg &m
                         std::to_string(::GetLastError()));
     }
 #else
-    std::lock_guard<mutex_t> lock(mutex_);
-    memory_buf_t formatted;
-    formatter_->format(msg, formatted);
     details::os::fwrite_bytes(formatted.data(), formatted.size(), file_);
 #endif                // _WIN32
     ::fflush(file_);  // flush every line to terminal
@@ -37,8 +37,15 @@ public:
 
     //* @log4sp hack *//
     [[nodiscard]] std::string to_pattern(const details::log_msg &log_msg) final override;
+    [[nodiscard]] bool accepts_formatted() const final override { return true; }
+    [[nodiscard]] std::unique_ptr<spdlog::formatter> clone_formatter() final override;
+    void log_formatted(const details::log_msg &msg, const memory_buf_t &formatted) final override;
 
 protected:
+    //* @log4sp hack *//
+    // 调用者需要持有 mutex_
+    void write_formatted_(const memory_buf_t &formatted);
+
     mutex_t &mutex_;
     FILE *file_;
     std::unique_ptr<spdlog::formatter> formatter_;
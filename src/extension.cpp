@@ -31,6 +31,11 @@
 
 #include "extension.h"
 
+#include "log4sp/flush_scheduler.h"
+#include "log4sp/file_compressor.h"
+#include "log4sp/frame_task_queue.h"
+#include "log4sp/network_client.h"
+#include "log4sp/translation_cache.h"
 #include "log4sp/adapter/logger_handler.h"
 #include "log4sp/adapter/sink_handler.h"
 #include "log4sp/command/root_console_command_handler.h"
@@ -53,9 +58,11 @@ bool Log4spExtension::SDK_OnLoad(char *error, size_t maxlen, bool late)
 
     try
     {
+        Log4sp::FrameTaskQueue::Initialize();
         Log4sp::LoggerHandler::Initialize();
         Log4sp::SinkHandler::Initialize();
         Log4sp::RootConsoleCommandHandler::Initialize();
+        Log4sp::TranslationCache::Initialize();
     }
     catch (const std::exception &ex)
     {
@@ -67,16 +74,28 @@ bool Log4spExtension::SDK_OnLoad(char *error, size_t maxlen, bool late)
     sharesys->AddNatives(myself, LoggerNatives);
     sharesys->AddNatives(myself, SinkNatives);
     sharesys->AddNatives(myself, BasicFileSinkNatives);
+    sharesys->AddNatives(myself, BinaryFileSinkNatives);
     sharesys->AddNatives(myself, CallbackSinkNatives);
     sharesys->AddNatives(myself, DailyFileSinkNatives);
+    sharesys->AddNatives(myself, DupFilterSinkNatives);
+    sharesys->AddNatives(myself, MappedFileSinkNatives);
     sharesys->AddNatives(myself, RingBufferSinkNatives);
     sharesys->AddNatives(myself, RotatingFileSinkNatives);
+    sharesys->AddNatives(myself, RoutingFileSinkNatives);
     sharesys->AddNatives(myself, ServerConsoleSinkNatives);
+    sharesys->AddNatives(myself, SplitFileSinkNatives);
+    sharesys->AddNatives(myself, TcpSinkNatives);
+    sharesys->AddNatives(myself, UdpSinkNatives);
 
 #ifdef DEBUG
     sharesys->AddNatives(myself, TestSinkNatives);
+    sharesys->AddNatives(myself, TestFormatNatives);
+    sharesys->AddNatives(myself, TestAllocNatives);
+    sharesys->AddNatives(myself, TestNetworkNatives);
 #endif
 
+    smutils->AddGameFrameHook(&Log4spExtension::OnGameFrame);
+
     sharesys->RegisterLibrary(myself, "log4sp");
 
     rootconsole->ConsolePrint("****************** log4sp.ext initialize complete! ******************");
@@ -85,8 +104,25 @@ bool Log4spExtension::SDK_OnLoad(char *error, size_t maxlen, bool late)
 
 void Log4spExtension::SDK_OnUnload()
 {
+    smutils->RemoveGameFrameHook(&Log4spExtension::OnGameFrame);
+
+    Log4sp::TranslationCache::Destroy();
     Log4sp::RootConsoleCommandHandler::Destroy();
     Log4sp::LoggerHandler::Destroy();
     Log4sp::SinkHandler::Destroy();
+    Log4sp::NetworkClient::Destroy();
+    Log4sp::FileCompressor::Destroy();
+    Log4sp::FrameTaskQueue::Destroy();
 }
 
+void Log4spExtension::OnGameFrame(bool simulating)
+{
+    Log4sp::FrameTaskQueue::Instance().RunAll();
+    Log4sp::FlushScheduler::Instance().RunFrame();
+    Log4sp::TranslationCache::Instance().RunFrame();
+}
+
+void Log4spExtension::OnCoreMapEnd()
+{
+    Log4sp::TranslationCache::Instance().Clear();
+}
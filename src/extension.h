@@ -79,6 +79,20 @@ public:
      * @return          True if working, false otherwise.
      */
     //virtual bool QueryRunning(char *error, size_t maxlen);
+
+    /**
+     * @brief Called once per game frame (registered in SDK_OnLoad).
+     * Runs tasks deferred to the main thread, then flushes loggers marked by the flush scheduler.
+     *
+     * @param simulating    Whether or not the server is simulating.
+     */
+    static void OnGameFrame(bool simulating);
+
+    /**
+     * @brief Called on level shutdown.
+     * SourceMod reparses translation files before the next map, so cached translations are dropped here.
+     */
+    virtual void OnCoreMapEnd();
 public:
     #if defined SMEXT_CONF_METAMOD
     /**
@@ -120,14 +134,24 @@ extern const sp_nativeinfo_t    CommonNatives[];
 extern const sp_nativeinfo_t    LoggerNatives[];
 extern const sp_nativeinfo_t    SinkNatives[];
 extern const sp_nativeinfo_t    BasicFileSinkNatives[];
+extern const sp_nativeinfo_t    BinaryFileSinkNatives[];
 extern const sp_nativeinfo_t    CallbackSinkNatives[];
 extern const sp_nativeinfo_t    DailyFileSinkNatives[];
+extern const sp_nativeinfo_t    DupFilterSinkNatives[];
+extern const sp_nativeinfo_t    MappedFileSinkNatives[];
 extern const sp_nativeinfo_t    RingBufferSinkNatives[];
 extern const sp_nativeinfo_t    RotatingFileSinkNatives[];
+extern const sp_nativeinfo_t    RoutingFileSinkNatives[];
 extern const sp_nativeinfo_t    ServerConsoleSinkNatives[];
+extern const sp_nativeinfo_t    SplitFileSinkNatives[];
+extern const sp_nativeinfo_t    TcpSinkNatives[];
+extern const sp_nativeinfo_t    UdpSinkNatives[];
 
 #ifdef DEBUG
 extern const sp_nativeinfo_t    TestSinkNatives[];
+extern const sp_nativeinfo_t    TestFormatNatives[];
+extern const sp_nativeinfo_t    TestAllocNatives[];
+extern const sp_nativeinfo_t    TestNetworkNatives[];
 #endif
 
 #endif // _INCLUDE_SOURCEMOD_EXTENSION_PROPER_H_
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "extension.h"
+
+
+namespace Log4sp {
+/**
+ * 以 handle 索引为下标的对象指针表，用于 ReadHandle 时避免哈希查找
+ *
+ * SourceMod 的 Handle_t 低 16 位是 handle 在 handlesys 中的索引，高 16 位是序列号
+ * handlesys->ReadHandle 校验 handle 之后，直接用索引定位对象的智能指针
+ *
+ * 表中的指针不拥有对象，指向 LoggerHandler / SinkHandler 中保存智能指针的节点
+ * 插件通过 CloneHandle 得到的 handle 索引不同，handle 的索引也可能被重用
+ * 所以查找时需要比较对象指针，未命中时由调用者回退到哈希表查找
+ *
+ * 只能在主线程使用
+ */
+template <typename T>
+class HandleSlots final
+{
+public:
+    /**
+     * @brief 记录 handle 对应的对象
+     *
+     * @param handle    handlesys 创建的 handle
+     * @param object    对象的智能指针，需要在 Reset 之前保持有效
+     */
+    void Set(SourceMod::Handle_t handle, const std::shared_ptr<T> *object)
+    {
+        auto index = Index(handle);
+        if (index >= m_Slots.size())
+            m_Slots.resize(index + 1);
+
+        m_Slots[index] = object;
+    }
+
+    /**
+     * @brief 移除 handle 对应的对象
+     *        索引已被其他对象重用时不做任何操作
+     */
+    void Reset(SourceMod::Handle_t handle, const T *object) noexcept
+    {
+        auto index = Index(handle);
+        if (index < m_Slots.size() && m_Slots[index] && m_Slots[index]->get() == object)
+            m_Slots[index] = nullptr;
+    }
+
+    /**
+     * @brief 查找 handle 对应的对象
+     *
+     * @param handle    已经通过 handlesys 校验的 handle
+     * @param object    handlesys->ReadHandle 读取到的对象
+     * @return          对象的智能指针，未命中时返回 nullptr
+     */
+    [[nodiscard]]
+    const std::shared_ptr<T> *Find(SourceMod::Handle_t handle, const T *object) const noexcept
+    {
+        auto index = Index(handle);
+        if (index < m_Slots.size() && m_Slots[index] && m_Slots[index]->get() == object)
+            return m_Slots[index];
+        return nullptr;
+    }
+
+    void Clear() noexcept
+    {
+        m_Slots.clear();
+    }
+
+private:
+    [[nodiscard]]
+    static std::size_t Index(SourceMod::Handle_t handle) noexcept
+    {
+        return static_cast<std::size_t>(handle & 0xFFFF);
+    }
+
+    std::vector<const std::shared_ptr<T> *> m_Slots;
+};
+
+
+}       // namespace Log4sp
@@ -4,6 +4,7 @@
 #include "spdlog/sinks/stdout_sinks.h"
 
 #include "log4sp/adapter/logger_handler.h"
+#include "log4sp/sinks/dup_filter_sink.h"
 
 
 namespace Log4sp {
@@ -46,7 +47,14 @@ SourceMod::Handle_t LoggerHandler::CreateHandle(std::shared_ptr<Logger> object,
     assert(m_Loggers.find(object->Name()) == m_Loggers.end());
 
     m_Handles[object->Name()] = handle;
-    m_Loggers[object->Name()] = object;
+    m_Slots.Set(handle, &(m_Loggers[object->Name()] = object));
+
+    if (object->IsAsync())
+        ++m_AsyncLoggers;
+
+    // 新的 logger 可能是已有 logger 的父 logger
+    object->InheritLevel(ParentLevel(object->Name()));
+    UpdateChildLevels(object->Name());
 
     return handle;
 }
@@ -65,6 +73,10 @@ std::shared_ptr<Logger> LoggerHandler::ReadHandle(const SourceMod::Handle_t hand
         return nullptr;
     }
 
+    if (auto found = m_Slots.Find(handle, object))
+        return *found;
+
+    // 插件克隆的 handle
     assert(m_Loggers.find(object->Name()) != m_Loggers.end());
     return m_Loggers.find(object->Name())->second;
 }
@@ -120,8 +132,115 @@ void LoggerHandler::OnHandleDestroy(SourceMod::HandleType_t type, void *object)
     assert(m_Handles.find(logger->Name()) != m_Handles.end());
     assert(m_Loggers.find(logger->Name()) != m_Loggers.end());
 
-    m_Handles.erase(logger->Name());
-    m_Loggers.erase(logger->Name());
+    // logger 可能在 m_Loggers 中被释放，拷贝名称
+    std::string name = logger->Name();
+
+    if (logger->IsAsync())
+        --m_AsyncLoggers;
+
+    m_Slots.Reset(m_Handles[name], logger);
+    m_Handles.erase(name);
+    m_Loggers.erase(name);
+
+    // 子 logger 改为继承祖先的日志级别
+    UpdateChildLevels(name);
+}
+
+[[nodiscard]]
+spdlog::level::level_enum LoggerHandler::ParentLevel(std::string_view name) const noexcept
+{
+    for (auto pos = name.rfind('.'); pos != std::string_view::npos && pos != 0; pos = name.rfind('.', pos - 1))
+    {
+        auto found = m_Loggers.find(name.substr(0, pos));
+        if (found != m_Loggers.end())
+            return found->second->GetLevel();
+    }
+    return spdlog::level::info;
+}
+
+void LoggerHandler::UpdateChildLevels(const std::string &name) noexcept
+{
+    std::string_view prefix = name;
+    for (auto it = m_Loggers.upper_bound(prefix); it != m_Loggers.end(); ++it)
+    {
+        std::string_view child = it->first;
+        if (child.size() <= prefix.size() || child.compare(0, prefix.size(), prefix) != 0)
+            break;
+
+        if (child[prefix.size()] == '.')
+            it->second->InheritLevel(ParentLevel(child));
+    }
+}
+
+// a 与 b 是同一个 sink，或者其中一个是包含另一个的 DupFilterSink
+[[nodiscard]]
+static bool SinksOverlap(spdlog::sinks::sink *a, spdlog::sinks::sink *b) noexcept
+{
+    if (a == b)
+        return true;
+
+    auto dupA = dynamic_cast<Sinks::DupFilterSinkST *>(a);
+    if (dupA && dupA->Contains(b))
+        return true;
+
+    auto dupB = dynamic_cast<Sinks::DupFilterSinkST *>(b);
+    return dupB && dupB->Contains(a);
+}
+
+[[nodiscard]]
+bool LoggerHandler::IsAsyncSink(spdlog::sinks::sink *sink) const noexcept
+{
+    if (m_AsyncLoggers == 0)
+        return false;
+
+    for (auto &l : m_Loggers)
+    {
+        if (!l.second->IsAsync())
+            continue;
+
+        // m_Sinks 只在主线程修改，主线程读取不需要加锁
+        for (auto &owned : l.second->Sinks())
+        {
+            if (SinksOverlap(owned.get(), sink))
+                return true;
+        }
+    }
+    return false;
+}
+
+void LoggerHandler::FlushAsyncOwners(spdlog::sinks::sink *sink) noexcept
+{
+    for (auto &l : m_Loggers)
+    {
+        if (!l.second->IsAsync())
+            continue;
+
+        for (auto &owned : l.second->Sinks())
+        {
+            if (SinksOverlap(owned.get(), sink))
+            {
+                l.second->Flush(SourceLoc(__FILE__, __LINE__, __FUNCTION__));
+                break;
+            }
+        }
+    }
+}
+
+[[nodiscard]]
+bool LoggerHandler::IsSinkUsedByOthers(spdlog::sinks::sink *sink, const Logger *logger) const noexcept
+{
+    for (auto &l : m_Loggers)
+    {
+        if (l.second.get() == logger)
+            continue;
+
+        for (auto &owned : l.second->Sinks())
+        {
+            if (SinksOverlap(owned.get(), sink))
+                return true;
+        }
+    }
+    return false;
 }
 
 
@@ -169,6 +288,7 @@ void LoggerHandler::Destroy_() noexcept
     {
         handlesys->RemoveType(m_HandleType, myself->GetIdentity());
         m_HandleType = NO_HANDLE_TYPE;
+        m_Slots.Clear();
     }
 }
 
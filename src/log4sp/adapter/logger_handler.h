@@ -1,11 +1,14 @@
 #pragma once
 
+#include <map>
+#include <string_view>
 #include <unordered_map>
 #include <vector>
 
 #include "extension.h"
 
 #include "log4sp/logger.h"
+#include "log4sp/adapter/handle_slots.h"
 
 
 namespace Log4sp {
@@ -115,6 +118,53 @@ public:
     void ApplyAll(const std::function<void(const SourceMod::Handle_t)> &fun);
     void ApplyAll(const std::function<void(std::shared_ptr<Logger>)> &fun);
 
+    /**
+     * @brief 获取父 logger 的日志级别
+     *        logger 名称以 '.' 分隔层级，例如 "myplugin.db.query" 的父 logger 依次为 "myplugin.db"、"myplugin"
+     *        跳过不存在的 logger，直到找到最近的祖先
+     *
+     * @param name      logger 对象的名称
+     * @return          最近的祖先 logger 的日志级别，没有祖先时返回默认的 info
+     */
+    [[nodiscard]]
+    spdlog::level::level_enum ParentLevel(std::string_view name) const noexcept;
+
+    /**
+     * @brief 更新子 logger 中继承日志级别的 logger
+     *        子 logger 在有序的 m_Loggers 中是连续的，并且父 logger 总在子 logger 之前，所以只需要遍历一次
+     *
+     * @param name      logger 对象的名称
+     */
+    void UpdateChildLevels(const std::string &name) noexcept;
+
+    /**
+     * @brief 检查 sink 是否由异步 logger 的工作线程写入
+     *        包括异步 logger 持有的 sinks、它们之中 DupFilterSink 的子 sinks，以及包含这些 sinks 的 DupFilterSink
+     *
+     * @param sink      sink 对象
+     * @return          true 表示主线程不能再直接访问 sink
+     */
+    [[nodiscard]]
+    bool IsAsyncSink(spdlog::sinks::sink *sink) const noexcept;
+
+    /**
+     * @brief 检查 sink 是否已被 logger 以外的 logger 使用 (直接或作为 DupFilterSink 的子 sink)
+     *        异步 logger 的 sinks 只能属于它自己，添加前需要检查
+     *
+     * @param sink      sink 对象
+     * @param logger    不检查的 logger，通常是 sink 将要添加到的 logger
+     * @return          true 表示 sink 已被其他 logger 使用
+     */
+    [[nodiscard]]
+    bool IsSinkUsedByOthers(spdlog::sinks::sink *sink, const Logger *logger) const noexcept;
+
+    /**
+     * @brief 向持有 sink 的异步 logger 发送刷新请求，由工作线程刷新 sink
+     *
+     * @param sink      sink 对象
+     */
+    void FlushAsyncOwners(spdlog::sinks::sink *sink) noexcept;
+
     /**
      * @brief Called when destroying a handle.  Must be implemented.
      *
@@ -136,8 +186,24 @@ private:
 
     SourceMod::HandleType_t m_HandleType{NO_HANDLE_TYPE};
     std::unordered_map<std::string, SourceMod::Handle_t> m_Handles;
-    std::unordered_map<std::string, std::shared_ptr<Logger>> m_Loggers;
+    std::map<std::string, std::shared_ptr<Logger>, std::less<>> m_Loggers;    // 有序，用于遍历子 logger
+    HandleSlots<Logger> m_Slots;                // 指向 m_Loggers 的节点
+    std::size_t m_AsyncLoggers{0};              // 没有异步 logger 时 IsAsyncSink 不需要遍历
 };
 
 
 }       // namespace Log4sp
+
+
+/**
+ * 异步 Logger 的 sinks 由工作线程写入，主线程再访问会产生数据竞争 (sinks 使用 null_mutex，日志级别也不是原子的)
+ * 用于读取 sink handle 之后，访问 sink 可变状态的 natives
+ *      sink 不属于异步 Logger 时: 继续执行后续代码
+ *      sink 属于异步 Logger 时: 抛出错误并结束执行, 返回 0
+ */
+#define CHECK_SINK_NOT_ASYNC_OR_ERROR(handle, sink)                                                 \
+    if (Log4sp::LoggerHandler::Instance().IsAsyncSink(sink))                                        \
+    {                                                                                               \
+        ctx->ReportError("Sink %x is written by an asynchronous logger and cannot be accessed directly.", handle); \
+        return 0;                                                                                   \
+    }
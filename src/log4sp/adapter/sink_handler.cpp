@@ -42,7 +42,7 @@ SourceMod::Handle_t SinkHandler::CreateHandle(SinkPtr object, const SourceMod::H
     assert(m_Sinks.find(object.get()) == m_Sinks.end());
 
     m_Handles[object.get()] = handle;
-    m_Sinks[object.get()] = object;
+    m_Slots.Set(handle, &(m_Sinks[object.get()] = object));
 
     return handle;
 }
@@ -61,6 +61,10 @@ spdlog::sink_ptr SinkHandler::ReadHandle(SourceMod::Handle_t handle, SourceMod::
         return nullptr;
     }
 
+    if (auto found = m_Slots.Find(handle, object))
+        return *found;
+
+    // 插件克隆的 handle
     assert(m_Sinks.find(object) != m_Sinks.end());
     return m_Sinks.find(object)->second;
 }
@@ -90,6 +94,7 @@ void SinkHandler::OnHandleDestroy(SourceMod::HandleType_t type, void *object)
     assert(m_Handles.find(sink_obj) != m_Handles.end());
     assert(m_Sinks.find(sink_obj) != m_Sinks.end());
 
+    m_Slots.Reset(m_Handles[sink_obj], sink_obj);
     m_Handles.erase(sink_obj);
     m_Sinks.erase(sink_obj);
 }
@@ -118,6 +123,7 @@ void SinkHandler::Destroy_() noexcept
     {
         handlesys->RemoveType(m_HandleType, myself->GetIdentity());
         m_HandleType = NO_HANDLE_TYPE;
+        m_Slots.Clear();
     }
 }
 
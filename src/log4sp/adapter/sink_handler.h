@@ -4,6 +4,7 @@
 #include <unordered_map>
 
 #include "log4sp/common.h"
+#include "log4sp/adapter/handle_slots.h"
 
 
 namespace Log4sp {
@@ -114,6 +115,7 @@ private:
     SourceMod::HandleType_t m_HandleType{NO_HANDLE_TYPE};
     std::unordered_map<Sink*, SourceMod::Handle_t> m_Handles;
     std::unordered_map<Sink*, SinkPtr> m_Sinks;
+    HandleSlots<Sink> m_Slots;                  // 指向 m_Sinks 的节点
 };
 
 
@@ -20,6 +20,20 @@ std::shared_ptr<Logger> Command::ArgToLogger(const std::string &arg)
     return logger;
 }
 
+std::string Command::FlushPolicyToStr(FlushPolicy policy, std::chrono::milliseconds interval)
+{
+    switch (policy)
+    {
+    case FlushPolicy::Immediate:
+        return "immediate";
+    case FlushPolicy::Frame:
+        return "frame";
+    case FlushPolicy::Interval:
+        return spdlog::fmt_lib::format("every {} ms", interval.count());
+    }
+    return "unknown";
+}
+
 spdlog::level::level_enum Command::ArgToLevel(const std::string &arg)
 {
     // 尝试按名字转换
@@ -110,7 +124,8 @@ void GetLvlCommand::Execute(const std::vector<std::string> &args)
     auto level  = logger->GetLevel();
 
     using spdlog::level::to_string_view;
-    rootconsole->ConsolePrint("[SM] Logger '%s' log level is '%s'.", logger->Name().c_str(), to_string_view(level).data());
+    rootconsole->ConsolePrint("[SM] Logger '%s' log level is '%s'%s.", logger->Name().c_str(), to_string_view(level).data(),
+                              logger->HasLevel() ? "" : " (inherited)");
 }
 
 
@@ -123,7 +138,7 @@ void SetLvlCommand::Execute(const std::vector<std::string> &args)
     auto level  = ArgToLevel(args[1]);
 
     using spdlog::level::to_string_view;
-    if (level == logger->GetLevel())
+    if (logger->HasLevel() && level == logger->GetLevel())
     {
         rootconsole->ConsolePrint("[SM] Logger '%s' log level is already '%s' level.", logger->Name().c_str(), to_string_view(level).data());
         return;
@@ -134,6 +149,55 @@ void SetLvlCommand::Execute(const std::vector<std::string> &args)
 }
 
 
+void ResetLvlCommand::Execute(const std::vector<std::string> &args)
+{
+    if (args.empty())
+        ThrowLog4spEx("Usage: sm " LOG4SP_ROOT_CMD " reset_lvl <logger_name>");
+
+    auto logger = ArgToLogger(args[0]);
+
+    logger->ResetLevel();
+
+    using spdlog::level::to_string_view;
+    rootconsole->ConsolePrint("[SM] Logger '%s' log level reset to inherited '%s'.", logger->Name().c_str(), to_string_view(logger->GetLevel()).data());
+}
+
+
+void SetRateCommand::Execute(const std::vector<std::string> &args)
+{
+    if (args.size() < 2)
+        ThrowLog4spEx("Usage: sm " LOG4SP_ROOT_CMD " set_rate <logger_name> <msgs_per_sec> [burst] [sample]");
+
+    auto logger = ArgToLogger(args[0]);
+    auto rate   = ArgToCount(args[1], "Rate");
+    auto burst  = args.size() >= 3 ? ArgToCount(args[2], "Burst") : 0;
+
+    logger->SetRateLimit(rate, burst);
+
+    if (args.size() >= 4)
+        logger->SetSampleRate(ArgToCount(args[3], "Sample"));
+
+    const auto &limiter = logger->GetRateLimiter();
+    rootconsole->ConsolePrint("[SM] Logger '%s' rate limit set to %u msgs/s (burst %u), sampling 1 in %u.",
+                              logger->Name().c_str(), limiter.GetRate(), limiter.GetBurst(), limiter.GetSample());
+}
+
+std::uint32_t SetRateCommand::ArgToCount(const std::string &arg, const char *name)
+{
+    try
+    {
+        int number = std::stoi(arg);
+        if (number < 0)
+            throw std::out_of_range(arg);
+        return static_cast<std::uint32_t>(number);
+    }
+    catch (const std::exception &)
+    {
+        ThrowLog4spEx(std::string(name) + " \"" + arg + "\" is not a non-negative integer.");
+    }
+}
+
+
 void SetPatternCommand::Execute(const std::vector<std::string> &args)
 {
     if (args.size() < 2)
@@ -200,16 +264,24 @@ void GetFlushLvlCommand::Execute(const std::vector<std::string> &args)
 
     auto logger = ArgToLogger(args[0]);
     auto level  = logger->GetFlushLevel();
+    auto policy = logger->GetFlushPolicy();
 
     using spdlog::level::to_string_view;
-    rootconsole->ConsolePrint("[SM] Logger '%s' flush level is '%s'.", logger->Name().c_str(), to_string_view(level).data());
+    if (policy == FlushPolicy::Immediate)
+    {
+        rootconsole->ConsolePrint("[SM] Logger '%s' flush level is '%s'.", logger->Name().c_str(), to_string_view(level).data());
+        return;
+    }
+
+    auto policyStr = FlushPolicyToStr(policy, logger->GetFlushInterval());
+    rootconsole->ConsolePrint("[SM] Logger '%s' flush level is '%s' (policy '%s').", logger->Name().c_str(), to_string_view(level).data(), policyStr.c_str());
 }
 
 
 void SetFlushLvlCommand::Execute(const std::vector<std::string> &args)
 {
     if (args.size() < 2)
-        ThrowLog4spEx("Usage: sm " LOG4SP_ROOT_CMD " set_flush_lvl <logger_name> <level>");
+        ThrowLog4spEx("Usage: sm " LOG4SP_ROOT_CMD " set_flush_lvl <logger_name> <level> [immediate | frame | <interval_ms>]");
 
     auto logger = ArgToLogger(args[0]);
     auto level  = ArgToLevel(args[1]);
@@ -218,11 +290,72 @@ void SetFlushLvlCommand::Execute(const std::vector<std::string> &args)
     if (level == logger->GetFlushLevel())
     {
         rootconsole->ConsolePrint("[SM] Logger '%s' flush level is already '%s' level.", logger->Name().c_str(), to_string_view(level).data());
+    }
+    else
+    {
+        rootconsole->ConsolePrint("[SM] Logger '%s' will set flush level to '%s'", logger->Name().c_str(), to_string_view(level).data());
+        logger->SetFlushLevel(level);
+    }
+
+    if (args.size() < 3)
+        return;
+
+    auto policy   = FlushPolicy::Interval;
+    auto interval = std::chrono::milliseconds::zero();
+    if (args[2] == "immediate")
+    {
+        policy = FlushPolicy::Immediate;
+    }
+    else if (args[2] == "frame")
+    {
+        policy = FlushPolicy::Frame;
+    }
+    else
+    {
+        try
+        {
+            int number = std::stoi(args[2]);
+            if (number < 0)
+                throw std::out_of_range(args[2]);
+            interval = std::chrono::milliseconds(number);
+        }
+        catch (const std::exception &)
+        {
+            ThrowLog4spEx("Flush policy \"" + args[2] + "\" is not 'immediate', 'frame' or a non-negative interval in milliseconds.");
+        }
+    }
+
+    auto policyStr = FlushPolicyToStr(policy, interval);
+    if (policy == logger->GetFlushPolicy() && interval == logger->GetFlushInterval())
+    {
+        rootconsole->ConsolePrint("[SM] Logger '%s' flush policy is already '%s'.", logger->Name().c_str(), policyStr.c_str());
         return;
     }
 
-    rootconsole->ConsolePrint("[SM] Logger '%s' will set flush level to '%s'", logger->Name().c_str(), to_string_view(level).data());
-    logger->SetFlushLevel(level);
+    rootconsole->ConsolePrint("[SM] Logger '%s' will set flush policy to '%s'", logger->Name().c_str(), policyStr.c_str());
+    logger->SetFlushPolicy(policy, interval);
+}
+
+
+void GetQueueStatsCommand::Execute(const std::vector<std::string> &args)
+{
+    if (args.empty())
+        ThrowLog4spEx("Usage: sm " LOG4SP_ROOT_CMD " get_queue_stats <logger_name>");
+
+    auto logger = ArgToLogger(args[0]);
+    if (!logger->IsAsync())
+    {
+        rootconsole->ConsolePrint("[SM] Logger '%s' is not an asynchronous logger.", logger->Name().c_str());
+        return;
+    }
+
+    static const char *const policyNames[] = {"block", "drop_newest", "overwrite_oldest"};
+
+    auto policy = logger->GetOverflowPolicy();
+    auto stats  = logger->GetQueueStats();
+    rootconsole->ConsolePrint("[SM] Logger '%s' queue stats: policy '%s', enqueued %zu, dropped %zu, overwritten %zu, high-water %zu.",
+                              logger->Name().c_str(), policyNames[static_cast<int>(policy)],
+                              stats.enqueued, stats.dropped, stats.overwritten, stats.highWater);
 }
 
 
@@ -1,12 +1,14 @@
 
 #pragma once
 
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <unordered_set>
 #include <vector>
 
 #include "log4sp/common.h"
+#include "log4sp/flush_scheduler.h"
 
 
 namespace Log4sp {
@@ -37,6 +39,8 @@ protected:
     [[nodiscard]] std::shared_ptr<Logger> ArgToLogger(const std::string &arg);
 
     [[nodiscard]] LevelEnum ArgToLevel(const std::string &arg);
+
+    [[nodiscard]] static std::string FlushPolicyToStr(FlushPolicy policy, std::chrono::milliseconds interval);
 };
 
 
@@ -54,8 +58,8 @@ public:
 
 private:
     inline static const std::unordered_set<std::string> m_Functions{
-        "get_lvl", "set_lvl", "set_pattern", "should_log", "log",
-        "flush", "get_flush_lvl", "set_flush_lvl"};
+        "get_lvl", "set_lvl", "reset_lvl", "set_rate", "set_pattern", "should_log", "log",
+        "flush", "get_flush_lvl", "set_flush_lvl", "get_queue_stats"};
 };
 
 
@@ -73,6 +77,23 @@ public:
 };
 
 
+class ResetLvlCommand final : public Command
+{
+public:
+    void Execute(const std::vector<std::string> &args) override;
+};
+
+
+class SetRateCommand final : public Command
+{
+public:
+    void Execute(const std::vector<std::string> &args) override;
+
+private:
+    [[nodiscard]] static std::uint32_t ArgToCount(const std::string &arg, const char *name);
+};
+
+
 class SetPatternCommand final : public Command
 {
 public:
@@ -115,6 +136,13 @@ public:
 };
 
 
+class GetQueueStatsCommand final : public Command
+{
+public:
+    void Execute(const std::vector<std::string> &args) override;
+};
+
+
 class VersionCommand final : public Command
 {
 public:
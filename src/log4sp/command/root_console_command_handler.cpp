@@ -35,17 +35,20 @@ void RootConsoleCommandHandler::DrawMenu()
     rootconsole->ConsolePrint(SMEXT_CONF_NAME " Menu:");
     rootconsole->ConsolePrint("Usage: sm " LOG4SP_ROOT_CMD " <function_name> [arguments]");
 
-    rootconsole->DrawGenericOption("list",          "List all logger names.");
-    rootconsole->DrawGenericOption("apply_all",     "Apply a command function on all loggers.");
-    rootconsole->DrawGenericOption("get_lvl",       format("Gets a logger log level. [{}]", join(level_string_views, " < ")).c_str());
-    rootconsole->DrawGenericOption("set_lvl",       format("Sets a logger log level. [{}]", join(level_string_views, " < ")).c_str());
-    rootconsole->DrawGenericOption("set_pattern",   "Sets a logger log pattern.");
-    rootconsole->DrawGenericOption("should_log",    "Gets a logger whether logging is enabled for the given log level.");
-    rootconsole->DrawGenericOption("log",           "Use a logger to log a message.");
-    rootconsole->DrawGenericOption("flush",         "Manual flush a logger contents.");
-    rootconsole->DrawGenericOption("get_flush_lvl", "Gets the minimum log level that will trigger automatic flush.");
-    rootconsole->DrawGenericOption("set_flush_lvl", "Sets the minimum log level that will trigger automatic flush.");
-    rootconsole->DrawGenericOption("version",       "Display version information");
+    rootconsole->DrawGenericOption("list",            "List all logger names.");
+    rootconsole->DrawGenericOption("apply_all",       "Apply a command function on all loggers.");
+    rootconsole->DrawGenericOption("get_lvl",         format("Gets a logger log level. [{}]", join(level_string_views, " < ")).c_str());
+    rootconsole->DrawGenericOption("set_lvl",         format("Sets a logger log level. [{}]", join(level_string_views, " < ")).c_str());
+    rootconsole->DrawGenericOption("reset_lvl",       "Resets a logger log level to inherit from its parent logger.");
+    rootconsole->DrawGenericOption("set_rate",        "Sets a logger rate limit (messages per second, 0 = off) and optionally 1-in-N sampling.");
+    rootconsole->DrawGenericOption("set_pattern",     "Sets a logger log pattern.");
+    rootconsole->DrawGenericOption("should_log",      "Gets a logger whether logging is enabled for the given log level.");
+    rootconsole->DrawGenericOption("log",             "Use a logger to log a message.");
+    rootconsole->DrawGenericOption("flush",           "Manual flush a logger contents.");
+    rootconsole->DrawGenericOption("get_flush_lvl",   "Gets the minimum log level that will trigger automatic flush.");
+    rootconsole->DrawGenericOption("set_flush_lvl",   "Sets the minimum log level that will trigger automatic flush, and optionally when to flush.");
+    rootconsole->DrawGenericOption("get_queue_stats", "Gets the queue statistics of an asynchronous logger.");
+    rootconsole->DrawGenericOption("version",         "Display version information");
 }
 
 
@@ -89,17 +92,20 @@ void RootConsoleCommandHandler::OnRootConsoleCommand(const char *cmdname, const
 
 RootConsoleCommandHandler::RootConsoleCommandHandler()
 {
-    m_Commands["list"]           = std::make_unique<ListCommand>();
-    m_Commands["apply_all"]      = std::make_unique<ApplyAllCommand>();
-    m_Commands["get_lvl"]        = std::make_unique<GetLvlCommand>();
-    m_Commands["set_lvl"]        = std::make_unique<SetLvlCommand>();
-    m_Commands["set_pattern"]    = std::make_unique<SetPatternCommand>();
-    m_Commands["should_log"]     = std::make_unique<ShouldLogCommand>();
-    m_Commands["log"]            = std::make_unique<LogCommand>();
-    m_Commands["flush"]          = std::make_unique<FlushCommand>();
-    m_Commands["get_flush_lvl"]  = std::make_unique<GetFlushLvlCommand>();
-    m_Commands["set_flush_lvl"]  = std::make_unique<SetFlushLvlCommand>();
-    m_Commands["version"]        = std::make_unique<VersionCommand>();
+    m_Commands["list"]            = std::make_unique<ListCommand>();
+    m_Commands["apply_all"]       = std::make_unique<ApplyAllCommand>();
+    m_Commands["get_lvl"]         = std::make_unique<GetLvlCommand>();
+    m_Commands["set_lvl"]         = std::make_unique<SetLvlCommand>();
+    m_Commands["reset_lvl"]       = std::make_unique<ResetLvlCommand>();
+    m_Commands["set_rate"]        = std::make_unique<SetRateCommand>();
+    m_Commands["set_pattern"]     = std::make_unique<SetPatternCommand>();
+    m_Commands["should_log"]      = std::make_unique<ShouldLogCommand>();
+    m_Commands["log"]             = std::make_unique<LogCommand>();
+    m_Commands["flush"]           = std::make_unique<FlushCommand>();
+    m_Commands["get_flush_lvl"]   = std::make_unique<GetFlushLvlCommand>();
+    m_Commands["set_flush_lvl"]   = std::make_unique<SetFlushLvlCommand>();
+    m_Commands["get_queue_stats"] = std::make_unique<GetQueueStatsCommand>();
+    m_Commands["version"]         = std::make_unique<VersionCommand>();
 }
 
 void RootConsoleCommandHandler::Initialize_()
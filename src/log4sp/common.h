@@ -4,6 +4,8 @@
 
 #include "extension.h"
 
+#include "log4sp/frame_task_queue.h"
+
 
 namespace Log4sp {
 
@@ -200,16 +202,50 @@ SourceMod::IPlugin* PluginSysFindPluginByCtx(SourcePawn::IPluginContext *ctx) no
     #define HANDLE_SYS_FREE_HANDLE(handle, security)        assert(!handlesys->FreeHandle(handle, security));
 #endif
 
+/**
+ * 读取文件 sink 构造函数末尾的可选参数 bufferSize, flushInterval
+ * 旧版本 include 编译的插件不会传递这两个参数，此时不使用写缓冲
+ * 这会创建 2 个变量: writeBufferSize, writeBufferInterval
+ *      读取成功时: 继续执行后续代码
+ *      读取失败时: 抛出错误并结束执行, 返回 BAD_HANDLE
+ */
+#define READ_WRITE_BUFFER_PARAMS_OR_ERROR(index)                                                    \
+    std::size_t writeBufferSize = 0;                                                                \
+    std::chrono::milliseconds writeBufferInterval{0};                                               \
+    {                                                                                               \
+        cell_t bufferSize    = params[0] >= (index)     ? params[(index)]     : 0;                  \
+        cell_t flushInterval = params[0] >= (index) + 1 ? params[(index) + 1] : 0;                  \
+        if (bufferSize < 0)                                                                         \
+        {                                                                                           \
+            ctx->ReportError("Invalid buffer size %d.", bufferSize);                                \
+            return BAD_HANDLE;                                                                      \
+        }                                                                                           \
+        if (flushInterval < 0)                                                                      \
+        {                                                                                           \
+            ctx->ReportError("Invalid flush interval %d.", flushInterval);                          \
+            return BAD_HANDLE;                                                                      \
+        }                                                                                           \
+        writeBufferSize = static_cast<std::size_t>(bufferSize);                                     \
+        writeBufferInterval = std::chrono::milliseconds(flushInterval);                             \
+    }
+
 #define FILE_EVENT_FUNCTION(func)                                                                   \
     [func](const spdlog::filename_t &filename)                                                      \
     {                                                                                               \
         if (func)                                                                                   \
         {                                                                                           \
-            auto path = Log4sp::UnbuildPath<SourceMod::PathType::Path_Game>(filename);              \
-            FWDS_CREATE_EX(nullptr, ET_Ignore, 1, nullptr, Param_String);                           \
-            FWD_ADD_FUNCTION(func);                                                                 \
-            FWD_PUSH_STRING(path.c_str());                                                          \
-            FWD_EXECUTE();                                                                          \
-            forwards->ReleaseForward(fwd);                                                          \
+            auto call = [func, path = Log4sp::UnbuildPath<SourceMod::PathType::Path_Game>(filename)]() \
+            {                                                                                       \
+                FWDS_CREATE_EX(nullptr, ET_Ignore, 1, nullptr, Param_String);                       \
+                FWD_ADD_FUNCTION(func);                                                             \
+                FWD_PUSH_STRING(path.c_str());                                                      \
+                FWD_EXECUTE();                                                                      \
+                forwards->ReleaseForward(fwd);                                                      \
+            };                                                                                      \
+            /* 异步 Logger 的工作线程滚动文件时，回调推迟到下一帧由主线程执行 */                         \
+            if (Log4sp::FrameTaskQueue::Instance().IsMainThread())                                  \
+                call();                                                                             \
+            else                                                                                    \
+                Log4sp::FrameTaskQueue::Instance().Post(std::move(call));                           \
         }                                                                                           \
     }
@@ -0,0 +1,261 @@
+#include <cerrno>
+#include <cstdio>
+#include <memory>
+
+#include "zlib.h"
+
+#include "spdlog/details/os.h"
+#include "spdlog/sinks/rotating_file_sink.h"
+
+#include "log4sp/common.h"
+#include "log4sp/file_compressor.h"
+#include "log4sp/frame_task_queue.h"
+
+
+namespace Log4sp {
+
+[[nodiscard]]
+FileCompressor &FileCompressor::Instance() noexcept
+{
+    static FileCompressor instance;
+    return instance;
+}
+
+void FileCompressor::Destroy() noexcept
+{
+    auto &instance = Instance();
+    {
+        std::lock_guard<std::mutex> lock(instance.m_Mutex);
+        instance.m_Stop = true;
+    }
+    instance.m_Cond.notify_one();
+
+    if (instance.m_Thread.joinable())
+        instance.m_Thread.join();
+
+    std::lock_guard<std::mutex> lock(instance.m_Mutex);
+    instance.m_Stop = false;
+}
+
+[[nodiscard]]
+spdlog::rotated_file_handlers FileCompressor::RotatingHandlers(const spdlog::filename_t &base, std::size_t maxFiles)
+{
+    spdlog::rotated_file_handlers handlers;
+    handlers.archived_ext = Extension;
+    handlers.on_rotated = [base, maxFiles](const spdlog::filename_t &filename)
+    {
+        (void)Instance().PostFile(filename, [base, maxFiles, filename]()
+        {
+            using spdlog::details::os::filename_to_str;
+            using spdlog::details::os::path_exists;
+            using spdlog::details::os::remove_if_exists;
+            using spdlog::sinks::rotating_file_sink_st;
+
+            // 文件已被之前的任务压缩 (sink 创建时找回的残留文件恰好刚压缩完成)，不能再移动压缩文件
+            if (!path_exists(filename))
+                return;
+
+            // log.1.txt.gz -> log.2.txt.gz -> ... -> delete
+            (void)remove_if_exists(rotating_file_sink_st::calc_filename(base, maxFiles) + Extension);
+            for (auto i = maxFiles; i > 1; --i)
+            {
+                auto src = rotating_file_sink_st::calc_filename(base, i - 1) + Extension;
+                if (!path_exists(src))
+                    continue;
+
+                auto target = rotating_file_sink_st::calc_filename(base, i) + Extension;
+                if (spdlog::details::os::rename(src, target) != 0)
+                    ThrowLog4spEx("Failed renaming " + filename_to_str(src) + " to " + filename_to_str(target), errno);
+            }
+
+            Compress(filename, rotating_file_sink_st::calc_filename(base, 1) + Extension);
+        });
+    };
+    return handlers;
+}
+
+[[nodiscard]]
+spdlog::rotated_file_handlers FileCompressor::DailyHandlers()
+{
+    spdlog::rotated_file_handlers handlers;
+    handlers.archived_ext = Extension;
+    handlers.on_rotated = [](const spdlog::filename_t &filename)
+    {
+        (void)Instance().PostFile(filename, [filename]()
+        {
+            // 文件已被之前的任务压缩 (sink 创建时找回的文件恰好刚压缩完成)
+            if (spdlog::details::os::path_exists(filename))
+                Compress(filename, filename + Extension);
+        });
+    };
+    // 删除旧文件排在它的压缩任务之后，否则压缩完成时会留下没有被删除的 .gz
+    handlers.on_remove = [](const spdlog::filename_t &filename)
+    {
+        Instance().Post([filename]()
+        {
+            using spdlog::details::os::filename_to_str;
+            using spdlog::details::os::remove_if_exists;
+
+            if (remove_if_exists(filename) != 0 || remove_if_exists(filename + Extension) != 0)
+                ThrowLog4spEx("Failed removing daily file " + filename_to_str(filename), errno);
+        });
+    };
+    return handlers;
+}
+
+void FileCompressor::Compress(const spdlog::filename_t &src, const spdlog::filename_t &dst)
+{
+    using spdlog::details::os::filename_to_str;
+
+    constexpr std::size_t CHUNK = 64 * 1024;
+
+    struct FileCloser
+    {
+        void operator()(std::FILE *file) const noexcept { std::fclose(file); }
+    };
+    using FilePtr = std::unique_ptr<std::FILE, FileCloser>;
+
+    struct StreamEnder
+    {
+        void operator()(z_stream *stream) const noexcept { deflateEnd(stream); }
+    };
+
+    FilePtr in(std::fopen(src.c_str(), "rb"));
+    if (!in)
+        ThrowLog4spEx("Failed opening file " + filename_to_str(src) + " for compressing", errno);
+
+    auto tmp = dst + ".tmp";
+    FilePtr out(std::fopen(tmp.c_str(), "wb"));
+    if (!out)
+        ThrowLog4spEx("Failed opening file " + filename_to_str(tmp) + " for writing", errno);
+
+    z_stream stream{};
+    // windowBits + 16: 写入 gzip 头与校验，而不是 zlib 格式
+    if (deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, MAX_WBITS + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+        ThrowLog4spEx("Failed initializing compressor for " + filename_to_str(src));
+    std::unique_ptr<z_stream, StreamEnder> streamGuard(&stream);
+
+    auto inBuf  = std::make_unique<unsigned char[]>(CHUNK);
+    auto outBuf = std::make_unique<unsigned char[]>(CHUNK);
+
+    int flush;
+    do
+    {
+        auto size = std::fread(inBuf.get(), 1, CHUNK, in.get());
+        if (std::ferror(in.get()))
+            ThrowLog4spEx("Failed reading file " + filename_to_str(src), errno);
+
+        flush = std::feof(in.get()) ? Z_FINISH : Z_NO_FLUSH;
+        stream.next_in  = inBuf.get();
+        stream.avail_in = static_cast<uInt>(size);
+
+        do
+        {
+            stream.next_out  = outBuf.get();
+            stream.avail_out = static_cast<uInt>(CHUNK);
+            (void)deflate(&stream, flush);      // 输入与输出缓冲区都有效时不会失败
+
+            auto have = CHUNK - stream.avail_out;
+            if (std::fwrite(outBuf.get(), 1, have, out.get()) != have)
+                ThrowLog4spEx("Failed writing file " + filename_to_str(tmp), errno);
+        } while (stream.avail_out == 0);
+    } while (flush != Z_FINISH);
+
+    in.reset();
+    if (std::fclose(out.release()) != 0)
+        ThrowLog4spEx("Failed writing file " + filename_to_str(tmp), errno);
+
+    (void)spdlog::details::os::remove_if_exists(dst);
+    if (spdlog::details::os::rename(tmp, dst) != 0)
+        ThrowLog4spEx("Failed renaming " + filename_to_str(tmp) + " to " + filename_to_str(dst), errno);
+
+    if (spdlog::details::os::remove(src) != 0)
+        ThrowLog4spEx("Failed removing file " + filename_to_str(src), errno);
+}
+
+void FileCompressor::Post(Job job)
+{
+    Push(Task{{}, std::move(job)});
+}
+
+bool FileCompressor::PostFile(const spdlog::filename_t &file, Job job)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        if (!m_Files.insert(file).second)
+            return false;
+    }
+
+    try
+    {
+        Push(Task{file, std::move(job)});
+    }
+    catch (...)
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Files.erase(file);
+        throw;
+    }
+    return true;
+}
+
+void FileCompressor::Push(Task task)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        if (!m_Thread.joinable())
+            m_Thread = std::thread(&FileCompressor::Run, this);
+        m_Jobs.push_back(std::move(task));
+    }
+    m_Cond.notify_one();
+}
+
+void FileCompressor::Run() noexcept
+{
+    while (true)
+    {
+        Task task;
+        {
+            std::unique_lock<std::mutex> lock(m_Mutex);
+            m_Cond.wait(lock, [this]() { return m_Stop || !m_Jobs.empty(); });
+
+            // 停止前执行完所有任务，避免留下未压缩的临时文件
+            if (m_Jobs.empty())
+                return;
+
+            task = std::move(m_Jobs.front());
+            m_Jobs.pop_front();
+        }
+
+        try
+        {
+            task.job();
+        }
+        catch (const std::exception &ex)
+        {
+            try
+            {
+                FrameTaskQueue::Instance().Post([what = std::string(ex.what())]() {
+                    smutils->LogError(myself, "[%s] %s", SMEXT_CONF_LOGTAG, what.c_str());
+                });
+            }
+            catch (...)
+            {
+                // 无法报告错误，忽略
+            }
+        }
+        catch (...)
+        {
+            // 任务只会抛出 spdlog_ex 与 std::bad_alloc
+        }
+
+        if (!task.file.empty())
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            m_Files.erase(task.file);
+        }
+    }
+}
+
+
+}       // namespace Log4sp
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <unordered_set>
+
+#include "spdlog/common.h"
+
+
+namespace Log4sp {
+
+/**
+ * 在后台线程中压缩已轮换的日志文件 (gzip)
+ *
+ * rotating_file_sink 与 daily_file_sink 轮换时只改名或关闭文件，压缩与之后的文件移动全部交给工作线程按顺序执行
+ * 所以游戏线程不会被压缩阻塞，连续的轮换也不会打乱轮换链的顺序
+ *
+ * 工作线程在第一次压缩时启动，拓展卸载时等待队列中的文件压缩完成后结束
+ * 压缩失败时在下一个游戏帧记录到 SourceMod 的错误日志
+ */
+class FileCompressor final
+{
+public:
+    using Job = std::function<void()>;
+
+    // 压缩后的文件名为 原文件名 + Extension
+    static constexpr const char *Extension = ".gz";
+
+    /**
+     * @brief 全局单例对象
+     */
+    [[nodiscard]]
+    static FileCompressor &Instance() noexcept;
+
+    /**
+     * @brief 用于 SDK_OnUnload 时等待队列中的文件压缩完成，并结束工作线程。
+     */
+    static void Destroy() noexcept;
+
+    /**
+     * @brief 用于 rotating_file_sink
+     *        轮换出的文件被压缩为 base.1.ext.gz，之前的压缩文件依次后移，超过 maxFiles 的被删除
+     *        sink 创建时会先压缩上次崩溃时残留的 .rotated 临时文件
+     */
+    [[nodiscard]]
+    static spdlog::rotated_file_handlers RotatingHandlers(const spdlog::filename_t &base, std::size_t maxFiles);
+
+    /**
+     * @brief 用于 daily_file_sink
+     *        轮换出的文件被压缩为 原文件名.gz，超过 maxFiles 的旧文件也由工作线程在压缩之后删除
+     *        sink 创建时会先压缩程序未运行期间错过轮换的文件 (例如前一天停止、第二天启动)
+     */
+    [[nodiscard]]
+    static spdlog::rotated_file_handlers DailyHandlers();
+
+    /**
+     * @brief 将 src 压缩为 dst 并删除 src
+     *        先写入临时文件，完成后再改名，所以 dst 不会是不完整的文件
+     *
+     * @exception       读取、写入或改名失败
+     */
+    static void Compress(const spdlog::filename_t &src, const spdlog::filename_t &dst);
+
+    /**
+     * @brief 添加一个任务，由工作线程按添加的顺序执行
+     * @note  线程安全
+     *
+     * @exception       工作线程启动失败
+     */
+    void Post(Job job);
+
+    /**
+     * @brief 添加一个处理 file 的任务
+     *        file 已有排队或执行中的任务时忽略，sink 创建时找回的残留文件可能正是本进程还没有压缩完的文件
+     * @note  线程安全
+     *
+     * @return          是否添加了任务
+     * @exception       工作线程启动失败
+     */
+    bool PostFile(const spdlog::filename_t &file, Job job);
+
+    FileCompressor(const FileCompressor &) = delete;
+    FileCompressor &operator=(const FileCompressor &) = delete;
+
+private:
+    FileCompressor() = default;
+    ~FileCompressor() = default;
+
+    struct Task
+    {
+        spdlog::filename_t file;                    // 任务处理的文件，为空表示不需要去重
+        Job job;
+    };
+
+    void Run() noexcept;
+    void Push(Task task);
+
+    std::mutex m_Mutex;
+    std::condition_variable m_Cond;
+    std::deque<Task> m_Jobs;
+    std::unordered_set<spdlog::filename_t> m_Files;     // 排队或执行中的任务所处理的文件
+    bool m_Stop{false};
+    std::thread m_Thread;
+};
+
+
+}       // namespace Log4sp
@@ -0,0 +1,128 @@
+#include <algorithm>
+
+#include "log4sp/common.h"
+#include "log4sp/logger.h"
+#include "log4sp/flush_scheduler.h"
+#include "log4sp/adapter/logger_handler.h"
+
+
+namespace Log4sp {
+
+[[nodiscard]]
+FlushScheduler &FlushScheduler::Instance() noexcept
+{
+    static FlushScheduler instance;
+    return instance;
+}
+
+void FlushScheduler::Schedule(const Logger *logger)
+{
+    m_Pending.push_back(logger);
+}
+
+void FlushScheduler::ScheduleSummary(const Logger *logger)
+{
+    m_PendingSummaries.push_back(logger);
+}
+
+void FlushScheduler::ScheduleWriteBuffer(const spdlog::sink_ptr &sink, std::chrono::milliseconds interval, WriteBufferDue due)
+{
+    m_WriteBufferSinks.push_back(WriteBufferSink{sink, interval, due, Clock::now()});
+}
+
+void FlushScheduler::Cancel(const Logger *logger) noexcept
+{
+    m_Pending.erase(std::remove(m_Pending.begin(), m_Pending.end(), logger), m_Pending.end());
+    std::replace(m_Running.begin(), m_Running.end(), logger, static_cast<const Logger *>(nullptr));
+
+    m_PendingSummaries.erase(std::remove(m_PendingSummaries.begin(), m_PendingSummaries.end(), logger), m_PendingSummaries.end());
+    std::replace(m_RunningSummaries.begin(), m_RunningSummaries.end(), logger, static_cast<const Logger *>(nullptr));
+}
+
+void FlushScheduler::RunFrame() noexcept
+{
+    if (m_Pending.empty() && m_PendingSummaries.empty() && m_WriteBufferSinks.empty())
+        return;
+
+    auto now = Clock::now();
+
+    if (!m_WriteBufferSinks.empty())
+        RunWriteBuffers(now);
+
+    m_RunningSummaries.swap(m_PendingSummaries);
+    for (std::size_t i = 0; i < m_RunningSummaries.size(); ++i)
+    {
+        auto logger = m_RunningSummaries[i];
+        if (!logger)
+            continue;
+
+        if (!logger->ScheduledSummaryDue(now))
+        {
+            m_PendingSummaries.push_back(logger);
+            continue;
+        }
+
+        logger->ScheduledSummary(now);
+    }
+    m_RunningSummaries.clear();
+
+    m_Running.swap(m_Pending);
+    for (std::size_t i = 0; i < m_Running.size(); ++i)
+    {
+        auto logger = m_Running[i];
+        if (!logger)
+            continue;
+
+        if (!logger->ScheduledFlushDue(now))
+        {
+            m_Pending.push_back(logger);
+            continue;
+        }
+
+        logger->ScheduledFlush(now);
+    }
+    m_Running.clear();
+}
+
+void FlushScheduler::RunWriteBuffers(Clock::time_point now) noexcept
+{
+    m_WriteBufferSinks.erase(std::remove_if(m_WriteBufferSinks.begin(), m_WriteBufferSinks.end(), [](const WriteBufferSink &entry) {
+        return entry.sink.expired();
+    }), m_WriteBufferSinks.end());
+
+    for (auto &entry : m_WriteBufferSinks)
+    {
+        auto sink = entry.sink.lock();
+        if (!sink)
+            continue;
+
+        if (LoggerHandler::Instance().IsAsyncSink(sink.get()))
+        {
+            if (now - entry.lastAsyncFlush >= entry.interval)
+            {
+                entry.lastAsyncFlush = now;
+                LoggerHandler::Instance().FlushAsyncOwners(sink.get());
+            }
+            continue;
+        }
+
+        if (!entry.due(sink.get(), now))
+            continue;
+
+        try
+        {
+            sink->flush();
+        }
+        catch (const std::exception &ex)
+        {
+            smutils->LogError(myself, "[%s] Failed to flush write buffer (reason: %s)", SMEXT_CONF_LOGTAG, ex.what());
+        }
+        catch (...)
+        {
+            smutils->LogError(myself, "[%s] Failed to flush write buffer (reason: unknown exception)", SMEXT_CONF_LOGTAG);
+        }
+    }
+}
+
+
+}       // namespace Log4sp
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <chrono>
+#include <memory>
+#include <vector>
+
+#include "spdlog/common.h"
+
+
+namespace Log4sp {
+
+class Logger;
+
+// 达到 flush level 的消息何时刷新
+enum class FlushPolicy
+{
+    Immediate,      // 每条消息后立即刷新 (默认)
+    Frame,          // 标记为待刷新，每个游戏帧最多刷新一次
+    Interval        // 标记为待刷新，每 N 毫秒最多刷新一次
+};
+
+/**
+ * 延迟刷新的调度器
+ *
+ * 使用 FlushPolicy::Frame / FlushPolicy::Interval 的 Logger 在需要刷新时只会被标记
+ * 由拓展的游戏帧钩子调用 RunFrame 统一刷新，一次日志风暴只产生一次 flush 系统调用
+ *
+ * 限流丢弃了消息的 Logger 也会被加入，之后没有消息通过时由 RunFrame 报告被丢弃的数量
+ *
+ * 设置了 flushInterval 的写缓冲文件 sink 只在写入时检查间隔，空闲的 sink 由 RunFrame 在间隔到期后刷新
+ *
+ * 只能在主线程使用
+ */
+class FlushScheduler final
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    // 判断文件 sink 最早的缓冲写入是否已超过 flushInterval
+    using WriteBufferDue = bool (*)(spdlog::sinks::sink *sink, Clock::time_point now);
+
+    /**
+     * @brief 全局单例对象
+     */
+    [[nodiscard]]
+    static FlushScheduler &Instance() noexcept;
+
+    /**
+     * @brief 将 logger 加入待刷新列表
+     * @note  调用者需要保证同一个 logger 不会重复加入
+     */
+    void Schedule(const Logger *logger);
+
+    /**
+     * @brief 将 logger 加入待报告限流丢弃数量的列表
+     * @note  调用者需要保证同一个 logger 不会重复加入
+     */
+    void ScheduleSummary(const Logger *logger);
+
+    /**
+     * @brief 注册写缓冲文件 sink，没有设置写缓冲或 flushInterval 时什么也不做
+     * @note  sink 释放后自动移除
+     */
+    template <typename FileSink>
+    void ScheduleWriteBuffer(const std::shared_ptr<FileSink> &sink) {
+        auto interval = sink->write_buffer_interval();
+        if (sink->write_buffer_size() == 0 || interval.count() <= 0)
+            return;
+
+        ScheduleWriteBuffer(sink, interval, [](spdlog::sinks::sink *s, Clock::time_point now) {
+            return static_cast<FileSink *>(s)->write_buffer_due(now);
+        });
+    }
+    void ScheduleWriteBuffer(const spdlog::sink_ptr &sink, std::chrono::milliseconds interval, WriteBufferDue due);
+
+    /**
+     * @brief 将 logger 移出待刷新与待报告列表，用于 logger 析构时
+     */
+    void Cancel(const Logger *logger) noexcept;
+
+    /**
+     * @brief 刷新 (报告) 所有已到期的 logger，未到期的 logger 保留到之后的帧
+     */
+    void RunFrame() noexcept;
+
+    FlushScheduler(const FlushScheduler &) = delete;
+    FlushScheduler &operator=(const FlushScheduler &) = delete;
+
+private:
+    FlushScheduler() = default;
+    ~FlushScheduler() = default;
+
+    void RunWriteBuffers(Clock::time_point now) noexcept;
+
+    struct WriteBufferSink
+    {
+        std::weak_ptr<spdlog::sinks::sink> sink;
+        std::chrono::milliseconds interval;
+        WriteBufferDue due;
+        Clock::time_point lastAsyncFlush;       // 异步 Logger 的 sink 由工作线程写入，不能读取缓冲状态，只能每个间隔请求刷新一次
+    };
+
+    std::vector<const Logger *> m_Pending;
+    std::vector<const Logger *> m_Running;      // 刷新时可能执行插件回调并释放 logger，所以需要能被 Cancel
+    std::vector<const Logger *> m_PendingSummaries;
+    std::vector<const Logger *> m_RunningSummaries;
+    std::vector<WriteBufferSink> m_WriteBufferSinks;
+};
+
+
+}       // namespace Log4sp
@@ -1,19 +1,21 @@
 #include <cassert>
-#include <type_traits>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
 #include <limits>
-
-#include "am-float.h"
+#include <memory>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
 
 #include "log4sp/format.h"
+#include "log4sp/format_kernel.h"
+#include "log4sp/translation_cache.h"
 
 
 namespace Log4sp {
 
-// ref: https://github.com/alliedmodders/sourcemod/blob/master/core/logic/sprintf.cpp
-inline static constexpr int LADJUST     = 0x00000001;   // left adjustment
-inline static constexpr int ZEROPAD     = 0x00000002;   // zero (as opposed to blank) pad
-inline static constexpr int UPPERDIGITS = 0x00000004;   // make alpha digits uppercase
-
 #define CHECK_ARGS(x)   \
     if ((arg+x) > args) \
         ThrowError("String formatted incorrectly - parameter {} (total {})", arg, args);
@@ -27,455 +29,150 @@ void ThrowError(spdlog::format_string_t<Args...> fmt, Args&&... args)
     spdlog::throw_spdlog_ex(spdlog::fmt_lib::format(fmt, std::forward<Args>(args)...));
 }
 
-[[nodiscard]]
-std::string FormatToString(SourcePawn::IPluginContext *ctx, const cell_t *params, const unsigned int param)
+// 按 layout 格式化并追加到 out，*param 指向第一个格式化参数，完成后指向下一个未使用的参数
+static
+void FormatLayout(spdlog::memory_buf_t &out, SourcePawn::IPluginContext *ctx, const char *layout, const cell_t *params, unsigned int *param);
+
+
+void FormatToBuffer(spdlog::memory_buf_t &out, SourcePawn::IPluginContext *ctx, const cell_t *params, const unsigned int param)
 {
     assert(ctx && params);
 
     char *format;
     CTX_LOCAL_TO_STRING(params[param], &format);
     unsigned int lparam = param + 1;
-    return spdlog::fmt_lib::to_string(FormatToBuffer(ctx, format, params, &lparam));
+    FormatLayout(out, ctx, format, params, &lparam);
 }
 
 
-inline static
-void ReorderTranslationParams(const SourceMod::Translation *pTrans, cell_t *params) noexcept
+// 每层嵌套调用各自的缓冲区
+struct FormatBufferPool
 {
-    cell_t new_params[MAX_TRANSLATE_PARAMS];
-    for (unsigned int i = 0; i < pTrans->fmt_count; ++i)
-    {
-        new_params[i] = params[pTrans->fmt_order[i]];
-    }
-    memcpy(params, new_params, pTrans->fmt_count * sizeof(cell_t));
-}
+    std::vector<std::unique_ptr<spdlog::memory_buf_t>> buffers;
+    std::size_t depth{0};
+};
 
-inline static
-spdlog::memory_buf_t Translate(SourcePawn::IPluginContext *ctx, const char *key, cell_t target, const cell_t *params, unsigned int *arg)
-{
-    unsigned int langid;
-    SourceMod::Translation pTrans;
-    SourceMod::IPlugin *pPlugin = PluginSysFindPluginByCtx(ctx);
-    SourceMod::IPhraseCollection *pPhrases = pPlugin->GetPhrases();
+static thread_local FormatBufferPool t_FormatBufferPool;
 
-try_serverlang:
-    if (target == SOURCEMOD_SERVER_LANGUAGE)
-    {
-        langid = translator->GetServerLanguage();
-    }
-    else if ((target >= 1) && (target <= playerhelpers->GetMaxClients()))
-    {
-        langid = translator->GetClientLanguage(target);
-    }
-    else
-    {
-        ThrowError("Translation failed: invalid client index {} (arg {})", target, *arg);
-    }
-
-    if (pPhrases->FindTranslation(key, langid, &pTrans) != Trans_Okay)
-    {
-        if (target != SOURCEMOD_SERVER_LANGUAGE && langid != translator->GetServerLanguage())
-        {
-            target = SOURCEMOD_SERVER_LANGUAGE;
-            goto try_serverlang;
-        }
-        else if (langid != SOURCEMOD_LANGUAGE_ENGLISH)
-        {
-            if (pPhrases->FindTranslation(key, SOURCEMOD_LANGUAGE_ENGLISH, &pTrans) != Trans_Okay)
-            {
-                ThrowError("Language phrase \"{}\" not found (arg {})", key, *arg);
-            }
-        }
-        else
-        {
-            ThrowError("Language phrase \"{}\" not found (arg {})", key, *arg);
-        }
-    }
-
-    unsigned int max_params = pTrans.fmt_count;
-
-    if (max_params)
-    {
-        cell_t new_params[MAX_TRANSLATE_PARAMS];
-
-        /* Check if we're going to over the limit */
-        if ((*arg) + (max_params - 1) > static_cast<unsigned int>(params[0]))
-            ThrowError("Translation string formatted incorrectly - missing at least {} parameters (arg {})",
-                        ((*arg + (max_params - 1)) - params[0]), *arg);
+FormatBuffer::FormatBuffer()
+{
+    auto &pool = t_FormatBufferPool;
+    if (pool.depth == pool.buffers.size())
+        pool.buffers.emplace_back();
 
-        /**
-         * If we need to re-order the parameters, do so with a temporary array.
-         * Otherwise, we could run into trouble with continual formats, a la ShowActivity().
-         */
-        memcpy(new_params, params, sizeof(cell_t) * (params[0] + 1));
-        ReorderTranslationParams(&pTrans, &new_params[*arg]);
+    auto &buffer = pool.buffers[pool.depth];
+    if (!buffer)
+        buffer = std::make_unique<spdlog::memory_buf_t>();
 
-        return FormatToBuffer(ctx, pTrans.szPhrase, new_params, arg);
-    }
+    ++pool.depth;
 
-    return FormatToBuffer(ctx, pTrans.szPhrase, params, arg);
+    m_Buffer = buffer.get();
+    m_Buffer->clear();
 }
 
-inline static
-void AddString(spdlog::memory_buf_t &out, const char *string, unsigned int width, int prec, int flags) noexcept
+FormatBuffer::~FormatBuffer() noexcept
 {
-    if (string == nullptr)
-    {
-        AddString(out, "(null)", width, prec, flags);
-        return;
-    }
+    auto &pool = t_FormatBufferPool;
+    assert(pool.depth > 0 && pool.buffers[pool.depth - 1].get() == m_Buffer);
 
-    unsigned int size = static_cast<unsigned int>(std::strlen(string));
-    if (prec >= 0 && static_cast<unsigned int>(prec) < size)
-    {
-        size = static_cast<unsigned int>(prec);
-    }
-
-    // Number of spaces to be pad
-    unsigned int pads = (width <= size) ? (0u) : (width - size);
-
-    // right justify if required
-    if (!(flags & LADJUST))
-    {
-        while (pads)
-        {
-            pads--;
-            out.push_back(' ');
-        }
-    }
+    --pool.depth;
+    if (m_Buffer->capacity() > MaxRetainedCapacity)
+        pool.buffers[pool.depth].reset();
+}
 
-    out.append(string, string + size);
 
-    // left justify if required
-    if (flags & LADJUST)
+inline static
+void ReorderTranslationParams(const TranslationCache::Entry &entry, cell_t *params) noexcept
+{
+    cell_t new_params[MAX_TRANSLATE_PARAMS];
+    for (unsigned int i = 0; i < entry.fmtCount; ++i)
     {
-        while (pads)
-        {
-            pads--;
-            out.push_back(' ');
-        }
+        new_params[i] = params[entry.fmtOrder[i]];
     }
+    memcpy(params, new_params, entry.fmtCount * sizeof(cell_t));
 }
 
 inline static
-void AddFloat(spdlog::memory_buf_t &out, double fval, unsigned int width, int prec, int flags) noexcept
+const TranslationCache::Entry &FindTranslation(SourcePawn::IPluginContext *ctx, const char *key, cell_t target, unsigned int arg)
 {
-    int digits;                 // non-fraction part digits
-    double tmp;                 // temporary
-    int val;                    // temporary
-    bool sign = false;          // false: positive, true: negative
-    unsigned int fieldlength;   // for padding
-    int significant_digits = 0; // number of significant digits written
-    constexpr const int MAX_SIGNIFICANT_DIGITS = 16;
-
-    if (ke::IsNaN(static_cast<float>(fval)))
-    {
-        AddString(out, "NaN", width, prec, flags);
-        return;
-    }
-
-    if (ke::IsInfinite(static_cast<float>(fval)))
-    {
-        const char *str = ((fval < 0.0f) ? "-Inf" : "Inf");
-        AddString(out, str, width, prec, flags);
-        return;
-    }
-
-    // default precision
-    if (prec < 0)
-    {
-        prec = 6;
-    }
-
-    // get the sign
-    if (fval < 0)
-    {
-        fval = -fval;
-        sign = true;
-    }
-
-    // compute whole-part digits count
-    digits = (int)std::log10(fval) + 1;
-
-    // Only print 0.something if 0 < fval < 1
-    if (digits < 1)
-    {
-        digits = 1;
-    }
-
-    // compute the field length
-    fieldlength = digits + prec + ((prec > 0) ? 1 : 0) + (sign ? 1 : 0);
-
-    // minus sign BEFORE left padding if padding with zeros
-    if (sign && (flags & ZEROPAD))
-    {
-        out.push_back('-');
-    }
-
-    // right justify if required
-    if (!(flags & LADJUST))
-    {
-        while (fieldlength < width--)
-        {
-            out.push_back((flags & ZEROPAD) ? '0' : ' ');
-        }
-    }
-
-    // minus sign AFTER left padding if padding with spaces
-    if (sign && !(flags & ZEROPAD))
-    {
-        out.push_back('-');
-    }
-
-    // write the whole part
-    tmp = std::pow(10.0, digits - 1);
-    if (++significant_digits > MAX_SIGNIFICANT_DIGITS)
-    {
-        while (digits--)
-        {
-            out.push_back('0');
-        }
-    }
-    else
-    {
-        while (digits--)
-        {
-            val = (int)(fval / tmp);
-            out.push_back('0' + static_cast<char>(val));
-            fval -= val * tmp;
-            tmp *= 0.1;
-        }
-    }
+    unsigned int langid;
+    const unsigned int serverLangid = translator->GetServerLanguage();
 
-    // write the fraction part
-    if (prec)
+    if (target == SOURCEMOD_SERVER_LANGUAGE)
     {
-        out.push_back('.');
+        langid = serverLangid;
     }
-
-    tmp = std::pow(10.0, prec);
-
-    fval *= tmp;
-    if (++significant_digits > MAX_SIGNIFICANT_DIGITS)
+    else if ((target >= 1) && (target <= playerhelpers->GetMaxClients()))
     {
-        while (prec--)
-        {
-            out.push_back('0');
-        }
+        langid = translator->GetClientLanguage(target);
     }
     else
     {
-        while (prec--)
-        {
-            tmp *= 0.1;
-            val = (int)(fval / tmp);
-            out.push_back('0' + static_cast<char>(val));
-            fval -= val * tmp;
-        }
+        ThrowError("Translation failed: invalid client index {} (arg {})", target, arg);
     }
 
-    // left justify if required
-    if (flags & LADJUST)
+    auto &cache = TranslationCache::Instance();
+    SourceMod::IPhraseCollection *pPhrases;
+    if (auto entry = cache.Find(ctx, &pPhrases, key, langid, serverLangid))
     {
-        while (fieldlength < width--)
-        {
-            // right-padding only with spaces, ZEROPAD is ignored
-            out.push_back(' ');
-        }
+        return *entry;
     }
-}
-
-template <typename T>
-inline static
-void AddBinary(spdlog::memory_buf_t &out, T val, unsigned int width, int flags) noexcept
-{
-    static_assert(std::is_unsigned_v<T> && std::is_integral_v<T>, "T must be an unsigned integral type");
-
-    constexpr const int MAX_TEXT = sizeof(T) * CHAR_BIT;
-    char text[MAX_TEXT];
-    int iter = MAX_TEXT - 1;
 
-    do
-    {
-        text[iter--] = (val & 1) ? '1' : '0';
-    } while (val >>= 1);
-
-    const char *begin   = text + iter + 1;
-    unsigned int digits = MAX_TEXT - iter - 1;
-    unsigned int pads   = (width <= digits) ? (0u) : (width - digits);
-
-    // right justify if required
-    if (!(flags & LADJUST))
+    // 未命中缓存，按 SourceMod 的规则回退: 请求的语言 -> 服务器语言 -> 英语
+    SourceMod::Translation pTrans;
+    if (pPhrases->FindTranslation(key, langid, &pTrans) != Trans_Okay)
     {
-        while (pads)
+        if (langid != serverLangid && pPhrases->FindTranslation(key, serverLangid, &pTrans) == Trans_Okay)
         {
-            pads--;
-            out.push_back((flags & ZEROPAD) ? '0' : ' ');
+            // found in server language
         }
-    }
-
-    out.append(begin, text + MAX_TEXT);
-
-    // left justify if required
-    if (flags & LADJUST)
-    {
-        while (pads)
+        else if (serverLangid != SOURCEMOD_LANGUAGE_ENGLISH)
         {
-            pads--;
-            out.push_back((flags & ZEROPAD) ? '0' : ' ');
+            if (pPhrases->FindTranslation(key, SOURCEMOD_LANGUAGE_ENGLISH, &pTrans) != Trans_Okay)
+            {
+                ThrowError("Language phrase \"{}\" not found (arg {})", key, arg);
+            }
         }
-    }
-}
-
-template <typename T>
-inline static void AddUInt(spdlog::memory_buf_t &out, T val, unsigned int width, int flags) noexcept
-{
-    static_assert(std::is_unsigned_v<T> && std::is_integral_v<T>, "T must be an unsigned integral type");
-    static_assert(std::numeric_limits<std::uint32_t>::digits10 == 9);
-    static_assert(std::numeric_limits<std::uint64_t>::digits10 == 19);
-
-    constexpr unsigned int MAX_TEXT = std::numeric_limits<T>::digits10 + 1;
-    char text[MAX_TEXT];
-    unsigned int digits = 0;
-
-    do {
-        text[digits++] = '0' + val % 10;
-    } while (val /= 10);
-
-    unsigned int pads = (width <= digits) ? (0u) : (width - digits);
-
-    // right justify if required
-    if (!(flags & LADJUST))
-    {
-        while (pads)
+        else
         {
-            pads--;
-            out.push_back((flags & ZEROPAD) ? '0' : ' ');
+            ThrowError("Language phrase \"{}\" not found (arg {})", key, arg);
         }
     }
 
-    while (digits)
-    {
-        out.push_back(text[--digits]);
-    }
-
-    // left justify if required
-    if (flags & LADJUST)
-    {
-        while (pads)
-        {
-            pads--;
-            out.push_back((flags & ZEROPAD) ? '0' : ' ');
-        }
-    }
+    return cache.Insert(ctx, key, langid, serverLangid, pTrans);
 }
 
-template <typename T>
 inline static
-void AddInt(spdlog::memory_buf_t &out, T val, unsigned int width, int flags) noexcept
+void Translate(spdlog::memory_buf_t &out, SourcePawn::IPluginContext *ctx, const char *key, cell_t target, const cell_t *params, unsigned int *arg)
 {
-    static_assert(std::is_integral_v<T>, "T must be an integral type");
-    static_assert(std::numeric_limits<std::int32_t>::digits10 == 9);
-    static_assert(std::numeric_limits<std::int64_t>::digits10 == 18);
+    const auto &entry = FindTranslation(ctx, key, target, *arg);
 
-    constexpr unsigned int MAX_TEXT = std::numeric_limits<int64_t>::digits10 + 2;
-    char text[MAX_TEXT];
-    unsigned int digits = 0;
+    unsigned int max_params = entry.fmtCount;
 
-    const bool negative = val < 0;
-    std::make_unsigned_t<T> unsignedVal = negative ? std::abs(val) : val;
-
-    do {
-        text[digits++] = '0' + unsignedVal % 10;
-    } while (unsignedVal /= 10);
-
-    unsigned int pads = (width <= digits) ? (0u) : (width - digits);
-    if (pads > 0 && negative) {
-        pads--;
-    }
-
-    // minus sign BEFORE left padding if padding with zeros
-    if (negative && (flags & ZEROPAD))
-    {
-        out.push_back('-');
-    }
-
-    // right justify if required
-    if (!(flags & LADJUST))
-    {
-        while (pads)
-        {
-            pads--;
-            out.push_back((flags & ZEROPAD) ? '0' : ' ');
-        }
-    }
-
-    // minus sign AFTER left padding if padding with spaces
-    if (negative && !(flags & ZEROPAD))
-    {
-        out.push_back('-');
-    }
-
-    while (digits)
-    {
-        out.push_back(text[--digits]);
-    }
-
-    // left justify if required
-    if (flags & LADJUST)
+    if (max_params)
     {
-        while (pads)
-        {
-            pads--;
-            out.push_back((flags & ZEROPAD) ? '0' : ' ');
-        }
-    }
-}
-
-template <typename T>
-inline static
-void AddHex(spdlog::memory_buf_t &out, T val, unsigned int width, int flags) noexcept
-{
-    static_assert(std::is_unsigned_v<T> && std::is_integral_v<T>, "T must be an unsigned integral type");
-
-    constexpr const char *hexUpper = "0123456789ABCDEF";
-    constexpr const char *hexLower = "0123456789abcdef";
-    const char *hexAdjust = (flags & UPPERDIGITS) ? hexUpper : hexLower;
-
-    constexpr unsigned int MAX_TEXT = sizeof(T) * 16 / CHAR_BIT;
-    char text[MAX_TEXT];
-    unsigned int digits = 0;
-
-    do {
-        text[digits++] = hexAdjust[val & 0xF];
-    } while(val >>= 4);
-
-    unsigned int pads = (width <= digits) ? (0u) : (width - digits);
+        /* Check if we're going to over the limit */
+        if ((*arg) + (max_params - 1) > static_cast<unsigned int>(params[0]))
+            ThrowError("Translation string formatted incorrectly - missing at least {} parameters (arg {})",
+                        ((*arg + (max_params - 1)) - params[0]), *arg);
 
-    // right justify if required
-    if (!(flags & LADJUST))
-    {
-        while (pads)
+        if (!entry.inOrder)
         {
-            pads--;
-            out.push_back((flags & ZEROPAD) ? '0' : ' ');
+            /**
+             * If we need to re-order the parameters, do so with a temporary array.
+             * Otherwise, we could run into trouble with continual formats, a la ShowActivity().
+             * Only the parameters up to the last one used by the phrase are needed.
+             */
+            cell_t new_params[MAX_TRANSLATE_PARAMS];
+            memcpy(new_params, params, sizeof(cell_t) * (*arg + max_params));
+            ReorderTranslationParams(entry, &new_params[*arg]);
+
+            FormatLayout(out, ctx, entry.phrase.c_str(), new_params, arg);
+            return;
         }
     }
 
-    while (digits)
-    {
-        out.push_back(text[--digits]);
-    }
-
-    // left justify if required
-    if (flags & LADJUST)
-    {
-        while (pads)
-        {
-            pads--;
-            out.push_back((flags & ZEROPAD) ? '0' : ' ');
-        }
-    }
+    FormatLayout(out, ctx, entry.phrase.c_str(), params, arg);
 }
 
 inline static
@@ -515,96 +212,100 @@ bool DescribePlayer(int entRef, const char **namep, const char **authp, int *use
     return true;
 }
 
-[[nodiscard]]
-inline
-spdlog::memory_buf_t FormatToBuffer(SourcePawn::IPluginContext *ctx, const char *layout, const cell_t *params, unsigned int *param)
+/**
+ * 以格式化字符串的地址与内容为键缓存预编译结果
+ *
+ * 地址命中时只需要比较一次内容 (同一地址的缓冲区内容可能已改变)
+ * 地址未命中时按内容的哈希查找，内容相同的格式化字符串 (例如不同插件中的相同字面量) 共享同一份预编译结果
+ *
+ * 缓存从不解引用已保存的地址，所以插件卸载后残留的地址是安全的
+ * 只在主线程使用
+ */
+class FormatCache final
 {
-    assert(ctx && layout && params && *param <= SP_MAX_EXEC_PARAMS);
+public:
+    [[nodiscard]]
+    std::shared_ptr<const CompiledFormat> Get(const char *layout)
+    {
+        auto iter = m_ByAddress.find(layout);
+        if (iter != m_ByAddress.end() && Matches(iter->second->text, layout))
+            return iter->second;
 
-    using spdlog::memory_buf_t;
-    using spdlog::fmt_lib::format;
+        std::string_view content{layout};
+        std::shared_ptr<const CompiledFormat> compiled;
 
-    memory_buf_t out;
-    unsigned int args = params[0];  // params count
-    unsigned int arg  = *param;     // 用于遍历 params 的指针
-    const char *iter  = layout;     // 用于遍历 layout 的指针
-    int flags;                      // 对齐 (左 / 右) | 填充符 ('0' / ' ')
-    int prec;                       // 精度
-    unsigned int width;             // 宽度
+        auto contentIter = m_ByContent.find(content);
+        if (contentIter != m_ByContent.end())
+        {
+            compiled = contentIter->second;
+        }
+        else
+        {
+            if (m_ByContent.size() >= MaxEntries)
+            {
+                m_ByAddress.clear();
+                m_ByContent.clear();
+            }
+
+            compiled = CompileFormat(content);
+            m_ByContent.emplace(std::string_view{compiled->text}, compiled);
+        }
+
+        if (m_ByAddress.size() >= MaxEntries)
+            m_ByAddress.clear();
+
+        m_ByAddress[layout] = compiled;
+        return compiled;
+    }
 
-    while (true)
+private:
+    static constexpr std::size_t MaxEntries = 1024;
+
+    [[nodiscard]]
+    static bool Matches(const std::string &text, const char *layout) noexcept
     {
-        const char *begin = iter;
+        // 比较长度 + 1 个字符，包含 '\0'，且不会越过 layout 的结尾
+        return std::strncmp(text.c_str(), layout, text.size() + 1) == 0;
+    }
 
-        // run through the layout string until we hit a '%' or '\0'
-        while (*iter != '%' && *iter != '\0')
-        {
-            ++iter;
-        }
+    std::unordered_map<const char *, std::shared_ptr<const CompiledFormat>> m_ByAddress;
+    std::unordered_map<std::string_view, std::shared_ptr<const CompiledFormat>> m_ByContent;   // 键指向 CompiledFormat::text
+};
 
-        out.append(begin, iter);
+[[nodiscard]]
+static
+std::shared_ptr<const CompiledFormat> GetCompiledFormat(const char *layout)
+{
+    static FormatCache cache;
+    return cache.Get(layout);
+}
 
-        if (*iter == '\0')
-        {
-            *param = arg;
-            return out;
-        }
+static
+void FormatLayout(spdlog::memory_buf_t &out, SourcePawn::IPluginContext *ctx, const char *layout, const cell_t *params, unsigned int *param)
+{
+    assert(ctx && layout && params && *param <= SP_MAX_EXEC_PARAMS);
 
-        // skip over the '%'
-        ++iter;
+    // 持有引用，避免 %T / %t 递归格式化时缓存被清空
+    const std::shared_ptr<const CompiledFormat> compiled = GetCompiledFormat(layout);
+    const char *text = compiled->text.c_str();
 
-        // reset formatting state
-        flags = 0;
-        width = 0;
-        prec = -1;
+    unsigned int args = params[0];  // params count
+    unsigned int arg  = *param;     // 用于遍历 params 的指针
+
+    for (const FormatOp &op : compiled->ops)
+    {
+        const int flags          = op.flags;
+        const int prec           = op.prec;
+        const unsigned int width = op.width;
 
-rflag:
-        char ch = *iter++;
-reswitch:
-        switch(ch)
+        switch (op.type)
         {
-        case '-':
+        case FormatOpType::Literal:
             {
-                flags |= LADJUST;
-                goto rflag;
-            }
-        case '.':
-            {
-                int n = 0;
-                ch = *iter++;
-                while (ch >= '0' && ch <= '9')
-                {
-                    n = 10 * n + (ch - '0');
-                    ch = *iter++;
-                }
-                prec = (n < 0) ? -1 : n;
-                goto reswitch;
-            }
-        case '0':
-            {
-                flags |= ZEROPAD;
-                goto rflag;
-            }
-        case '1':
-        case '2':
-        case '3':
-        case '4':
-        case '5':
-        case '6':
-        case '7':
-        case '8':
-        case '9':
-            {
-                unsigned int n = 0;
-                do
-                {
-                    n = 10 * n + (ch - '0');
-                    ch = *iter++;
-                } while(ch >= '0' && ch <= '9');
-                width = n;
-                goto reswitch;
+                out.append(text + op.begin, text + op.begin + op.size);
+                break;
             }
-        case 'c':
+        case FormatOpType::Char:
             {
                 CHECK_ARGS(0);
                 char *c;
@@ -614,7 +315,7 @@ reswitch:
                 ++arg;
                 break;
             }
-        case 'b':
+        case FormatOpType::Binary:
             {
                 CHECK_ARGS(0);
                 cell_t *value;
@@ -624,8 +325,7 @@ reswitch:
                 ++arg;
                 break;
             }
-        case 'd':
-        case 'i':
+        case FormatOpType::Int:
             {
                 CHECK_ARGS(0);
                 cell_t *value;
@@ -635,7 +335,7 @@ reswitch:
                 ++arg;
                 break;
             }
-        case 'u':
+        case FormatOpType::UInt:
             {
                 CHECK_ARGS(0);
                 cell_t *value;
@@ -645,7 +345,7 @@ reswitch:
                 ++arg;
                 break;
             }
-        case 'f':
+        case FormatOpType::Float:
             {
                 CHECK_ARGS(0);
                 cell_t *value;
@@ -655,7 +355,7 @@ reswitch:
                 ++arg;
                 break;
             }
-        case 'L':
+        case FormatOpType::Client:
             {
                 CHECK_ARGS(0);
                 cell_t *value;
@@ -669,7 +369,10 @@ reswitch:
                     if (!DescribePlayer(*value, &name, &auth, &userid))
                         ThrowError("Client index {} is invalid (arg {})", *value, arg);
 
-                    AddString(out, format("{}<{}><{}><>", name, userid, auth).c_str(), width, prec, flags);
+                    spdlog::memory_buf_t desc;
+                    spdlog::fmt_lib::format_to(std::back_inserter(desc), "{}<{}><{}><>", name, userid, auth);
+                    desc.push_back('\0');
+                    AddString(out, desc.data(), width, prec, flags);
                 }
                 else
                 {
@@ -678,7 +381,7 @@ reswitch:
                 ++arg;
                 break;
             }
-        case 'N':
+        case FormatOpType::ClientName:
             {
                 CHECK_ARGS(0);
                 cell_t *value;
@@ -699,7 +402,7 @@ reswitch:
                 ++arg;
                 break;
             }
-        case 'E':
+        case FormatOpType::Entity:
             {
                 CHECK_ARGS(0);
                 cell_t *value;
@@ -715,7 +418,7 @@ reswitch:
                 ++arg;
                 break;
             }
-        case 's':
+        case FormatOpType::String:
             {
                 CHECK_ARGS(0);
                 char *str;
@@ -725,7 +428,7 @@ reswitch:
                 ++arg;
                 break;
             }
-        case 'T':
+        case FormatOpType::Translate:
             {
                 CHECK_ARGS(1);
                 char *key;
@@ -733,22 +436,20 @@ reswitch:
                 CTX_LOCAL_TO_STRING(params[arg++], &key);
                 CTX_LOCAL_TO_PHYS_ADDR(params[arg++], &target);
 
-                spdlog::memory_buf_t phrase = Translate(ctx, key, *target, params, &arg);
-                out.append(phrase.begin(), phrase.end());
+                Translate(out, ctx, key, *target, params, &arg);
                 break;
             }
-        case 't':
+        case FormatOpType::TranslateGlobal:
             {
                 CHECK_ARGS(0);
                 char *key;
                 CTX_LOCAL_TO_STRING(params[arg++], &key);
                 auto target = static_cast<cell_t>(translator->GetGlobalTarget());
 
-                spdlog::memory_buf_t phrase = Translate(ctx, key, target, params, &arg);
-                out.append(phrase.begin(), phrase.end());
+                Translate(out, ctx, key, target, params, &arg);
                 break;
             }
-        case 'X':
+        case FormatOpType::HexUpper:
             {
                 CHECK_ARGS(0);
                 cell_t *value;
@@ -758,7 +459,7 @@ reswitch:
                 ++arg;
                 break;
             }
-        case 'x':
+        case FormatOpType::Hex:
             {
                 CHECK_ARGS(0);
                 cell_t *value;
@@ -768,86 +469,253 @@ reswitch:
                 ++arg;
                 break;
             }
-        case 'l':
+        case FormatOpType::LongBinary:
+            {
+                CHECK_ARGS(0);
+                cell_t *value;
+                CTX_LOCAL_TO_PHYS_ADDR(params[arg], &value);
+
+                AddBinary(out, *reinterpret_cast<std::uint64_t*>(value), width, flags);
+                ++arg;
+                break;
+            }
+        case FormatOpType::LongInt:
+            {
+                CHECK_ARGS(0);
+                cell_t *value;
+                CTX_LOCAL_TO_PHYS_ADDR(params[arg], &value);
+
+                AddInt(out, *reinterpret_cast<std::int64_t*>(value), width, flags);
+                ++arg;
+                break;
+            }
+        case FormatOpType::LongUInt:
+            {
+                CHECK_ARGS(0);
+                cell_t *value;
+                CTX_LOCAL_TO_PHYS_ADDR(params[arg], &value);
+
+                AddUInt(out, *reinterpret_cast<std::uint64_t*>(value), width, flags);
+                ++arg;
+                break;
+            }
+        case FormatOpType::LongHexUpper:
+            {
+                CHECK_ARGS(0);
+                cell_t *value;
+                CTX_LOCAL_TO_PHYS_ADDR(params[arg], &value);
+
+                AddHex(out, *reinterpret_cast<std::uint64_t*>(value), width, flags | UPPERDIGITS);
+                ++arg;
+                break;
+            }
+        case FormatOpType::LongHex:
+            {
+                CHECK_ARGS(0);
+                cell_t *value;
+                CTX_LOCAL_TO_PHYS_ADDR(params[arg], &value);
+
+                AddHex(out, *reinterpret_cast<std::uint64_t*>(value), width, flags);
+                ++arg;
+                break;
+            }
+        case FormatOpType::LongInvalid:
+            {
+                CHECK_ARGS(0);
+                ThrowError("{}", "Invalid formatter. Only %lb, %ld, %li, %lu, %lX, %lx are allowed.");
+            }
+        }
+    }
+
+    *param = arg;
+}
+
+// 与 FormatLayout 的参数检查与错误完全相同，只是保存参数而不格式化，编码见 PutCaptured
+static
+void CaptureLayout(spdlog::memory_buf_t &out, SourcePawn::IPluginContext *ctx, const char *layout, const cell_t *params, unsigned int *param)
+{
+    assert(ctx && layout && params && *param <= SP_MAX_EXEC_PARAMS);
+
+    const std::shared_ptr<const CompiledFormat> compiled = GetCompiledFormat(layout);
+
+    unsigned int args = params[0];  // params count
+    unsigned int arg  = *param;     // 用于遍历 params 的指针
+
+    for (const FormatOp &op : compiled->ops)
+    {
+        switch (op.type)
+        {
+        case FormatOpType::Literal:
+            {
+                break;
+            }
+        case FormatOpType::Char:
+            {
+                CHECK_ARGS(0);
+                char *c;
+                CTX_LOCAL_TO_STRING(params[arg], &c);
+
+                PutCaptured(out, *c);
+                ++arg;
+                break;
+            }
+        case FormatOpType::Binary:
+        case FormatOpType::Int:
+        case FormatOpType::UInt:
+        case FormatOpType::Float:
+        case FormatOpType::HexUpper:
+        case FormatOpType::Hex:
+            {
+                CHECK_ARGS(0);
+                cell_t *value;
+                CTX_LOCAL_TO_PHYS_ADDR(params[arg], &value);
+
+                PutCaptured(out, *value);
+                ++arg;
+                break;
+            }
+        case FormatOpType::LongBinary:
+        case FormatOpType::LongInt:
+        case FormatOpType::LongUInt:
+        case FormatOpType::LongHexUpper:
+        case FormatOpType::LongHex:
             {
                 CHECK_ARGS(0);
-                ch = *iter++;
+                cell_t *value;
+                CTX_LOCAL_TO_PHYS_ADDR(params[arg], &value);
+
+                PutCaptured(out, *reinterpret_cast<std::uint64_t*>(value));
+                ++arg;
+                break;
+            }
+        case FormatOpType::Client:
+            {
+                CHECK_ARGS(0);
+                cell_t *value;
+                CTX_LOCAL_TO_PHYS_ADDR(params[arg], &value);
+
+                if (*value)
+                {
+                    const char *name;
+                    const char *auth;
+                    int userid;
+                    if (!DescribePlayer(*value, &name, &auth, &userid))
+                        ThrowError("Client index {} is invalid (arg {})", *value, arg);
+
+                    spdlog::memory_buf_t desc;
+                    spdlog::fmt_lib::format_to(std::back_inserter(desc), "{}<{}><{}><>", name, userid, auth);
+                    PutCapturedString(out, {desc.data(), desc.size()});
+                }
+                else
+                {
+                    PutCapturedString(out, "Console<0><Console><Console>");
+                }
+                ++arg;
+                break;
+            }
+        case FormatOpType::ClientName:
+            {
+                CHECK_ARGS(0);
+                cell_t *value;
+                CTX_LOCAL_TO_PHYS_ADDR(params[arg], &value);
+
+                if (*value)
+                {
+                    const char *name;
+                    if (!DescribePlayer(*value, &name, nullptr, nullptr))
+                        ThrowError("Client index {} is invalid (arg {})", *value, arg);
 
-                switch (ch)
+                    PutCapturedString(out, name);
+                }
+                else
                 {
-                case 'b':
-                    {
-                        cell_t *value;
-                        CTX_LOCAL_TO_PHYS_ADDR(params[arg], &value);
-
-                        AddBinary(out, *reinterpret_cast<std::uint64_t*>(value), width, flags);
-                        ++arg;
-                        break;
-                    }
-                case 'd':
-                case 'i':
-                    {
-                        cell_t *value;
-                        CTX_LOCAL_TO_PHYS_ADDR(params[arg], &value);
-
-                        AddInt(out, *reinterpret_cast<std::int64_t*>(value), width, flags);
-                        ++arg;
-                        break;
-                    }
-                case 'u':
-                    {
-                        cell_t *value;
-                        CTX_LOCAL_TO_PHYS_ADDR(params[arg], &value);
-
-                        AddUInt(out, *reinterpret_cast<std::uint64_t*>(value), width, flags);
-                        ++arg;
-                        break;
-                    }
-                case 'X':
-                    {
-                        cell_t *value;
-                        CTX_LOCAL_TO_PHYS_ADDR(params[arg], &value);
-
-                        AddHex(out, *reinterpret_cast<std::uint64_t*>(value), width, flags | UPPERDIGITS);
-                        ++arg;
-                        break;
-                    }
-                case 'x':
-                    {
-                        cell_t *value;
-                        CTX_LOCAL_TO_PHYS_ADDR(params[arg], &value);
-
-                        AddHex(out, *reinterpret_cast<std::uint64_t*>(value), width, flags);
-                        ++arg;
-                        break;
-                    }
-                default:
-                    ThrowError("{}", "Invalid formatter. Only %lb, %ld, %li, %lu, %lX, %lx are allowed.");
+                    PutCapturedString(out, "Console");
                 }
+                ++arg;
                 break;
             }
-        case '%':
+        case FormatOpType::Entity:
             {
-                out.push_back(ch);
+                CHECK_ARGS(0);
+                cell_t *value;
+                CTX_LOCAL_TO_PHYS_ADDR(params[arg], &value);
+
+                CBaseEntity *entity = gamehelpers->ReferenceToEntity(*value);
+                if (!entity)
+                    ThrowError("Entity index {} is invalid (arg {})", *value, arg);
+
+                const char *classname = gamehelpers->GetEntityClassname(entity);
+                PutCapturedString(out, classname ? classname : "(null)");
+                ++arg;
                 break;
             }
-        case '\0':
+        case FormatOpType::String:
             {
-                out.push_back('%');
-                *param = arg;
-                return out;
+                CHECK_ARGS(0);
+                char *str;
+                CTX_LOCAL_TO_STRING(params[arg], &str);
+
+                PutCapturedString(out, str);
+                ++arg;
+                break;
             }
-        default:
+        case FormatOpType::Translate:
             {
-                out.push_back(ch);
+                CHECK_ARGS(1);
+                char *key;
+                cell_t *target;
+                CTX_LOCAL_TO_STRING(params[arg++], &key);
+                CTX_LOCAL_TO_PHYS_ADDR(params[arg++], &target);
+
+                FormatBuffer text;
+                Translate(text.Get(), ctx, key, *target, params, &arg);
+                PutCapturedString(out, {text.Get().data(), text.Get().size()});
                 break;
             }
+        case FormatOpType::TranslateGlobal:
+            {
+                CHECK_ARGS(0);
+                char *key;
+                CTX_LOCAL_TO_STRING(params[arg++], &key);
+                auto target = static_cast<cell_t>(translator->GetGlobalTarget());
+
+                FormatBuffer text;
+                Translate(text.Get(), ctx, key, target, params, &arg);
+                PutCapturedString(out, {text.Get().data(), text.Get().size()});
+                break;
+            }
+        case FormatOpType::LongInvalid:
+            {
+                CHECK_ARGS(0);
+                ThrowError("{}", "Invalid formatter. Only %lb, %ld, %li, %lu, %lX, %lx are allowed.");
+            }
         }
     }
 
     *param = arg;
-    return out;
 }
 
+std::string_view CaptureToBuffer(spdlog::memory_buf_t &out, SourcePawn::IPluginContext *ctx, const cell_t *params, const unsigned int param)
+{
+    assert(ctx && params);
+
+    char *format;
+    CTX_LOCAL_TO_STRING(params[param], &format);
+    unsigned int lparam = param + 1;
+    CaptureLayout(out, ctx, format, params, &lparam);
+    return format;
+}
+
+
+#ifdef DEBUG
+void FormatFloat(spdlog::memory_buf_t &out, float value, unsigned int width, int prec, bool legacy) noexcept
+{
+    if (legacy)
+        AddFloatLegacy(out, value, width, prec, 0);
+    else
+        AddFloat(out, value, width, prec, 0);
+}
+#endif
+
 
 }       // namespace Log4sp
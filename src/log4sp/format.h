@@ -7,11 +7,59 @@
 
 namespace Log4sp {
 
-[[nodiscard]]
-std::string FormatToString(SourcePawn::IPluginContext *ctx, const cell_t *params, const unsigned int param);
+/**
+ * 格式化插件传入的参数，并将结果追加到 out
+ *
+ * @param param     格式化字符串在 params 中的位置，之后的参数为格式化参数
+ * @exception       格式化字符串或参数错误
+ */
+void FormatToBuffer(spdlog::memory_buf_t &out, SourcePawn::IPluginContext *ctx, const cell_t *params, const unsigned int param);
 
+/**
+ * 不格式化消息，只保存格式化参数并将其追加到 out，之后可以用 RenderCaptured 渲染 (见 format_kernel.h)
+ * 参数检查与 FormatToBuffer 相同，%T %t 在此时翻译
+ *
+ * @param param     格式化字符串在 params 中的位置，之后的参数为格式化参数
+ * @return          格式化字符串，指向插件的内存，只在本次 native 调用期间有效
+ * @exception       格式化字符串或参数错误
+ */
 [[nodiscard]]
-spdlog::memory_buf_t FormatToBuffer(SourcePawn::IPluginContext *ctx, const char *format, const cell_t *params, unsigned int *param);
+std::string_view CaptureToBuffer(spdlog::memory_buf_t &out, SourcePawn::IPluginContext *ctx, const cell_t *params, const unsigned int param);
+
+/**
+ * 格式化日志消息时使用的可重用缓冲区
+ *
+ * 缓冲区属于当前线程，析构时归还，容量保留给下一次使用，所以稳定状态下格式化不会分配堆内存
+ * 嵌套的日志调用 (例如 CallbackSink 的回调中再次记录日志) 会使用下一层的缓冲区，不会覆盖外层的消息
+ */
+class FormatBuffer final
+{
+public:
+    // 归还时容量超过此值的缓冲区会被释放，避免一条超长消息永久占用内存
+    static constexpr std::size_t MaxRetainedCapacity = 64 * 1024;
+
+    FormatBuffer();
+    ~FormatBuffer() noexcept;
+
+    FormatBuffer(const FormatBuffer &) = delete;
+    FormatBuffer &operator=(const FormatBuffer &) = delete;
+
+    [[nodiscard]] spdlog::memory_buf_t &Get() noexcept { return *m_Buffer; }
+
+    [[nodiscard]] spdlog::string_view_t View() const noexcept { return {m_Buffer->data(), m_Buffer->size()}; }
+
+private:
+    spdlog::memory_buf_t *m_Buffer;
+};
+
+#ifdef DEBUG
+/**
+ * 以 SourceMod 的 %f 规则格式化浮点数，仅用于测试与基准测试
+ *
+ * @param legacy    true 使用 SourceMod 原版的实现，false 使用 FormatToBuffer 实际使用的实现
+ */
+void FormatFloat(spdlog::memory_buf_t &out, float value, unsigned int width, int prec, bool legacy) noexcept;
+#endif
 
 
 }   // namespace Log4sp
@@ -0,0 +1,834 @@
+#pragma once
+
+#include <cassert>
+#include <climits>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include "am-float.h"
+
+#include "spdlog/common.h"
+
+
+/**
+ * 格式化的底层实现，不依赖 SourceMod
+ * FormatToBuffer 与离线工具 (例如 tools/binlog_decode) 共用，保证两者的输出完全一致
+ */
+namespace Log4sp {
+
+// ref: https://github.com/alliedmodders/sourcemod/blob/master/core/logic/sprintf.cpp
+inline constexpr int LADJUST     = 0x00000001;   // left adjustment
+inline constexpr int ZEROPAD     = 0x00000002;   // zero (as opposed to blank) pad
+inline constexpr int UPPERDIGITS = 0x00000004;   // make alpha digits uppercase
+
+inline
+void AddString(spdlog::memory_buf_t &out, const char *string, unsigned int width, int prec, int flags) noexcept
+{
+    if (string == nullptr)
+    {
+        AddString(out, "(null)", width, prec, flags);
+        return;
+    }
+
+    unsigned int size = static_cast<unsigned int>(std::strlen(string));
+    if (prec >= 0 && static_cast<unsigned int>(prec) < size)
+    {
+        size = static_cast<unsigned int>(prec);
+    }
+
+    // Number of spaces to be pad
+    unsigned int pads = (width <= size) ? (0u) : (width - size);
+
+    // right justify if required
+    if (!(flags & LADJUST))
+    {
+        while (pads)
+        {
+            pads--;
+            out.push_back(' ');
+        }
+    }
+
+    out.append(string, string + size);
+
+    // left justify if required
+    if (flags & LADJUST)
+    {
+        while (pads)
+        {
+            pads--;
+            out.push_back(' ');
+        }
+    }
+}
+
+/**
+ * SourceMod 原版的 %f 实现，使用浮点运算逐位截断
+ * AddFloat 无法精确处理的值 (非常大或非常小) 仍然交给它，以保持输出一致
+ */
+inline
+void AddFloatLegacy(spdlog::memory_buf_t &out, double fval, unsigned int width, int prec, int flags) noexcept
+{
+    int digits;                 // non-fraction part digits
+    double tmp;                 // temporary
+    int val;                    // temporary
+    bool sign = false;          // false: positive, true: negative
+    unsigned int fieldlength;   // for padding
+    int significant_digits = 0; // number of significant digits written
+    constexpr const int MAX_SIGNIFICANT_DIGITS = 16;
+
+    if (ke::IsNaN(static_cast<float>(fval)))
+    {
+        AddString(out, "NaN", width, prec, flags);
+        return;
+    }
+
+    if (ke::IsInfinite(static_cast<float>(fval)))
+    {
+        const char *str = ((fval < 0.0f) ? "-Inf" : "Inf");
+        AddString(out, str, width, prec, flags);
+        return;
+    }
+
+    // default precision
+    if (prec < 0)
+    {
+        prec = 6;
+    }
+
+    // get the sign
+    if (fval < 0)
+    {
+        fval = -fval;
+        sign = true;
+    }
+
+    // compute whole-part digits count
+    digits = (int)std::log10(fval) + 1;
+
+    // Only print 0.something if 0 < fval < 1
+    if (digits < 1)
+    {
+        digits = 1;
+    }
+
+    // compute the field length
+    fieldlength = digits + prec + ((prec > 0) ? 1 : 0) + (sign ? 1 : 0);
+
+    // minus sign BEFORE left padding if padding with zeros
+    if (sign && (flags & ZEROPAD))
+    {
+        out.push_back('-');
+    }
+
+    // right justify if required
+    if (!(flags & LADJUST))
+    {
+        while (fieldlength < width--)
+        {
+            out.push_back((flags & ZEROPAD) ? '0' : ' ');
+        }
+    }
+
+    // minus sign AFTER left padding if padding with spaces
+    if (sign && !(flags & ZEROPAD))
+    {
+        out.push_back('-');
+    }
+
+    // write the whole part
+    tmp = std::pow(10.0, digits - 1);
+    if (++significant_digits > MAX_SIGNIFICANT_DIGITS)
+    {
+        while (digits--)
+        {
+            out.push_back('0');
+        }
+    }
+    else
+    {
+        while (digits--)
+        {
+            val = (int)(fval / tmp);
+            out.push_back('0' + static_cast<char>(val));
+            fval -= val * tmp;
+            tmp *= 0.1;
+        }
+    }
+
+    // write the fraction part
+    if (prec)
+    {
+        out.push_back('.');
+    }
+
+    tmp = std::pow(10.0, prec);
+
+    fval *= tmp;
+    if (++significant_digits > MAX_SIGNIFICANT_DIGITS)
+    {
+        while (prec--)
+        {
+            out.push_back('0');
+        }
+    }
+    else
+    {
+        while (prec--)
+        {
+            tmp *= 0.1;
+            val = (int)(fval / tmp);
+            out.push_back('0' + static_cast<char>(val));
+            fval -= val * tmp;
+        }
+    }
+
+    // left justify if required
+    if (flags & LADJUST)
+    {
+        while (fieldlength < width--)
+        {
+            // right-padding only with spaces, ZEROPAD is ignored
+            out.push_back(' ');
+        }
+    }
+}
+
+/**
+ * %f 的快速实现
+ *
+ * SourceMod 的 %f 会截断 (而不是四舍五入) 浮点数的精确值，例如 123.456f 输出 "123.456001"
+ * 所以不能使用 fmt 的 Dragonbox (最短往返表示)，否则输出会与 SourceMod 不一致
+ *
+ * 这里将浮点数拆分为 mantissa / 2^q，整数部分与小数部分都用 64 位整数运算精确地逐位生成
+ * 对于 [2^-36, 2^52) 范围以外的值，回退到 AddFloatLegacy
+ *
+ * 精度超过 12 位时，AddFloatLegacy 的浮点运算误差会影响末位，不再是精确值
+ * 为了与 SourceMod 的输出一致，这种情况也回退到 AddFloatLegacy
+ */
+inline
+void AddFloat(spdlog::memory_buf_t &out, double fval, unsigned int width, int prec, int flags) noexcept
+{
+    constexpr int MAX_FRACTION_BITS = 60;   // 小数部分乘以 10 后不能溢出 64 位
+    constexpr int MAX_EXACT_PRECISION = 12; // 不超过这个精度时 AddFloatLegacy 的输出等于精确的截断值
+
+    if (prec > MAX_EXACT_PRECISION ||
+        ke::IsNaN(static_cast<float>(fval)) || ke::IsInfinite(static_cast<float>(fval)))
+    {
+        AddFloatLegacy(out, fval, width, prec, flags);
+        return;
+    }
+
+    std::uint64_t bits;
+    std::memcpy(&bits, &fval, sizeof(bits));
+
+    const int biasedExp = static_cast<int>((bits >> 52) & 0x7FF);
+    std::uint64_t mantissa = bits & ((std::uint64_t{1} << 52) - 1);
+    std::uint64_t whole = 0;        // 整数部分
+    std::uint64_t fraction = 0;     // 小数部分 = fraction / 2^q
+    int q = 0;
+
+    if (biasedExp != 0)
+    {
+        // fval = mantissa / 2^q
+        mantissa |= std::uint64_t{1} << 52;
+        q = 1075 - biasedExp;
+        if (q <= 0)
+        {
+            AddFloatLegacy(out, fval, width, prec, flags);
+            return;
+        }
+
+        // float 转换来的 double 尾部有大量 0，去掉它们可以处理更小的值
+        while (q > MAX_FRACTION_BITS && !(mantissa & 1))
+        {
+            mantissa >>= 1;
+            --q;
+        }
+
+        if (q > MAX_FRACTION_BITS)
+        {
+            AddFloatLegacy(out, fval, width, prec, flags);
+            return;
+        }
+
+        whole = mantissa >> q;
+        fraction = mantissa & ((std::uint64_t{1} << q) - 1);
+    }
+    else if (mantissa != 0)
+    {
+        // denormal
+        AddFloatLegacy(out, fval, width, prec, flags);
+        return;
+    }
+
+    // default precision
+    if (prec < 0)
+    {
+        prec = 6;
+    }
+
+    // same as AddFloatLegacy, -0.0 has no sign
+    bool sign = fval < 0;
+
+    // write the whole part into a temporary buffer (backwards)
+    char wholeBuffer[20];
+    char *wholeBegin = std::end(wholeBuffer);
+    do
+    {
+        *--wholeBegin = static_cast<char>('0' + whole % 10);
+        whole /= 10;
+    } while (whole);
+
+    unsigned int digits = static_cast<unsigned int>(std::end(wholeBuffer) - wholeBegin);
+
+    // compute the field length
+    unsigned int fieldlength = digits + prec + ((prec > 0) ? 1 : 0) + (sign ? 1 : 0);
+
+    // minus sign BEFORE left padding if padding with zeros
+    if (sign && (flags & ZEROPAD))
+    {
+        out.push_back('-');
+    }
+
+    // right justify if required
+    if (!(flags & LADJUST))
+    {
+        while (fieldlength < width--)
+        {
+            out.push_back((flags & ZEROPAD) ? '0' : ' ');
+        }
+    }
+
+    // minus sign AFTER left padding if padding with spaces
+    if (sign && !(flags & ZEROPAD))
+    {
+        out.push_back('-');
+    }
+
+    // write the whole part
+    out.append(wholeBegin, std::end(wholeBuffer));
+
+    // write the fraction part
+    if (prec)
+    {
+        out.push_back('.');
+    }
+
+    const std::uint64_t mask = (std::uint64_t{1} << q) - 1;
+    while (prec--)
+    {
+        fraction *= 10;
+        out.push_back(static_cast<char>('0' + (fraction >> q)));
+        fraction &= mask;
+    }
+
+    // left justify if required
+    if (flags & LADJUST)
+    {
+        while (fieldlength < width--)
+        {
+            // right-padding only with spaces, ZEROPAD is ignored
+            out.push_back(' ');
+        }
+    }
+}
+
+template <typename T>
+inline
+void AddBinary(spdlog::memory_buf_t &out, T val, unsigned int width, int flags) noexcept
+{
+    static_assert(std::is_unsigned_v<T> && std::is_integral_v<T>, "T must be an unsigned integral type");
+
+    constexpr const int MAX_TEXT = sizeof(T) * CHAR_BIT;
+    char text[MAX_TEXT];
+    int iter = MAX_TEXT - 1;
+
+    do
+    {
+        text[iter--] = (val & 1) ? '1' : '0';
+    } while (val >>= 1);
+
+    const char *begin   = text + iter + 1;
+    unsigned int digits = MAX_TEXT - iter - 1;
+    unsigned int pads   = (width <= digits) ? (0u) : (width - digits);
+
+    // right justify if required
+    if (!(flags & LADJUST))
+    {
+        while (pads)
+        {
+            pads--;
+            out.push_back((flags & ZEROPAD) ? '0' : ' ');
+        }
+    }
+
+    out.append(begin, text + MAX_TEXT);
+
+    // left justify if required
+    if (flags & LADJUST)
+    {
+        while (pads)
+        {
+            pads--;
+            out.push_back((flags & ZEROPAD) ? '0' : ' ');
+        }
+    }
+}
+
+template <typename T>
+inline void AddUInt(spdlog::memory_buf_t &out, T val, unsigned int width, int flags) noexcept
+{
+    static_assert(std::is_unsigned_v<T> && std::is_integral_v<T>, "T must be an unsigned integral type");
+    static_assert(std::numeric_limits<std::uint32_t>::digits10 == 9);
+    static_assert(std::numeric_limits<std::uint64_t>::digits10 == 19);
+
+    constexpr unsigned int MAX_TEXT = std::numeric_limits<T>::digits10 + 1;
+    char text[MAX_TEXT];
+    unsigned int digits = 0;
+
+    do {
+        text[digits++] = '0' + val % 10;
+    } while (val /= 10);
+
+    unsigned int pads = (width <= digits) ? (0u) : (width - digits);
+
+    // right justify if required
+    if (!(flags & LADJUST))
+    {
+        while (pads)
+        {
+            pads--;
+            out.push_back((flags & ZEROPAD) ? '0' : ' ');
+        }
+    }
+
+    while (digits)
+    {
+        out.push_back(text[--digits]);
+    }
+
+    // left justify if required
+    if (flags & LADJUST)
+    {
+        while (pads)
+        {
+            pads--;
+            out.push_back((flags & ZEROPAD) ? '0' : ' ');
+        }
+    }
+}
+
+template <typename T>
+inline
+void AddInt(spdlog::memory_buf_t &out, T val, unsigned int width, int flags) noexcept
+{
+    static_assert(std::is_integral_v<T>, "T must be an integral type");
+    static_assert(std::numeric_limits<std::int32_t>::digits10 == 9);
+    static_assert(std::numeric_limits<std::int64_t>::digits10 == 18);
+
+    constexpr unsigned int MAX_TEXT = std::numeric_limits<int64_t>::digits10 + 2;
+    char text[MAX_TEXT];
+    unsigned int digits = 0;
+
+    const bool negative = val < 0;
+    std::make_unsigned_t<T> unsignedVal = negative ? std::abs(val) : val;
+
+    do {
+        text[digits++] = '0' + unsignedVal % 10;
+    } while (unsignedVal /= 10);
+
+    unsigned int pads = (width <= digits) ? (0u) : (width - digits);
+    if (pads > 0 && negative) {
+        pads--;
+    }
+
+    // minus sign BEFORE left padding if padding with zeros
+    if (negative && (flags & ZEROPAD))
+    {
+        out.push_back('-');
+    }
+
+    // right justify if required
+    if (!(flags & LADJUST))
+    {
+        while (pads)
+        {
+            pads--;
+            out.push_back((flags & ZEROPAD) ? '0' : ' ');
+        }
+    }
+
+    // minus sign AFTER left padding if padding with spaces
+    if (negative && !(flags & ZEROPAD))
+    {
+        out.push_back('-');
+    }
+
+    while (digits)
+    {
+        out.push_back(text[--digits]);
+    }
+
+    // left justify if required
+    if (flags & LADJUST)
+    {
+        while (pads)
+        {
+            pads--;
+            out.push_back((flags & ZEROPAD) ? '0' : ' ');
+        }
+    }
+}
+
+template <typename T>
+inline
+void AddHex(spdlog::memory_buf_t &out, T val, unsigned int width, int flags) noexcept
+{
+    static_assert(std::is_unsigned_v<T> && std::is_integral_v<T>, "T must be an unsigned integral type");
+
+    constexpr const char *hexUpper = "0123456789ABCDEF";
+    constexpr const char *hexLower = "0123456789abcdef";
+    const char *hexAdjust = (flags & UPPERDIGITS) ? hexUpper : hexLower;
+
+    constexpr unsigned int MAX_TEXT = sizeof(T) * 16 / CHAR_BIT;
+    char text[MAX_TEXT];
+    unsigned int digits = 0;
+
+    do {
+        text[digits++] = hexAdjust[val & 0xF];
+    } while(val >>= 4);
+
+    unsigned int pads = (width <= digits) ? (0u) : (width - digits);
+
+    // right justify if required
+    if (!(flags & LADJUST))
+    {
+        while (pads)
+        {
+            pads--;
+            out.push_back((flags & ZEROPAD) ? '0' : ' ');
+        }
+    }
+
+    while (digits)
+    {
+        out.push_back(text[--digits]);
+    }
+
+    // left justify if required
+    if (flags & LADJUST)
+    {
+        while (pads)
+        {
+            pads--;
+            out.push_back((flags & ZEROPAD) ? '0' : ' ');
+        }
+    }
+}
+
+/**
+ * 预编译的格式化字符串
+ *
+ * 插件通常会反复使用少量相同的格式化字符串，每次都逐字符解析 flags, width, precision 是不必要的
+ * 所以将格式化字符串解析为 "字面量片段" 与 "转换操作" 的列表，之后只需要依次执行
+ *
+ * 解析规则与下方执行规则必须与 SourceMod 的 atcprintf 保持一致
+ */
+enum class FormatOpType : std::uint8_t
+{
+    Literal,            // text[begin, begin + size)
+    Char,               // %c
+    Binary,             // %b
+    Int,                // %d %i
+    UInt,               // %u
+    Float,              // %f
+    Client,             // %L
+    ClientName,         // %N
+    Entity,             // %E
+    String,             // %s
+    Translate,          // %T
+    TranslateGlobal,    // %t
+    HexUpper,           // %X
+    Hex,                // %x
+    LongBinary,         // %lb
+    LongInt,            // %ld %li
+    LongUInt,           // %lu
+    LongHexUpper,       // %lX
+    LongHex,            // %lx
+    LongInvalid         // %l 后跟随无效字符
+};
+
+struct FormatOp
+{
+    FormatOpType type;
+    int flags;
+    int prec;
+    unsigned int width;
+    std::uint32_t begin;
+    std::uint32_t size;
+};
+
+struct CompiledFormat
+{
+    std::string text;
+    std::vector<FormatOp> ops;
+};
+
+[[nodiscard]]
+inline
+std::shared_ptr<const CompiledFormat> CompileFormat(std::string_view layout)
+{
+    auto compiled = std::make_shared<CompiledFormat>();
+    compiled->text.assign(layout.data(), layout.size());
+
+    const char *base = compiled->text.c_str();
+    const char *iter = base;                // 用于遍历 layout 的指针
+    std::vector<FormatOp> &ops = compiled->ops;
+    int flags;                              // 对齐 (左 / 右) | 填充符 ('0' / ' ')
+    int prec;                               // 精度
+    unsigned int width;                     // 宽度
+
+    auto addLiteral = [&ops, base](const char *begin, const char *end)
+    {
+        if (begin != end)
+            ops.push_back({FormatOpType::Literal, 0, -1, 0, static_cast<std::uint32_t>(begin - base), static_cast<std::uint32_t>(end - begin)});
+    };
+
+    auto addConversion = [&ops, &flags, &prec, &width](FormatOpType type)
+    {
+        ops.push_back({type, flags, prec, width, 0, 0});
+    };
+
+    while (true)
+    {
+        const char *begin = iter;
+
+        // run through the layout string until we hit a '%' or '\0'
+        while (*iter != '%' && *iter != '\0')
+        {
+            ++iter;
+        }
+
+        addLiteral(begin, iter);
+
+        if (*iter == '\0')
+        {
+            return compiled;
+        }
+
+        // skip over the '%'
+        const char *percent = iter++;
+
+        // reset formatting state
+        flags = 0;
+        width = 0;
+        prec = -1;
+
+rflag:
+        char ch = *iter++;
+reswitch:
+        switch(ch)
+        {
+        case '-':
+            {
+                flags |= LADJUST;
+                goto rflag;
+            }
+        case '.':
+            {
+                int n = 0;
+                ch = *iter++;
+                while (ch >= '0' && ch <= '9')
+                {
+                    n = 10 * n + (ch - '0');
+                    ch = *iter++;
+                }
+                prec = (n < 0) ? -1 : n;
+                goto reswitch;
+            }
+        case '0':
+            {
+                flags |= ZEROPAD;
+                goto rflag;
+            }
+        case '1':
+        case '2':
+        case '3':
+        case '4':
+        case '5':
+        case '6':
+        case '7':
+        case '8':
+        case '9':
+            {
+                unsigned int n = 0;
+                do
+                {
+                    n = 10 * n + (ch - '0');
+                    ch = *iter++;
+                } while(ch >= '0' && ch <= '9');
+                width = n;
+                goto reswitch;
+            }
+        case 'c':   addConversion(FormatOpType::Char);              break;
+        case 'b':   addConversion(FormatOpType::Binary);            break;
+        case 'd':
+        case 'i':   addConversion(FormatOpType::Int);               break;
+        case 'u':   addConversion(FormatOpType::UInt);              break;
+        case 'f':   addConversion(FormatOpType::Float);             break;
+        case 'L':   addConversion(FormatOpType::Client);            break;
+        case 'N':   addConversion(FormatOpType::ClientName);        break;
+        case 'E':   addConversion(FormatOpType::Entity);            break;
+        case 's':   addConversion(FormatOpType::String);            break;
+        case 'T':   addConversion(FormatOpType::Translate);         break;
+        case 't':   addConversion(FormatOpType::TranslateGlobal);   break;
+        case 'X':   addConversion(FormatOpType::HexUpper);          break;
+        case 'x':   addConversion(FormatOpType::Hex);               break;
+        case 'l':
+            {
+                ch = *iter++;
+                switch (ch)
+                {
+                case 'b':   addConversion(FormatOpType::LongBinary);    break;
+                case 'd':
+                case 'i':   addConversion(FormatOpType::LongInt);       break;
+                case 'u':   addConversion(FormatOpType::LongUInt);      break;
+                case 'X':   addConversion(FormatOpType::LongHexUpper);  break;
+                case 'x':   addConversion(FormatOpType::LongHex);       break;
+                default:
+                    // 执行到此处时必然抛出异常，之后的内容不再需要解析
+                    addConversion(FormatOpType::LongInvalid);
+                    return compiled;
+                }
+                break;
+            }
+        case '%':
+            {
+                addLiteral(iter - 1, iter);
+                break;
+            }
+        case '\0':
+            {
+                addLiteral(percent, percent + 1);
+                return compiled;
+            }
+        default:
+            {
+                addLiteral(iter - 1, iter);
+                break;
+            }
+        }
+    }
+}
+
+/**
+ * 延迟格式化的参数编码
+ *
+ * CaptureToBuffer 不格式化消息，只按格式化字符串中的转换操作依次保存参数的值 (本机字节序)
+ *      %c                          1 字节
+ *      %b %d %i %u %f %X %x        4 字节 (cell_t 原值)
+ *      %lb %ld %li %lu %lX %lx     8 字节
+ *      %s %L %N %E                 uint32 长度 + 字符串 (%L %N %E 保存玩家或实体的描述，宽度与精度在渲染时处理)
+ *      %T %t                       uint32 长度 + 翻译后的完整文本 (渲染时原样输出)
+ * 之后由 RenderCaptured 按同一个格式化字符串渲染，结果与 FormatToBuffer 完全相同
+ */
+template <typename T>
+inline void PutCaptured(spdlog::memory_buf_t &out, T value) noexcept
+{
+    static_assert(std::is_trivially_copyable_v<T>, "T must be trivially copyable");
+
+    const char *data = reinterpret_cast<const char *>(&value);
+    out.append(data, data + sizeof(T));
+}
+
+inline void PutCapturedString(spdlog::memory_buf_t &out, std::string_view str) noexcept
+{
+    PutCaptured(out, static_cast<std::uint32_t>(str.size()));
+    out.append(str.data(), str.data() + str.size());
+}
+
+/**
+ * 按预编译的格式化字符串渲染 CaptureToBuffer 保存的参数，并将结果追加到 out
+ *
+ * @exception       参数数据不完整或多余
+ */
+inline
+void RenderCaptured(spdlog::memory_buf_t &out, const CompiledFormat &compiled, std::string_view args)
+{
+    const char *text = compiled.text.c_str();
+    std::size_t pos = 0;
+
+    auto take = [&args, &pos](std::size_t size) -> const char *
+    {
+        if (args.size() - pos < size)
+            spdlog::throw_spdlog_ex("Captured arguments are truncated");
+
+        const char *data = args.data() + pos;
+        pos += size;
+        return data;
+    };
+
+    auto get = [&take](auto value)
+    {
+        std::memcpy(&value, take(sizeof(value)), sizeof(value));
+        return value;
+    };
+
+    auto getString = [&take, &get]()
+    {
+        auto size = get(std::uint32_t{});
+        return std::string(take(size), size);
+    };
+
+    for (const FormatOp &op : compiled.ops)
+    {
+        const int flags          = op.flags;
+        const int prec           = op.prec;
+        const unsigned int width = op.width;
+
+        switch (op.type)
+        {
+        case FormatOpType::Literal:         out.append(text + op.begin, text + op.begin + op.size);                         break;
+        case FormatOpType::Char:            out.push_back(get(char{}));                                                     break;
+        case FormatOpType::Binary:          AddBinary(out, get(std::uint32_t{}), width, flags);                             break;
+        case FormatOpType::Int:             AddInt(out, get(std::int32_t{}), width, flags);                                 break;
+        case FormatOpType::UInt:            AddUInt(out, get(std::uint32_t{}), width, flags);                               break;
+        case FormatOpType::Float:           AddFloat(out, get(float{}), width, prec, flags);                                break;
+        case FormatOpType::HexUpper:        AddHex(out, get(std::uint32_t{}), width, flags | UPPERDIGITS);                  break;
+        case FormatOpType::Hex:             AddHex(out, get(std::uint32_t{}), width, flags);                                break;
+        case FormatOpType::LongBinary:      AddBinary(out, get(std::uint64_t{}), width, flags);                             break;
+        case FormatOpType::LongInt:         AddInt(out, get(std::int64_t{}), width, flags);                                 break;
+        case FormatOpType::LongUInt:        AddUInt(out, get(std::uint64_t{}), width, flags);                               break;
+        case FormatOpType::LongHexUpper:    AddHex(out, get(std::uint64_t{}), width, flags | UPPERDIGITS);                  break;
+        case FormatOpType::LongHex:         AddHex(out, get(std::uint64_t{}), width, flags);                                break;
+        case FormatOpType::Client:
+        case FormatOpType::ClientName:
+        case FormatOpType::Entity:
+        case FormatOpType::String:          AddString(out, getString().c_str(), width, prec, flags);                        break;
+        case FormatOpType::Translate:
+        case FormatOpType::TranslateGlobal:
+            {
+                auto size = get(std::uint32_t{});
+                const char *data = take(size);
+                out.append(data, data + size);
+                break;
+            }
+        case FormatOpType::LongInvalid:     spdlog::throw_spdlog_ex("Captured arguments contain an invalid formatter");
+        }
+    }
+
+    if (pos != args.size())
+        spdlog::throw_spdlog_ex("Captured arguments do not match the format");
+}
+
+
+}       // namespace Log4sp
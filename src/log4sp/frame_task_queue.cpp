@@ -0,0 +1,70 @@
+#include <cassert>
+
+#include "extension.h"
+
+#include "log4sp/frame_task_queue.h"
+
+
+namespace Log4sp {
+
+[[nodiscard]]
+FrameTaskQueue &FrameTaskQueue::Instance() noexcept
+{
+    static FrameTaskQueue instance;
+    return instance;
+}
+
+void FrameTaskQueue::Initialize() noexcept
+{
+    Instance().m_MainThreadId = std::this_thread::get_id();
+}
+
+void FrameTaskQueue::Destroy() noexcept
+{
+    std::lock_guard<std::mutex> lock(Instance().m_Mutex);
+    Instance().m_Tasks.clear();
+}
+
+[[nodiscard]]
+bool FrameTaskQueue::IsMainThread() const noexcept
+{
+    return std::this_thread::get_id() == m_MainThreadId;
+}
+
+void FrameTaskQueue::Post(Task task)
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_Tasks.push_back(std::move(task));
+}
+
+void FrameTaskQueue::RunAll() noexcept
+{
+    assert(IsMainThread());
+
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        if (m_Tasks.empty())
+            return;
+        m_Running.swap(m_Tasks);
+    }
+
+    for (auto &task : m_Running)
+    {
+        try
+        {
+            task();
+        }
+        catch (const std::exception &ex)
+        {
+            smutils->LogError(myself, "[%s] caught exception during frame task: %s", SMEXT_CONF_LOGTAG, ex.what());
+        }
+        catch (...)
+        {
+            smutils->LogError(myself, "[%s] caught unknown exception during frame task", SMEXT_CONF_LOGTAG);
+        }
+    }
+    m_Running.clear();
+}
+
+
+}       // namespace Log4sp
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+namespace Log4sp {
+/**
+ * SourceMod 的 API (forwards, handlesys, smutils->LogError 等) 只能在主线程调用
+ * 工作线程 (例如异步 Logger) 需要通过此队列将任务交给主线程，在下一个游戏帧执行
+ *
+ * 相比 smutils->AddFrameAction，任务保存在拓展内部，拓展卸载时会被丢弃而不是执行已卸载的代码
+ */
+class FrameTaskQueue final
+{
+public:
+    using Task = std::function<void()>;
+
+    /**
+     * @brief 全局单例对象
+     */
+    [[nodiscard]]
+    static FrameTaskQueue &Instance() noexcept;
+
+    /**
+     * @brief 用于 SDK_OnLoad 时记录主线程。
+     * @note  需要与 destroy 配对使用。
+     */
+    static void Initialize() noexcept;
+
+    /**
+     * @brief 用于 SDK_OnUnload 时丢弃未执行的任务。
+     * @note  需要与 initialize 配对使用。
+     */
+    static void Destroy() noexcept;
+
+    /**
+     * @brief 当前线程是否为主线程 (调用 Initialize 的线程)
+     */
+    [[nodiscard]]
+    bool IsMainThread() const noexcept;
+
+    /**
+     * @brief 添加一个任务，在下一个游戏帧由主线程执行
+     * @note  线程安全
+     *
+     * @param task      待执行的任务
+     */
+    void Post(Task task);
+
+    /**
+     * @brief 执行所有已添加的任务
+     * @note  只能在主线程调用，由拓展的游戏帧钩子调用
+     */
+    void RunAll() noexcept;
+
+    FrameTaskQueue(const FrameTaskQueue &) = delete;
+    FrameTaskQueue &operator=(const FrameTaskQueue &) = delete;
+
+private:
+    FrameTaskQueue() = default;
+    ~FrameTaskQueue() = default;
+
+    std::thread::id m_MainThreadId;
+    std::mutex m_Mutex;
+    std::vector<Task> m_Tasks;
+    std::vector<Task> m_Running;
+};
+
+
+}       // namespace Log4sp
@@ -1,26 +1,44 @@
+#include <algorithm>
 #include <cassert>
+#include <iterator>
+#include <string_view>
 
 #include "spdlog/pattern_formatter.h"
 
 #include "log4sp/format.h"
+#include "log4sp/frame_task_queue.h"
 #include "log4sp/adapter/logger_handler.h"
 
 
 namespace Log4sp {
 
 // log with log4sp format
-void Logger::Log(IPluginContext *ctx, const SourceLoc &loc, LevelEnum lvl, const cell_t *params, unsigned int param) const noexcept
+void Logger::LogFormat(IPluginContext *ctx, const SourceLoc *loc, LevelEnum lvl, const cell_t *params, unsigned int param) const noexcept
 {
     assert(ctx && params);
 
-    if (ShouldLog(lvl))
+    bool sink = ShouldSink(lvl);
+    if (!sink && !ShouldBacktrace(lvl))
+        return;
+
+    SrcHelper source(loc ? *loc : SourceLoc{}, ctx);
+    if (sink && !Admit(lvl, source))
+        return;
+
+    if (!loc)
+        source = SrcHelper(SrcHelper::GetFromPluginCtx(ctx), ctx);
+
+    LogMsg logMsg(loc ? *loc : source.Get(), m_Name, lvl, string_view_t{});
+
+    bool deferred = sink && !m_DeferredSinks.empty();
+    if (deferred)
     {
-        SrcHelper source(loc, ctx);
-        std::string msg;
+        FormatBuffer args;
+        std::string_view format;
 
         try
         {
-            msg = FormatToString(ctx, params, param);
+            format = CaptureToBuffer(args.Get(), ctx, params, param);
         }
         catch (const std::exception &ex)
         {
@@ -33,42 +51,148 @@ void Logger::Log(IPluginContext *ctx, const SourceLoc &loc, LevelEnum lvl, const
             return;
         }
 
-        SinkIt(LogMsg(loc, m_Name, lvl, msg), source);
+        if (!SinkDeferred(logMsg, format, {args.Get().data(), args.Get().size()}, source))
+            return;
+    }
+
+    FormatBuffer msg;
+
+    try
+    {
+        FormatToBuffer(msg.Get(), ctx, params, param);
     }
+    catch (const std::exception &ex)
+    {
+        m_ErrHelper.HandleEx(m_Name, source, ex);
+        return;
+    }
+    catch (...)
+    {
+        m_ErrHelper.HandleUnknownEx(m_Name, source);
+        return;
+    }
+
+    logMsg.payload = msg.View();
+    if (sink)
+        SinkIt(logMsg, source, deferred);
+    else
+        PushBacktrace(logMsg);
+}
+
+/**
+ * AMX 模板与 log4sp format 使用同一个格式化引擎，区别只在于错误处理:
+ * 与 SourceMod 的 Format 一致，格式化错误直接抛给插件，而不是交给 error handler
+ */
+[[nodiscard]]
+static bool FormatAmxTpl(FormatBuffer &msg, IPluginContext *ctx, const cell_t *params, unsigned int param) noexcept
+{
+    try
+    {
+        FormatToBuffer(msg.Get(), ctx, params, param);
+        return true;
+    }
+    catch (const std::exception &ex)
+    {
+        ctx->ReportError("%s", ex.what());
+    }
+    catch (...)
+    {
+        ctx->ReportError("unknown exception");
+    }
+    return false;
+}
+
+// 与 FormatAmxTpl 相同，只是保存参数而不格式化
+[[nodiscard]]
+static bool CaptureAmxTpl(FormatBuffer &args, std::string_view *format, IPluginContext *ctx, const cell_t *params, unsigned int param) noexcept
+{
+    try
+    {
+        *format = CaptureToBuffer(args.Get(), ctx, params, param);
+        return true;
+    }
+    catch (const std::exception &ex)
+    {
+        ctx->ReportError("%s", ex.what());
+    }
+    catch (...)
+    {
+        ctx->ReportError("unknown exception");
+    }
+    return false;
 }
 
 // log with sourcemod format
-void Logger::LogAmxTpl(IPluginContext *ctx, const SourceLoc &loc, LevelEnum lvl, const cell_t *params, unsigned int param) const noexcept
+void Logger::LogFormatAmxTpl(IPluginContext *ctx, const SourceLoc *loc, LevelEnum lvl, const cell_t *params, unsigned int param) const noexcept
 {
     assert(ctx && params);
 
-    if (ShouldLog(lvl))
+    bool sink = ShouldSink(lvl);
+    if (!sink && !ShouldBacktrace(lvl))
+        return;
+
+    SrcHelper src(loc ? *loc : SourceLoc{}, ctx);
+    if (sink && !Admit(lvl, src))
+        return;
+
+    if (!loc)
+        src = SrcHelper(SrcHelper::GetFromPluginCtx(ctx), ctx);
+
+    LogMsg logMsg(loc ? *loc : src.Get(), m_Name, lvl, string_view_t{});
+
+    bool deferred = sink && !m_DeferredSinks.empty();
+    if (deferred)
     {
-        SrcHelper src(loc, ctx);
-        char msg[2048];
-        DetectExceptions eh(ctx);
+        FormatBuffer args;
+        std::string_view format;
 
-        smutils->FormatString(msg, sizeof(msg), ctx, params, param);
-        if (eh.HasException())
+        if (!CaptureAmxTpl(args, &format, ctx, params, param))
             return;
 
-        SinkIt(LogMsg(loc, m_Name, lvl, msg), src);
+        if (!SinkDeferred(logMsg, format, {args.Get().data(), args.Get().size()}, src))
+            return;
     }
+
+    FormatBuffer msg;
+
+    if (!FormatAmxTpl(msg, ctx, params, param))
+        return;
+
+    logMsg.payload = msg.View();
+    if (sink)
+        SinkIt(logMsg, src, deferred);
+    else
+        PushBacktrace(logMsg);
 }
 
 // special log
+void Logger::LogStackTrace(IPluginContext *ctx, LevelEnum lvl, string_view_t msg) const noexcept
+{
+    assert(ctx);
+
+    if (ShouldSink(lvl))
+    {
+        SrcHelper source(ctx);
+        if (Admit(lvl, source))
+            SinkStackTrace(ctx, lvl, "Stack trace requested", msg, "Called from", source);
+    }
+}
+
 void Logger::LogStackTrace(IPluginContext *ctx, LevelEnum lvl, const cell_t *params, unsigned int param) const noexcept
 {
     assert(ctx && params);
 
-    if (ShouldLog(lvl))
+    if (ShouldSink(lvl))
     {
         SrcHelper src(ctx);
-        std::string msg;
+        if (!Admit(lvl, src))
+            return;
+
+        FormatBuffer msg;
 
         try
         {
-            msg = FormatToString(ctx, params, param);
+            FormatToBuffer(msg.Get(), ctx, params, param);
         }
         catch (const std::exception &ex)
         {
@@ -81,15 +205,7 @@ void Logger::LogStackTrace(IPluginContext *ctx, LevelEnum lvl, const cell_t *par
             return;
         }
 
-        using spdlog::fmt_lib::format;
-        SinkIt(LogMsg(m_Name, lvl, format("Stack trace requested: {}", msg)), src);
-        SinkIt(LogMsg(m_Name, lvl, format("Called from: {}", PluginSysFindPluginByCtx(ctx)->GetFilename())), src);
-
-        std::vector<std::string> messages = SrcHelper::GetStackTrace(ctx);
-        for (auto &iter : messages)
-        {
-            SinkIt(LogMsg(m_Name, lvl, iter), src);
-        }
+        SinkStackTrace(ctx, lvl, "Stack trace requested", msg.View(), "Called from", src);
     }
 }
 
@@ -97,25 +213,30 @@ void Logger::LogStackTraceAmxTpl(IPluginContext *ctx, LevelEnum lvl, const cell_
 {
     assert(ctx && params);
 
-    if (ShouldLog(lvl))
+    if (ShouldSink(lvl))
     {
         SrcHelper source(ctx);
-        char msg[2048];
-        DetectExceptions eh(ctx);
+        if (!Admit(lvl, source))
+            return;
 
-        smutils->FormatString(msg, sizeof(msg), ctx, params, param);
-        if (eh.HasException())
+        FormatBuffer msg;
+
+        if (!FormatAmxTpl(msg, ctx, params, param))
             return;
 
-        using spdlog::fmt_lib::format;
-        SinkIt(LogMsg(m_Name, lvl, format("Stack trace requested: {}", msg)), source);
-        SinkIt(LogMsg(m_Name, lvl, format("Called from: {}", PluginSysFindPluginByCtx(ctx)->GetFilename())), source);
+        SinkStackTrace(ctx, lvl, "Stack trace requested", msg.View(), "Called from", source);
+    }
+}
 
-        std::vector<std::string> messages = SrcHelper::GetStackTrace(ctx);
-        for (auto &iter : messages)
-        {
-            SinkIt(LogMsg(m_Name, lvl, iter), source);
-        }
+void Logger::LogReportedError(IPluginContext *ctx, LevelEnum lvl, string_view_t msg) const noexcept
+{
+    assert(ctx);
+
+    if (ShouldSink(lvl))
+    {
+        SrcHelper source(ctx);
+        if (Admit(lvl, source))
+            SinkStackTrace(ctx, lvl, "Exception reported", msg, "Blaming", source);
     }
 }
 
@@ -124,10 +245,11 @@ void Logger::ThrowError(IPluginContext *ctx, LevelEnum lvl, const cell_t *params
     assert(ctx && params);
 
     SrcHelper source(ctx);
-    std::string msg;
+    FormatBuffer msg;
     try
     {
-        msg = FormatToString(ctx, params, param);
+        FormatToBuffer(msg.Get(), ctx, params, param);
+        msg.Get().push_back('\0');
     }
     catch (const std::exception &ex)
     {
@@ -142,49 +264,168 @@ void Logger::ThrowError(IPluginContext *ctx, LevelEnum lvl, const cell_t *params
         return;
     }
 
-    ctx->ReportError(msg.c_str());
-
-    if (ShouldLog(lvl))
-    {
-        using spdlog::fmt_lib::format;
-        SinkIt(LogMsg(m_Name, lvl, format("Exception reported: {}", msg)), source);
-        SinkIt(LogMsg(m_Name, lvl, format("Blaming: {}", PluginSysFindPluginByCtx(ctx)->GetFilename())), source);
+    ctx->ReportError(msg.Get().data());
 
-        std::vector<std::string> messages = SrcHelper::GetStackTrace(ctx);
-        for (auto &iter : messages)
-        {
-            SinkIt(LogMsg(m_Name, lvl, iter), source);
-        }
-    }
+    if (ShouldSink(lvl) && Admit(lvl, source))
+        SinkStackTrace(ctx, lvl, "Exception reported", string_view_t(msg.Get().data(), msg.Get().size() - 1), "Blaming", source);
 }
 
 void Logger::ThrowErrorAmxTpl(IPluginContext *ctx, LevelEnum lvl, const cell_t *params, unsigned int param) const noexcept
 {
     assert(ctx && params);
 
-    char msg[2048];
-    DetectExceptions eh(ctx);
+    FormatBuffer msg;
 
-    smutils->FormatString(msg, sizeof(msg), ctx, params, param);
-    if (eh.HasException())
+    if (!FormatAmxTpl(msg, ctx, params, param))
         return;
 
-    ctx->ReportError(msg);
+    msg.Get().push_back('\0');
+    ctx->ReportError(msg.Get().data());
 
-    if (ShouldLog(lvl))
+    if (ShouldSink(lvl))
     {
         SrcHelper source(ctx);
+        if (!Admit(lvl, source))
+            return;
 
-        using spdlog::fmt_lib::format;
-        SinkIt(LogMsg(m_Name, lvl, format("Exception reported: {}", msg)), source);
-        SinkIt(LogMsg(m_Name, lvl, format("Blaming: {}", PluginSysFindPluginByCtx(ctx)->GetFilename())), source);
+        SinkStackTrace(ctx, lvl, "Exception reported", string_view_t(msg.Get().data(), msg.Get().size() - 1), "Blaming", source);
+    }
+}
+
+void Logger::SinkStackTrace(IPluginContext *ctx, LevelEnum lvl, const char *title, string_view_t msg,
+                            const char *blame, const SrcHelper &source) const noexcept
+{
+    // "title: msg" 与 "blame: 插件" 各为一条消息 (msg 可能包含换行，不能拆分)
+    // 生成的调用栈渲染到同一个缓冲区，每行一条消息
+    FormatBuffer header;
+    FormatBuffer trace;
+    FormatBuffer frames;
+    std::size_t titleSize;
+
+    try
+    {
+        using spdlog::fmt_lib::format_to;
+        format_to(std::back_inserter(header.Get()), "{}: {}", title, msg);
+        titleSize = header.Get().size();
+        format_to(std::back_inserter(header.Get()), "{}: {}", blame, PluginSysFindPluginByCtx(ctx)->GetFilename());
 
-        std::vector<std::string> messages = SrcHelper::GetStackTrace(ctx);
-        for (auto &iter : messages)
+        auto it = std::back_inserter(trace.Get());
+        if (SrcHelper::RenderStackTrace(ctx, frames.Get()) != 0)
         {
-            SinkIt(LogMsg(m_Name, lvl, iter), source);
+            if (!m_TraceDedup)
+            {
+                format_to(it, "Call stack trace:\n");
+                trace.Get().append(frames.Get().begin(), frames.Get().end());
+            }
+            else if (auto result = m_TraceDedup->Check(std::string_view(frames.Get().data(), frames.Get().size()), TraceDedup::Clock::now()); result.full)
+            {
+                format_to(it, "Call stack trace #{:08x}:\n", result.id);
+                trace.Get().append(frames.Get().begin(), frames.Get().end());
+            }
+            else
+            {
+                format_to(it, "stack trace #{:08x} (seen {} times)\n", result.id, result.seen);
+            }
         }
     }
+    catch (const std::exception &ex)
+    {
+        m_ErrHelper.HandleEx(m_Name, source, ex);
+        return;
+    }
+    catch (...)
+    {
+        m_ErrHelper.HandleUnknownEx(m_Name, source);
+        return;
+    }
+
+    if (lvl >= m_BacktraceDumpLevel && !m_Backtrace.empty())
+        DumpBacktrace(source);
+
+    // 所有消息共用同一个时间点，作为一批写入 sinks，只在最后刷新一次
+    bool flush = ShouldFlushNow(lvl);
+    auto time = spdlog::details::os::now();
+
+    auto headerView = header.View();
+    WriteToSinks(LogMsg(time, SourceLoc{}, m_Name, lvl, string_view_t(headerView.data(), titleSize)), source, false);
+    WriteToSinks(LogMsg(time, SourceLoc{}, m_Name, lvl, string_view_t(headerView.data() + titleSize, headerView.size() - titleSize)), source, flush && trace.Get().size() == 0);
+    SinkLines(time, lvl, trace.View(), source, flush);
+}
+
+void Logger::SetLevel(LevelEnum level) noexcept
+{
+    m_HasLevel = true;
+    m_Level.store(level);
+    LoggerHandler::Instance().UpdateChildLevels(m_Name);
+}
+
+void Logger::ResetLevel() noexcept
+{
+    m_HasLevel = false;
+    InheritLevel(LoggerHandler::Instance().ParentLevel(m_Name));
+    LoggerHandler::Instance().UpdateChildLevels(m_Name);
+}
+
+void Logger::EnableBacktrace(std::size_t n, LevelEnum dumpLevel)
+{
+    assert(n <= MaxBacktraceSize);
+    m_Backtrace = spdlog::details::circular_q<spdlog::details::log_msg_buffer>(n);
+    m_BacktraceSize = n;
+    m_BacktraceDumpLevel = dumpLevel;
+}
+
+void Logger::DisableBacktrace() noexcept
+{
+    m_Backtrace = spdlog::details::circular_q<spdlog::details::log_msg_buffer>();
+    m_BacktraceSize = 0;
+    m_BacktraceDumpLevel = LevelEnum::off;
+}
+
+void Logger::PushBacktrace(const LogMsg &msg) const noexcept
+{
+    try
+    {
+        m_Backtrace.push_back(spdlog::details::log_msg_buffer(msg));
+    }
+    catch (...)
+    {
+        // 保存失败只会丢失这条调试消息
+    }
+}
+
+void Logger::DumpBacktrace(const SrcHelper &source) const noexcept
+{
+    if (m_Backtrace.empty())
+        return;
+
+    // 先取出所有消息，写入 sinks 时可能再次触发 dump
+    auto messages = std::move(m_Backtrace);
+    try
+    {
+        m_Backtrace = spdlog::details::circular_q<spdlog::details::log_msg_buffer>(m_BacktraceSize);
+    }
+    catch (...)
+    {
+        // 无法分配新的缓冲区，之后的消息不再保存
+        m_Backtrace = spdlog::details::circular_q<spdlog::details::log_msg_buffer>();
+    }
+
+    SinkIt(LogMsg(m_Name, LevelEnum::info, "****************** Backtrace Start ******************"), source);
+    for (std::size_t i = 0; i < messages.size(); ++i)
+    {
+        SinkIt(messages.at(i), source);
+    }
+    SinkIt(LogMsg(m_Name, LevelEnum::info, "****************** Backtrace End ********************"), source);
+}
+
+void Logger::SetTraceDedup(std::chrono::milliseconds window, std::size_t maxTraces)
+{
+    if (window <= std::chrono::milliseconds::zero())
+    {
+        m_TraceDedup.reset();
+        return;
+    }
+    m_TraceDedup = std::make_unique<TraceDedup>(window, maxTraces);
 }
 
 void Logger::SetPattern(std::string pattern, PatternTimeType type) noexcept
@@ -195,55 +436,322 @@ void Logger::SetPattern(std::string pattern, PatternTimeType type) noexcept
 
 void Logger::SetPatternFormatter(std::unique_ptr<Formatter> fmt) noexcept
 {
-    for (auto it = m_Sinks.begin(); it != m_Sinks.end(); ++it)
     {
-        if (std::next(it) == m_Sinks.end())
+        std::lock_guard<std::mutex> lock(m_SinksMutex);
+        for (auto it = m_Sinks.begin(); it != m_Sinks.end(); ++it)
         {
-            // last element - we can move it.
-            (*it)->set_formatter(std::move(fmt));
-            break;  // to prevent clang-tidy warning
+            if (std::next(it) == m_Sinks.end())
+            {
+                // last element - we can move it.
+                (*it)->set_formatter(std::move(fmt));
+                break;  // to prevent clang-tidy warning
+            }
+            (*it)->set_formatter(fmt->clone());
         }
-        (*it)->set_formatter(fmt->clone());
     }
+    UpdateSinkGroups();
 }
 
 void Logger::AddSink(SinkPtr sink) noexcept
 {
-    m_Sinks.push_back(sink);
+    {
+        std::lock_guard<std::mutex> lock(m_SinksMutex);
+        m_Sinks.push_back(sink);
+    }
+    UpdateSinkLevel();
+    UpdateSinkGroups();
 }
 
 void Logger::DropSink(SinkPtr sink) noexcept
 {
-    m_Sinks.erase(std::remove(m_Sinks.begin(), m_Sinks.end(), sink), m_Sinks.end());
+    {
+        std::lock_guard<std::mutex> lock(m_SinksMutex);
+        m_Sinks.erase(std::remove(m_Sinks.begin(), m_Sinks.end(), sink), m_Sinks.end());
+    }
+    UpdateSinkLevel();
+    UpdateSinkGroups();
 }
 
-void Logger::SinkIt(const LogMsg &msg, const SrcHelper &source) const noexcept
+void Logger::UpdateSinkLevel() noexcept
 {
+    std::lock_guard<std::mutex> lock(m_SinksMutex);
+
+    auto lvl = LevelEnum::off;
+    auto textLvl = LevelEnum::off;
+    m_DeferredSinks.clear();
     for (auto &sink : m_Sinks)
     {
-        if (sink->should_log(msg.level))
+        lvl = std::min(lvl, sink->level());
+
+        if (auto deferred = AsDeferredSink(sink.get()))
+            m_DeferredSinks.push_back(deferred);
+        else
+            textLvl = std::min(textLvl, sink->level());
+    }
+    m_SinkLevel.store(lvl);
+    m_TextSinkLevel.store(textLvl);
+}
+
+Sinks::BinaryFileSinkST *Logger::AsDeferredSink(spdlog::sinks::sink *sink) const noexcept
+{
+    // 异步 Logger 的消息在工作线程写入，插件的参数已经失效，只能写入格式化后的消息
+    return m_ThreadPool ? nullptr : dynamic_cast<Sinks::BinaryFileSinkST *>(sink);
+}
+
+void Logger::UpdateSinkGroups() noexcept
+{
+    using spdlog::pattern_formatter;
+
+    std::lock_guard<std::mutex> lock(m_SinksMutex);
+
+    try
+    {
+        std::vector<SinkGroup> groups;
+        for (auto &sink : m_Sinks)
         {
-            try
+            if (!sink->accepts_formatted())
             {
-                sink->log(msg);
+                groups.push_back(SinkGroup{nullptr, {sink.get()}, AsDeferredSink(sink.get()) != nullptr});
+                continue;
             }
-            catch (const std::exception &ex)
+
+            auto formatter = sink->clone_formatter();
+            auto pattern = dynamic_cast<pattern_formatter *>(formatter.get());
+
+            auto found = std::find_if(groups.begin(), groups.end(), [pattern](const SinkGroup &group) {
+                auto other = dynamic_cast<pattern_formatter *>(group.formatter.get());
+                return pattern && other && pattern->same_pattern(*other);
+            });
+
+            if (found != groups.end())
+                found->sinks.push_back(sink.get());
+            else
+                groups.push_back(SinkGroup{std::move(formatter), {sink.get()}});
+        }
+
+        m_SinkGroups = std::move(groups);
+        m_SinkGroupsValid = true;
+    }
+    catch (...)
+    {
+        m_SinkGroups.clear();
+        m_SinkGroupsValid = false;
+    }
+}
+
+template <typename ErrorHandler>
+void Logger::LogToSinks(const LogMsg &msg, bool skipDeferred, ErrorHandler &&onError) const noexcept
+{
+    auto sinkIt = [&onError](auto &&fn) {
+        try
+        {
+            fn();
+        }
+        catch (const std::exception &ex)
+        {
+            onError(&ex);
+        }
+        catch (...)
+        {
+            onError(nullptr);
+        }
+    };
+
+    if (!m_SinkGroupsValid)
+    {
+        for (auto &sink : m_Sinks)
+        {
+            if (skipDeferred && AsDeferredSink(sink.get()))
+                continue;
+
+            if (sink->should_log(msg.level))
+                sinkIt([&]() { sink->log(msg); });
+        }
+        return;
+    }
+
+    for (auto &group : m_SinkGroups)
+    {
+        if (skipDeferred && group.deferred)
+            continue;
+
+        if (!group.formatter)
+        {
+            auto sink = group.sinks.front();
+            if (sink->should_log(msg.level))
+                sinkIt([&]() { sink->log(msg); });
+            continue;
+        }
+
+        auto accepted = std::any_of(group.sinks.begin(), group.sinks.end(), [&msg](auto sink) {
+            return sink->should_log(msg.level);
+        });
+        if (!accepted)
+            continue;
+
+        // 组内的 sinks 共享同一次格式化结果
+        FormatBuffer formatted;
+        bool ok = false;
+        sinkIt([&]() { group.formatter->format(msg, formatted.Get()); ok = true; });
+        if (!ok)
+            continue;
+
+        for (auto sink : group.sinks)
+        {
+            if (sink->should_log(msg.level))
+                sinkIt([&]() { sink->log_formatted(msg, formatted.Get()); });
+        }
+    }
+}
+
+bool Logger::AdmitLimited(LevelEnum lvl, const SrcHelper &source) const noexcept
+{
+    auto now = RateLimiter::Clock::now();
+    if (!m_RateLimiter.Allow(now))
+    {
+        // 之后没有消息通过时，由 FlushScheduler 在之后的帧报告
+        if (!m_SummaryScheduled)
+        {
+            try
             {
-                m_ErrHelper.HandleEx(m_Name, source, ex);
+                FlushScheduler::Instance().ScheduleSummary(this);
+                m_SummaryScheduled = true;
             }
             catch (...)
             {
-                m_ErrHelper.HandleUnknownEx(m_Name, source);
+                // 只能等到下一条通过的消息之前再报告
             }
         }
+        return false;
     }
 
-    if (ShouldFlush(msg.level))
+    // 在通过的消息之前报告被丢弃的数量
+    SinkSuppressed(now, source);
+    return true;
+}
+
+void Logger::SinkSuppressed(RateLimiter::Clock::time_point now, const SrcHelper &source) const noexcept
+{
+    if (auto suppressed = m_RateLimiter.TakeSuppressed(now))
+    {
+        try
+        {
+            using spdlog::fmt_lib::format;
+            SinkIt(LogMsg(m_Name, LevelEnum::warn, format("{} messages suppressed", suppressed)), source);
+        }
+        catch (...)
+        {
+            // 报告失败不影响当前消息
+        }
+    }
+}
+
+void Logger::SinkIt(const LogMsg &msg, const SrcHelper &source, bool skipDeferred) const noexcept
+{
+    // 达到 dump level 的消息之前写入 backtrace，作为它的上下文
+    if (msg.level >= m_BacktraceDumpLevel && !m_Backtrace.empty())
+        DumpBacktrace(source);
+
+    WriteToSinks(msg, source, ShouldFlushNow(msg.level), skipDeferred);
+}
+
+bool Logger::SinkDeferred(const LogMsg &msg, std::string_view format, std::string_view args, const SrcHelper &source) const noexcept
+{
+    if (msg.level >= m_BacktraceDumpLevel && !m_Backtrace.empty())
+        DumpBacktrace(source);
+
+    for (auto sink : m_DeferredSinks)
+    {
+        if (!sink->should_log(msg.level))
+            continue;
+
+        try
+        {
+            sink->LogDeferred(msg, format, args);
+        }
+        catch (const std::exception &ex)
+        {
+            m_ErrHelper.HandleEx(m_Name, source, ex);
+        }
+        catch (...)
+        {
+            m_ErrHelper.HandleUnknownEx(m_Name, source);
+        }
+    }
+
+    // 其他 sinks 也需要这条消息时，由之后的 SinkIt 负责刷新
+    if (msg.level >= m_TextSinkLevel.load(std::memory_order_relaxed))
+        return true;
+
+    if (ShouldFlushNow(msg.level))
+        Flush(source);
+    return false;
+}
+
+void Logger::SinkLines(spdlog::log_clock::time_point time, LevelEnum lvl, string_view_t lines, const SrcHelper &source, bool flush) const noexcept
+{
+    std::string_view rest(lines.data(), lines.size());
+    while (!rest.empty())
+    {
+        auto pos = rest.find('\n');
+        auto line = rest.substr(0, pos);
+        rest = (pos == std::string_view::npos) ? std::string_view{} : rest.substr(pos + 1);
+
+        LogMsg msg(time, SourceLoc{}, m_Name, lvl, string_view_t(line.data(), line.size()));
+        WriteToSinks(msg, source, flush && rest.empty());
+    }
+}
+
+void Logger::WriteToSinks(const LogMsg &msg, const SrcHelper &source, bool flush, bool skipDeferred) const noexcept
+{
+    if (m_ThreadPool)
+    {
+        try
+        {
+            m_ThreadPool->PostLog(msg, flush);
+        }
+        catch (const std::exception &ex)
+        {
+            m_ErrHelper.HandleEx(m_Name, source, ex);
+        }
+        catch (...)
+        {
+            m_ErrHelper.HandleUnknownEx(m_Name, source);
+        }
+        return;
+    }
+
+    CallerScope caller(source.GetCtx());
+    LogToSinks(msg, skipDeferred, [this, &source](const std::exception *ex) {
+        if (ex)
+            m_ErrHelper.HandleEx(m_Name, source, *ex);
+        else
+            m_ErrHelper.HandleUnknownEx(m_Name, source);
+    });
+
+    if (flush)
         Flush(source);
 }
 
 void Logger::Flush(const SrcHelper &source) const noexcept
 {
+    if (m_ThreadPool)
+    {
+        try
+        {
+            m_ThreadPool->PostFlush();
+        }
+        catch (const std::exception &ex)
+        {
+            m_ErrHelper.HandleEx(m_Name, source, ex);
+        }
+        catch (...)
+        {
+            m_ErrHelper.HandleUnknownEx(m_Name, source);
+        }
+        return;
+    }
+
     for (auto &sink : m_Sinks)
     {
         try
@@ -261,5 +769,111 @@ void Logger::Flush(const SrcHelper &source) const noexcept
     }
 }
 
+void Logger::BackendSinkIt(const LogMsg &msg) const noexcept
+{
+    std::lock_guard<std::mutex> lock(m_SinksMutex);
+    LogToSinks(msg, false, [this, &msg](const std::exception *ex) {
+        PostBackendError(ex ? ex->what() : "unknown exception", msg.source);
+    });
+}
+
+void Logger::BackendFlush() const noexcept
+{
+    std::lock_guard<std::mutex> lock(m_SinksMutex);
+    for (auto &sink : m_Sinks)
+    {
+        try
+        {
+            sink->flush();
+        }
+        catch (const std::exception &ex)
+        {
+            PostBackendError(ex.what(), SourceLoc{});
+        }
+        catch (...)
+        {
+            PostBackendError("unknown exception", SourceLoc{});
+        }
+    }
+}
+
+void Logger::PostBackendError(const char *what, const SourceLoc &loc) const noexcept
+{
+    try
+    {
+        std::string file = loc.filename ? loc.filename : "";
+        std::string func = loc.funcname ? loc.funcname : "";
+
+        FrameTaskQueue::Instance().Post(
+            [name = m_Name, what = std::string(what), file = std::move(file), line = loc.line, func = std::move(func)]()
+            {
+                // 任务执行时 logger 可能已经被释放
+                auto logger = LoggerHandler::Instance().FindLogger(name);
+                if (!logger)
+                {
+                    smutils->LogError(myself, "[%s] %s", name.c_str(), what.c_str());
+                    return;
+                }
+
+                SourceLoc src = file.empty() ? SourceLoc(__FILE__, __LINE__, __FUNCTION__) : SourceLoc(file.c_str(), line, func.c_str());
+                logger->m_ErrHelper.HandleEx(name, SrcHelper(src), std::runtime_error(what));
+            }
+        );
+    }
+    catch (...)
+    {
+        // 无法交给主线程处理，只能丢弃
+    }
+}
+
+bool Logger::ShouldFlushNow(LevelEnum lvl) const noexcept
+{
+    if (!ShouldFlush(lvl))
+        return false;
+
+    if (m_FlushPolicy == FlushPolicy::Immediate)
+        return true;
+
+    if (!m_FlushScheduled)
+    {
+        try
+        {
+            FlushScheduler::Instance().Schedule(this);
+            m_FlushScheduled = true;
+        }
+        catch (...)
+        {
+            // 无法延迟时退回立即刷新
+            return true;
+        }
+    }
+    return false;
+}
+
+bool Logger::ScheduledFlushDue(FlushScheduler::Clock::time_point now) const noexcept
+{
+    if (m_FlushPolicy != FlushPolicy::Interval)
+        return true;
+    return now - m_LastScheduledFlush >= m_FlushInterval;
+}
+
+void Logger::ScheduledFlush(FlushScheduler::Clock::time_point now) const noexcept
+{
+    m_FlushScheduled = false;
+    m_LastScheduledFlush = now;
+    Flush(SrcHelper(SourceLoc(__FILE__, __LINE__, __FUNCTION__)));
+}
+
+bool Logger::ScheduledSummaryDue(FlushScheduler::Clock::time_point now) const noexcept
+{
+    return m_RateLimiter.SummaryDue(now);
+}
+
+void Logger::ScheduledSummary(FlushScheduler::Clock::time_point now) const noexcept
+{
+    m_SummaryScheduled = false;
+    SinkSuppressed(now, SrcHelper(SourceLoc(__FILE__, __LINE__, __FUNCTION__)));
+}
+
 
 }       // namespace Log4sp
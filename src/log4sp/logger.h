@@ -1,11 +1,23 @@
 #pragma once
 
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <vector>
+
+#include "spdlog/details/circular_q.h"
+#include "spdlog/details/log_msg_buffer.h"
 #include "spdlog/sinks/sink.h"
 
 #include "extension.h"
 
 #include "log4sp/common.h"
+#include "log4sp/flush_scheduler.h"
+#include "log4sp/rate_limiter.h"
 #include "log4sp/source_helper.h"
+#include "log4sp/thread_pool.h"
+#include "log4sp/trace_dedup.h"
+#include "log4sp/sinks/binary_file_sink.h"
 
 
 namespace Log4sp {
@@ -27,12 +39,24 @@ public:
     using string_view_t     = spdlog::string_view_t;
     using IPluginContext    = SourcePawn::IPluginContext;
 
+    // 异步 Logger 的选项
+    struct AsyncOptions
+    {
+        std::size_t queueSize{ThreadPool::DefaultQueueSize};
+        OverflowPolicy policy{OverflowPolicy::Block};
+    };
+
     explicit Logger(std::string name) noexcept
         : m_Name(std::move(name)) {}
 
+    // 创建异步 Logger，消息由专属的工作线程写入 sinks
+    // 创建线程失败时抛出异常
+    Logger(std::string name, const AsyncOptions &options)
+        : m_Name(std::move(name)), m_ThreadPool(std::make_unique<ThreadPool>(*this, options.queueSize, options.policy)) {}
+
     template <typename It>
     Logger(std::string name, It begin, It end)
-        : m_Name(std::move(name)), m_Sinks(begin, end) {}
+        : m_Name(std::move(name)), m_Sinks(begin, end) { UpdateSinkLevel(); UpdateSinkGroups(); }
 
     Logger(std::string name, SinkPtr single_sink)
         : Logger(std::move(name), {std::move(single_sink)}) {}
@@ -40,37 +64,90 @@ public:
     Logger(std::string name, SinksInitList sinks)
         : Logger(std::move(name), sinks.begin(), sinks.end()) {}
 
-    ~Logger() = default;
+    ~Logger() noexcept {
+        if (m_FlushScheduled || m_SummaryScheduled)
+            FlushScheduler::Instance().Cancel(this);
+    }
 
     // Log with no format string, just string message
     void Log(IPluginContext *ctx, LevelEnum lvl, string_view_t msg) const noexcept {
         assert(ctx);
-        if (ShouldLog(lvl))
-            SinkIt(LogMsg(m_Name, lvl, msg), SrcHelper(ctx));
+        if (ShouldSink(lvl))
+        {
+            SrcHelper source(ctx);
+            if (Admit(lvl, source))
+                SinkIt(LogMsg(m_Name, lvl, msg), source);
+        }
+        else if (ShouldBacktrace(lvl))
+        {
+            PushBacktrace(LogMsg(m_Name, lvl, msg));
+        }
     }
 
     void Log(const SourceLoc &loc, LevelEnum lvl, string_view_t msg) const noexcept {
         assert(!loc.empty());
-        if (ShouldLog(lvl))
-            SinkIt(LogMsg(loc, m_Name, lvl, msg), SrcHelper(loc));
+        if (ShouldSink(lvl))
+        {
+            SrcHelper source(loc);
+            if (Admit(lvl, source))
+                SinkIt(LogMsg(loc, m_Name, lvl, msg), source);
+        }
+        else if (ShouldBacktrace(lvl))
+        {
+            PushBacktrace(LogMsg(loc, m_Name, lvl, msg));
+        }
     }
 
     // Log with log4sp format
     void Log(IPluginContext *ctx, LevelEnum lvl, const cell_t *params, unsigned int param) const noexcept {
-        Log(ctx, SourceLoc{}, lvl, params, param);
+        SourceLoc loc;
+        LogFormat(ctx, &loc, lvl, params, param);
+    }
+    void Log(IPluginContext *ctx, const SourceLoc &loc, LevelEnum lvl, const cell_t *params, unsigned int param) const noexcept {
+        LogFormat(ctx, &loc, lvl, params, param);
     }
-    void Log(IPluginContext *ctx, const SourceLoc &loc, LevelEnum lvl, const cell_t *params, unsigned int param) const noexcept;
 
-    // Log with sourcemod format
+    // Log with sourcemod format (AMX template), formatted by log4sp but errors are reported to the plugin
     void LogAmxTpl(IPluginContext *ctx, LevelEnum lvl, const cell_t *params, unsigned int param) const noexcept {
-        LogAmxTpl(ctx, SourceLoc{}, lvl, params, param);
+        SourceLoc loc;
+        LogFormatAmxTpl(ctx, &loc, lvl, params, param);
+    }
+    void LogAmxTpl(IPluginContext *ctx, const SourceLoc &loc, LevelEnum lvl, const cell_t *params, unsigned int param) const noexcept {
+        LogFormatAmxTpl(ctx, &loc, lvl, params, param);
+    }
+
+    // Log with the source location of the calling plugin
+    // 获取源码位置需要遍历调用栈，所以只在通过限流之后获取
+    void LogSrc(IPluginContext *ctx, LevelEnum lvl, string_view_t msg) const noexcept {
+        assert(ctx);
+        if (ShouldSink(lvl))
+        {
+            if (Admit(lvl, SrcHelper(ctx)))
+            {
+                auto loc = SrcHelper::GetFromPluginCtx(ctx);
+                SinkIt(LogMsg(loc, m_Name, lvl, msg), SrcHelper(loc, ctx));
+            }
+        }
+        else if (ShouldBacktrace(lvl))
+        {
+            PushBacktrace(LogMsg(SrcHelper::GetFromPluginCtx(ctx), m_Name, lvl, msg));
+        }
+    }
+    void LogSrc(IPluginContext *ctx, LevelEnum lvl, const cell_t *params, unsigned int param) const noexcept {
+        LogFormat(ctx, nullptr, lvl, params, param);
+    }
+    void LogSrcAmxTpl(IPluginContext *ctx, LevelEnum lvl, const cell_t *params, unsigned int param) const noexcept {
+        LogFormatAmxTpl(ctx, nullptr, lvl, params, param);
     }
-    void LogAmxTpl(IPluginContext *ctx, const SourceLoc &loc, LevelEnum lvl, const cell_t *params, unsigned int param) const noexcept;
 
     // special log
+    // 消息、插件与调用栈的每一行各为一条消息，作为一批写入 sinks
+    void LogStackTrace(IPluginContext *ctx, LevelEnum lvl, string_view_t msg) const noexcept;
     void LogStackTrace(IPluginContext *ctx, LevelEnum lvl, const cell_t *params, unsigned int param) const noexcept;
     void LogStackTraceAmxTpl(IPluginContext *ctx, LevelEnum lvl, const cell_t *params, unsigned int param) const noexcept;
 
+    // 只记录已经报告给插件的错误，调用者负责 ReportError
+    void LogReportedError(IPluginContext *ctx, LevelEnum lvl, string_view_t msg) const noexcept;
     void ThrowError(IPluginContext *ctx, LevelEnum lvl, const cell_t *params, unsigned int param) const noexcept;
     void ThrowErrorAmxTpl(IPluginContext *ctx, LevelEnum lvl, const cell_t *params, unsigned int param) const noexcept;
 
@@ -80,6 +157,19 @@ public:
         return msgLevel >= m_Level.load(std::memory_order_relaxed);
     }
 
+    // return true if the logger and at least one of its sinks accept the given level.
+    [[nodiscard]]
+    bool ShouldSink(LevelEnum msgLevel) const noexcept {
+        return ShouldLog(msgLevel) && msgLevel >= m_SinkLevel.load(std::memory_order_relaxed);
+    }
+
+    // return true if the message would be written to the sinks or stored in the backtrace.
+    // 没有 sink 会接收消息且未启用 backtrace 时，可以跳过参数读取与格式化
+    [[nodiscard]]
+    bool ShouldFormat(LevelEnum msgLevel) const noexcept {
+        return ShouldSink(msgLevel) || ShouldBacktrace(msgLevel);
+    }
+
     // return the active log level
     [[nodiscard]]
     LevelEnum GetLevel() const noexcept {
@@ -87,8 +177,16 @@ public:
     }
 
     // set the level of logging
-    void SetLevel(LevelEnum level) noexcept {
-        m_Level.store(level);
+    // 子 logger (名称以 "name." 开头) 中继承日志级别的 logger 会同步更新
+    void SetLevel(LevelEnum level) noexcept;
+
+    // 取消显式设置的日志级别，重新继承父 logger 的日志级别
+    void ResetLevel() noexcept;
+
+    // return true if the level was set explicitly rather than inherited from the parent logger
+    [[nodiscard]]
+    bool HasLevel() const noexcept {
+        return m_HasLevel;
     }
 
     // return the name of the logger
@@ -126,27 +224,215 @@ public:
         m_FlushLevel.store(lvl);
     }
 
+    // 达到 flush level 的消息何时刷新
+    [[nodiscard]]
+    FlushPolicy GetFlushPolicy() const noexcept {
+        return m_FlushPolicy;
+    }
+
+    // FlushPolicy::Interval 的最小刷新间隔
+    [[nodiscard]]
+    std::chrono::milliseconds GetFlushInterval() const noexcept {
+        return m_FlushInterval;
+    }
+
+    void SetFlushPolicy(FlushPolicy policy, std::chrono::milliseconds interval = std::chrono::milliseconds::zero()) noexcept {
+        m_FlushPolicy   = policy;
+        m_FlushInterval = interval;
+    }
+
     // sinks
     [[nodiscard]] const std::vector<SinkPtr> &Sinks() const noexcept { return m_Sinks; }
     [[nodiscard]] std::vector<SinkPtr> &sinks() noexcept             { return m_Sinks; }
     void AddSink(SinkPtr sink) noexcept;
     void DropSink(SinkPtr sink) noexcept;
 
+    // 重新计算 sinks 的最低日志级别 (ShouldFormat 使用)
+    // AddSink 与 DropSink 会自动调用，sink 的日志级别改变后需要调用
+    void UpdateSinkLevel() noexcept;
+
+    // 重新按 pattern 将 sinks 分组 (共享格式化使用)
+    // AddSink、DropSink 与 SetPattern 会自动调用，sink 的 pattern 改变后需要调用
+    void UpdateSinkGroups() noexcept;
+
+    // backtrace 最多保存的消息数量，所有缓冲区在启用时一次性分配 (每条数百字节)
+    static constexpr std::size_t MaxBacktraceSize = 16 * 1024;
+
+    // backtrace: 保存最近 n 条没有写入 sinks 的消息 (例如低于日志级别的 trace / debug)
+    // 保存的消息只格式化 payload，不经过 sinks 的格式化，直到 DumpBacktrace 或达到 dumpLevel 的消息将它们写入 sinks
+    // n 不能超过 MaxBacktraceSize
+    void EnableBacktrace(std::size_t n, LevelEnum dumpLevel = LevelEnum::err);
+    void DisableBacktrace() noexcept;
+
+    [[nodiscard]]
+    bool IsBacktraceEnabled() const noexcept {
+        return m_BacktraceSize != 0;
+    }
+
+    // 将保存的消息写入 sinks，然后清空
+    void DumpBacktrace(IPluginContext *ctx) const noexcept    { assert(ctx);          DumpBacktrace(SrcHelper(ctx)); }
+    void DumpBacktrace(const SourceLoc &loc) const noexcept   { assert(!loc.empty()); DumpBacktrace(SrcHelper(loc)); }
+
+    // stack trace deduplication: 同一个调用路径在 window 内只输出一次完整的调用栈，之后只输出 "stack trace #id (seen N times)"
+    // window <= 0 时关闭，maxTraces 为最多记录的调用路径数量
+    // 修改设置会清空已记录的调用路径
+    void SetTraceDedup(std::chrono::milliseconds window, std::size_t maxTraces);
+
+    [[nodiscard]]
+    const TraceDedup *GetTraceDedup() const noexcept {
+        return m_TraceDedup.get();
+    }
+
+    // rate limiting: allow at most `rate` messages per second with bursts of up to `burst` messages
+    // rate == 0 disables rate limiting, burst == 0 means the same as rate
+    void SetRateLimit(std::uint32_t rate, std::uint32_t burst = 0) noexcept {
+        m_RateLimiter.SetRate(rate, burst);
+    }
+
+    // sampling: keep 1 in every `sample` messages, 0 or 1 disables sampling
+    void SetSampleRate(std::uint32_t sample) noexcept {
+        m_RateLimiter.SetSample(sample);
+    }
+
+    [[nodiscard]]
+    const RateLimiter &GetRateLimiter() const noexcept {
+        return m_RateLimiter;
+    }
+
     // error handler
     void SetErrorHandler(SourceMod::IChangeableForward *handler) noexcept {
         m_ErrHelper.SetErrHandler(handler);
     }
 
+    // return true if the sinks are written by a worker thread
+    [[nodiscard]]
+    bool IsAsync() const noexcept {
+        return m_ThreadPool != nullptr;
+    }
+
+    // 异步 Logger 队列已满时的处理策略，同步 Logger 总是返回 Block
+    [[nodiscard]]
+    OverflowPolicy GetOverflowPolicy() const noexcept {
+        return m_ThreadPool ? m_ThreadPool->GetOverflowPolicy() : OverflowPolicy::Block;
+    }
+
+    // 异步 Logger 队列的统计数据，同步 Logger 总是返回 0
+    [[nodiscard]]
+    QueueStats GetQueueStats() const noexcept {
+        return m_ThreadPool ? m_ThreadPool->GetStats() : QueueStats{};
+    }
+
 private:
+    friend class ThreadPool;
+    friend class FlushScheduler;
+    friend class LoggerHandler;
+
+    // LoggerHandler 调用，没有显式设置日志级别时使用父 logger 的日志级别
+    void InheritLevel(LevelEnum parentLevel) noexcept {
+        if (!m_HasLevel)
+            m_Level.store(parentLevel);
+    }
+
+    [[nodiscard]]
+    bool ShouldBacktrace(LevelEnum msgLevel) const noexcept {
+        return m_BacktraceSize != 0 && msgLevel != LevelEnum::off;
+    }
+
+    void PushBacktrace(const LogMsg &msg) const noexcept;
+    void DumpBacktrace(const SrcHelper &source) const noexcept;
+
+    // 限流与采样，在 ShouldSink 之后、格式化之前调用
+    // 返回 false 表示消息被丢弃
+    [[nodiscard]]
+    bool Admit(LevelEnum lvl, const SrcHelper &source) const noexcept {
+        return !m_RateLimiter.Enabled() || AdmitLimited(lvl, source);
+    }
+    [[nodiscard]] bool AdmitLimited(LevelEnum lvl, const SrcHelper &source) const noexcept;
+
+    // 报告限流丢弃的数量，没有需要报告的数量时什么也不做
+    void SinkSuppressed(RateLimiter::Clock::time_point now, const SrcHelper &source) const noexcept;
+
+    // loc 为 nullptr 时 (LogSrc) 在通过限流之后从 ctx 获取源码位置
+    void LogFormat(IPluginContext *ctx, const SourceLoc *loc, LevelEnum lvl, const cell_t *params, unsigned int param) const noexcept;
+    void LogFormatAmxTpl(IPluginContext *ctx, const SourceLoc *loc, LevelEnum lvl, const cell_t *params, unsigned int param) const noexcept;
+
     // source 用于发生错误时获取错误发生的源码位置
-    void SinkIt(const LogMsg &msg, const SrcHelper &source) const noexcept;
+    // skipDeferred 为 true 时不写入 m_DeferredSinks (消息已由 SinkDeferred 写入)
+    void SinkIt(const LogMsg &msg, const SrcHelper &source, bool skipDeferred = false) const noexcept;
+
+    // 将延迟格式化的消息 (格式化字符串与 CaptureToBuffer 保存的参数) 写入 m_DeferredSinks
+    // 返回 true 表示其他 sinks 也需要这条消息，调用者需要格式化后以 skipDeferred 调用 SinkIt
+    [[nodiscard]]
+    bool SinkDeferred(const LogMsg &msg, std::string_view format, std::string_view args, const SrcHelper &source) const noexcept;
+
+    // 以 '\n' 分隔的多行文本，每行一条消息，共用同一个时间点，flush 为 true 时只在最后一行之后刷新一次
+    // 不检查 backtrace，只用于 log4sp 生成的文本 (例如调用栈)，插件的消息不能拆分
+    void SinkLines(spdlog::log_clock::time_point time, LevelEnum lvl, string_view_t lines, const SrcHelper &source, bool flush) const noexcept;
+
+    // 写入 "title: msg"、"blame: 插件文件名" 与调用栈
+    void SinkStackTrace(IPluginContext *ctx, LevelEnum lvl, const char *title, string_view_t msg,
+                        const char *blame, const SrcHelper &source) const noexcept;
+
+    // 不检查 backtrace，由调用者决定是否需要刷新
+    void WriteToSinks(const LogMsg &msg, const SrcHelper &source, bool flush, bool skipDeferred = false) const noexcept;
     void Flush(const SrcHelper &source) const noexcept;
 
+    // 异步 Logger 的工作线程调用
+    // 错误会交给主线程在下一帧处理，因为 error handler 是 SourcePawn 的回调
+    void BackendSinkIt(const LogMsg &msg) const noexcept;
+    void BackendFlush() const noexcept;
+    void PostBackendError(const char *what, const SourceLoc &loc) const noexcept;
+
+    // 将消息写入所有 sinks，每个 sink 组只格式化一次
+    // onError 的参数为捕获的异常，未知异常时为 nullptr
+    template <typename ErrorHandler>
+    void LogToSinks(const LogMsg &msg, bool skipDeferred, ErrorHandler &&onError) const noexcept;
+
+    // 同步 Logger 中的 BinaryFileSink 可以直接保存格式化参数，其他情况返回 nullptr
+    [[nodiscard]] Sinks::BinaryFileSinkST *AsDeferredSink(spdlog::sinks::sink *sink) const noexcept;
+
+    // 返回 true 表示消息需要立即刷新
+    // 延迟刷新的策略只会将 logger 交给 FlushScheduler
+    [[nodiscard]] bool ShouldFlushNow(LevelEnum lvl) const noexcept;
+
+    // FlushScheduler 调用
+    [[nodiscard]] bool ScheduledFlushDue(FlushScheduler::Clock::time_point now) const noexcept;
+    void ScheduledFlush(FlushScheduler::Clock::time_point now) const noexcept;
+    [[nodiscard]] bool ScheduledSummaryDue(FlushScheduler::Clock::time_point now) const noexcept;
+    void ScheduledSummary(FlushScheduler::Clock::time_point now) const noexcept;
+
     const std::string m_Name;
     std::vector<SinkPtr> m_Sinks;
-    Level_t m_Level{LevelEnum::info};
+    mutable std::mutex m_SinksMutex;    // 保护异步 Logger 的 m_Sinks、m_SinkGroups 与 sinks 的 formatter
+
+    // 共享格式化: 支持写入已格式化消息且 pattern 相同的 sinks 为一组，共用 formatter 的拷贝
+    // formatter 为空的组只有一个 sink，由 sink 自行格式化
+    struct SinkGroup
+    {
+        std::unique_ptr<Formatter> formatter;
+        std::vector<spdlog::sinks::sink *> sinks;   // m_Sinks 持有所有权
+        bool deferred{false};                       // 唯一的 sink 是延迟格式化的 sink
+    };
+    std::vector<SinkGroup> m_SinkGroups;
+    bool m_SinkGroupsValid{true};       // 分组失败时逐个 sink 写入
+    Level_t m_Level{LevelEnum::info};       // 有效日志级别，显式设置或继承自父 logger
+    bool m_HasLevel{false};
+    Level_t m_SinkLevel{LevelEnum::off};    // sinks 的最低日志级别，没有 sink 时为 off
+    Level_t m_TextSinkLevel{LevelEnum::off};    // m_DeferredSinks 以外的 sinks 的最低日志级别
+    std::vector<Sinks::BinaryFileSinkST *> m_DeferredSinks;     // m_Sinks 持有所有权，只在主线程访问
     Level_t m_FlushLevel{LevelEnum::off};
+    FlushPolicy m_FlushPolicy{FlushPolicy::Immediate};
+    std::chrono::milliseconds m_FlushInterval{0};
+    mutable bool m_FlushScheduled{false};
+    mutable FlushScheduler::Clock::time_point m_LastScheduledFlush{};
+    mutable RateLimiter m_RateLimiter;
+    mutable bool m_SummaryScheduled{false};
+    std::unique_ptr<TraceDedup> m_TraceDedup;                   // nullptr 表示不去重，只在主线程访问
+    mutable spdlog::details::circular_q<spdlog::details::log_msg_buffer> m_Backtrace;     // 只在主线程访问
+    std::size_t m_BacktraceSize{0};                             // 0 表示未启用
+    LevelEnum m_BacktraceDumpLevel{LevelEnum::off};
     ErrHelper m_ErrHelper;
+    std::unique_ptr<ThreadPool> m_ThreadPool;   // 必须最后声明，以保证最先析构 (等待工作线程结束)
 };
 
 
@@ -0,0 +1,281 @@
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <vector>
+
+#ifdef _WIN32
+    #ifndef NOMINMAX
+        #define NOMINMAX
+    #endif
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+#include "spdlog/details/os.h"
+
+#include "log4sp/common.h"
+#include "log4sp/mapped_file.h"
+
+
+namespace Log4sp {
+
+MappedFile::~MappedFile() noexcept
+{
+    Close();
+}
+
+void MappedFile::Open(const spdlog::filename_t &filename, bool truncate, std::size_t segmentSize)
+{
+    using spdlog::details::os::filename_to_str;
+
+    Close();
+    m_Filename = filename;
+
+    auto granularity = Granularity();
+    m_SegmentSize = (std::max(segmentSize, std::size_t{1}) + granularity - 1) / granularity * granularity;
+
+    if (m_Handlers.before_open)
+        m_Handlers.before_open(m_Filename);
+
+    spdlog::details::os::create_dir(spdlog::details::os::dir_name(filename));
+
+#ifdef _WIN32
+    HANDLE file = ::CreateFileA(filename.c_str(), GENERIC_READ | GENERIC_WRITE,
+                                FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr,
+                                truncate ? CREATE_ALWAYS : OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+        ThrowLog4spEx("Failed opening file " + filename_to_str(filename) + " for writing (error code: " + std::to_string(::GetLastError()) + ")");
+
+    LARGE_INTEGER size;
+    if (!::GetFileSizeEx(file, &size))
+    {
+        auto error = ::GetLastError();
+        ::CloseHandle(file);
+        ThrowLog4spEx("Failed getting size of file " + filename_to_str(filename) + " (error code: " + std::to_string(error) + ")");
+    }
+
+    m_File = file;
+    m_Size = static_cast<std::size_t>(size.QuadPart);
+#else
+    int fd = ::open(filename.c_str(), O_RDWR | O_CREAT | O_CLOEXEC | (truncate ? O_TRUNC : 0), 0644);
+    if (fd == -1)
+        ThrowLog4spEx("Failed opening file " + filename_to_str(filename) + " for writing", errno);
+
+    struct stat st;
+    if (::fstat(fd, &st) == -1)
+    {
+        int error = errno;
+        ::close(fd);
+        ThrowLog4spEx("Failed getting size of file " + filename_to_str(filename), error);
+    }
+
+    m_Fd = fd;
+    m_Size = static_cast<std::size_t>(st.st_size);
+#endif
+
+    try
+    {
+        if (!truncate && m_Size > 0)
+            TrimPadding();
+
+        Map(0);
+    }
+    catch (...)
+    {
+        Close();
+        throw;
+    }
+}
+
+void MappedFile::Write(const char *data, std::size_t size)
+{
+    if (!IsOpen())
+        return;
+
+    if (m_Size + size > m_MapOffset + m_MapSize)
+        Map(size);
+
+    std::memcpy(m_Map + (m_Size - m_MapOffset), data, size);
+    m_Size += size;
+}
+
+void MappedFile::Close() noexcept
+{
+    if (!IsOpen())
+        return;
+
+    Unmap();
+
+#ifdef _WIN32
+    LARGE_INTEGER size;
+    size.QuadPart = static_cast<LONGLONG>(m_Size);
+    if (::SetFilePointerEx(static_cast<HANDLE>(m_File), size, nullptr, FILE_BEGIN))
+        ::SetEndOfFile(static_cast<HANDLE>(m_File));
+    ::CloseHandle(static_cast<HANDLE>(m_File));
+    m_File = nullptr;
+#else
+    (void)::ftruncate(m_Fd, static_cast<off_t>(m_Size));
+    ::close(m_Fd);
+    m_Fd = -1;
+#endif
+
+    m_Size = 0;
+    m_MapOffset = 0;
+
+    if (m_Handlers.after_close)
+        m_Handlers.after_close(m_Filename);
+}
+
+[[nodiscard]]
+bool MappedFile::IsOpen() const noexcept
+{
+#ifdef _WIN32
+    return m_File != nullptr;
+#else
+    return m_Fd != -1;
+#endif
+}
+
+void MappedFile::Map(std::size_t minBytes)
+{
+    using spdlog::details::os::filename_to_str;
+
+    Unmap();
+
+    auto granularity = Granularity();
+    auto offset = m_Size / granularity * granularity;
+    auto length = std::max(m_SegmentSize, m_Size - offset + minBytes);
+    length = (length + granularity - 1) / granularity * granularity;
+
+#ifdef _WIN32
+    // 映射对象的大小超过文件长度时，系统会扩展文件
+    ULARGE_INTEGER end;
+    end.QuadPart = static_cast<ULONGLONG>(offset + length);
+    HANDLE mapping = ::CreateFileMappingA(static_cast<HANDLE>(m_File), nullptr, PAGE_READWRITE, end.HighPart, end.LowPart, nullptr);
+    if (!mapping)
+        ThrowLog4spEx("Failed mapping file " + filename_to_str(m_Filename) + " (error code: " + std::to_string(::GetLastError()) + ")");
+
+    ULARGE_INTEGER start;
+    start.QuadPart = static_cast<ULONGLONG>(offset);
+    void *view = ::MapViewOfFile(mapping, FILE_MAP_WRITE, start.HighPart, start.LowPart, length);
+    if (!view)
+    {
+        auto error = ::GetLastError();
+        ::CloseHandle(mapping);
+        ThrowLog4spEx("Failed mapping file " + filename_to_str(m_Filename) + " (error code: " + std::to_string(error) + ")");
+    }
+
+    m_Mapping = mapping;
+#else
+    // 预分配磁盘空间，避免写入映射内存时因为磁盘已满而收到 SIGBUS
+  #ifdef __linux__
+    if (int error = ::posix_fallocate(m_Fd, static_cast<off_t>(offset), static_cast<off_t>(length)); error != 0)
+        ThrowLog4spEx("Failed allocating file " + filename_to_str(m_Filename), error);
+  #else
+    if (::ftruncate(m_Fd, static_cast<off_t>(offset + length)) == -1)
+        ThrowLog4spEx("Failed allocating file " + filename_to_str(m_Filename), errno);
+  #endif
+
+    void *view = ::mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED, m_Fd, static_cast<off_t>(offset));
+    if (view == MAP_FAILED)
+        ThrowLog4spEx("Failed mapping file " + filename_to_str(m_Filename), errno);
+#endif
+
+    m_Map = static_cast<char *>(view);
+    m_MapOffset = offset;
+    m_MapSize = length;
+}
+
+void MappedFile::TrimPadding()
+{
+    using spdlog::details::os::filename_to_str;
+
+    std::vector<char> buffer(64 * 1024);
+    auto end = m_Size;
+    while (end > 0)
+    {
+        auto chunk = std::min(end, buffer.size());
+        auto offset = end - chunk;
+
+#ifdef _WIN32
+        OVERLAPPED overlapped{};
+        overlapped.Offset = static_cast<DWORD>(offset);
+        overlapped.OffsetHigh = static_cast<DWORD>(static_cast<ULONGLONG>(offset) >> 32);
+        DWORD read = 0;
+        if (!::ReadFile(static_cast<HANDLE>(m_File), buffer.data(), static_cast<DWORD>(chunk), &read, &overlapped) || read != chunk)
+            ThrowLog4spEx("Failed reading file " + filename_to_str(m_Filename) + " (error code: " + std::to_string(::GetLastError()) + ")");
+#else
+        std::size_t read = 0;
+        while (read < chunk)
+        {
+            auto n = ::pread(m_Fd, buffer.data() + read, chunk - read, static_cast<off_t>(offset + read));
+            if (n == -1 && errno == EINTR)
+                continue;
+            if (n <= 0)
+                ThrowLog4spEx("Failed reading file " + filename_to_str(m_Filename), n == 0 ? EIO : errno);
+            read += static_cast<std::size_t>(n);
+        }
+#endif
+
+        auto i = chunk;
+        while (i > 0 && buffer[i - 1] == '\0')
+            --i;
+
+        end = offset + i;
+        if (i > 0)
+            break;
+    }
+
+    if (end == m_Size)
+        return;
+
+    m_Size = end;
+
+#ifdef _WIN32
+    LARGE_INTEGER size;
+    size.QuadPart = static_cast<LONGLONG>(m_Size);
+    if (!::SetFilePointerEx(static_cast<HANDLE>(m_File), size, nullptr, FILE_BEGIN) || !::SetEndOfFile(static_cast<HANDLE>(m_File)))
+        ThrowLog4spEx("Failed truncating file " + filename_to_str(m_Filename) + " (error code: " + std::to_string(::GetLastError()) + ")");
+#else
+    if (::ftruncate(m_Fd, static_cast<off_t>(m_Size)) == -1)
+        ThrowLog4spEx("Failed truncating file " + filename_to_str(m_Filename), errno);
+#endif
+}
+
+void MappedFile::Unmap() noexcept
+{
+    if (m_Map)
+    {
+#ifdef _WIN32
+        ::UnmapViewOfFile(m_Map);
+        ::CloseHandle(static_cast<HANDLE>(m_Mapping));
+        m_Mapping = nullptr;
+#else
+        ::munmap(m_Map, m_MapSize);
+#endif
+        m_Map = nullptr;
+    }
+    m_MapSize = 0;
+}
+
+[[nodiscard]]
+std::size_t MappedFile::Granularity() noexcept
+{
+#ifdef _WIN32
+    static const std::size_t granularity = []() {
+        SYSTEM_INFO info;
+        ::GetSystemInfo(&info);
+        return static_cast<std::size_t>(info.dwAllocationGranularity);
+    }();
+#else
+    static const std::size_t granularity = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+#endif
+    return granularity;
+}
+
+
+}       // namespace Log4sp
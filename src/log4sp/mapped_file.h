@@ -0,0 +1,87 @@
+#pragma once
+
+#include <cstddef>
+
+#include "spdlog/common.h"
+
+
+namespace Log4sp {
+
+/**
+ * 内存映射的追加写文件
+ *
+ * 文件按段预分配 (Linux: posix_fallocate, Windows: CreateFileMapping 扩展文件) 并映射到内存
+ * 写入只是一次 memcpy，当前段写满时映射下一段，关闭时把文件截断到实际写入的长度
+ *
+ * 写入的数据在 memcpy 之后就已经位于系统的页缓存中，进程崩溃不会丢失
+ * 但是在关闭之前，文件末尾是预分配的 '\0'，外部读取者会看到这部分填充
+ * 如果进程崩溃，文件会保留填充，下次不清空打开时去掉末尾的 '\0'，在实际数据之后继续追加
+ *
+ * 只能在同一时间被一个线程使用 (由 sink 的锁保证)
+ */
+class MappedFile final
+{
+public:
+    explicit MappedFile(const spdlog::file_event_handlers &handlers) noexcept : m_Handlers(handlers) {}
+    ~MappedFile() noexcept;
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    /**
+     * @brief 打开文件并映射第一段
+     *
+     * @param filename      文件路径
+     * @param truncate      true 时清空文件，否则在文件末尾追加 (跳过进程崩溃时残留的 '\0' 填充)
+     * @param segmentSize   每段映射的大小，向上对齐到系统的映射粒度
+     * @exception           打开、扩展或映射文件失败
+     */
+    void Open(const spdlog::filename_t &filename, bool truncate, std::size_t segmentSize);
+
+    /**
+     * @brief 追加数据，当前段剩余空间不足时映射下一段
+     *        大于段大小的数据会映射一个足够大的段
+     *
+     * @exception           扩展或映射文件失败
+     */
+    void Write(const char *data, std::size_t size);
+
+    /**
+     * @brief 解除映射，将文件截断到实际写入的长度并关闭
+     */
+    void Close() noexcept;
+
+    [[nodiscard]] bool IsOpen() const noexcept;
+    [[nodiscard]] const spdlog::filename_t &GetFilename() const noexcept { return m_Filename; }
+    [[nodiscard]] std::size_t GetSegmentSize() const noexcept { return m_SegmentSize; }
+    [[nodiscard]] std::size_t GetSize() const noexcept { return m_Size; }
+
+private:
+    // 从 m_Size 所在的映射粒度边界开始映射新的一段，至少能容纳 minBytes 字节
+    void Map(std::size_t minBytes);
+    void Unmap() noexcept;
+
+    // 从文件末尾向前跳过 '\0'，将 m_Size 与文件截断到实际数据的长度
+    void TrimPadding();
+
+    [[nodiscard]] static std::size_t Granularity() noexcept;
+
+    spdlog::file_event_handlers m_Handlers;
+    spdlog::filename_t m_Filename;
+    std::size_t m_SegmentSize{0};
+    std::size_t m_Size{0};                  // 实际写入的长度
+
+    char *m_Map{nullptr};                   // 当前段
+    std::size_t m_MapOffset{0};             // 当前段在文件中的偏移
+    std::size_t m_MapSize{0};
+
+#ifdef _WIN32
+    void *m_File{nullptr};                  // HANDLE
+    void *m_Mapping{nullptr};               // HANDLE
+#else
+    int m_Fd{-1};
+#endif
+};
+
+
+}       // namespace Log4sp
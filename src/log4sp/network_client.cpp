@@ -0,0 +1,442 @@
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <vector>
+
+#ifdef _WIN32
+    #ifndef NOMINMAX
+        #define NOMINMAX
+    #endif
+    #include <winsock2.h>
+    #include <ws2tcpip.h>
+#else
+    #include <fcntl.h>
+    #include <netdb.h>
+    #include <poll.h>
+    #include <sys/socket.h>
+    #include <unistd.h>
+#endif
+
+#include "log4sp/common.h"
+#include "log4sp/network_client.h"
+
+
+namespace Log4sp {
+
+namespace {
+
+#ifdef _WIN32
+constexpr std::uintptr_t InvalidSocket = INVALID_SOCKET;
+
+[[nodiscard]] int LastSocketError() noexcept { return ::WSAGetLastError(); }
+[[nodiscard]] bool WouldBlock(int error) noexcept { return error == WSAEWOULDBLOCK; }
+void CloseSocket(std::uintptr_t socket) noexcept { ::closesocket(static_cast<SOCKET>(socket)); }
+
+[[nodiscard]] bool SetNonBlocking(std::uintptr_t socket) noexcept
+{
+    u_long mode = 1;
+    return ::ioctlsocket(static_cast<SOCKET>(socket), FIONBIO, &mode) == 0;
+}
+
+[[nodiscard]] bool WaitWritable(std::uintptr_t socket, std::chrono::milliseconds timeout) noexcept
+{
+    WSAPOLLFD fd{static_cast<SOCKET>(socket), POLLWRNORM, 0};
+    return ::WSAPoll(&fd, 1, static_cast<INT>(timeout.count())) == 1 && (fd.revents & POLLWRNORM);
+}
+#else
+constexpr int InvalidSocket = -1;
+
+[[nodiscard]] int LastSocketError() noexcept { return errno; }
+[[nodiscard]] bool WouldBlock(int error) noexcept { return error == EAGAIN || error == EWOULDBLOCK || error == EINPROGRESS; }
+void CloseSocket(int socket) noexcept { ::close(socket); }
+
+[[nodiscard]] bool SetNonBlocking(int socket) noexcept
+{
+    int flags = ::fcntl(socket, F_GETFL, 0);
+    return flags != -1 && ::fcntl(socket, F_SETFL, flags | O_NONBLOCK) != -1 && ::fcntl(socket, F_SETFD, FD_CLOEXEC) != -1;
+}
+
+[[nodiscard]] bool WaitWritable(int socket, std::chrono::milliseconds timeout) noexcept
+{
+    pollfd fd{socket, POLLOUT, 0};
+    int result;
+    do
+    {
+        result = ::poll(&fd, 1, static_cast<int>(timeout.count()));
+    } while (result == -1 && errno == EINTR);
+    return result == 1 && (fd.revents & POLLOUT);
+}
+#endif
+
+// 距离 deadline 的时间，不超过 Timeout
+[[nodiscard]] std::chrono::milliseconds WaitTime(std::chrono::steady_clock::time_point deadline) noexcept
+{
+    auto now = std::chrono::steady_clock::now();
+    if (now >= deadline)
+        return std::chrono::milliseconds{0};
+    return std::min(NetworkClient::Timeout, std::chrono::duration_cast<std::chrono::milliseconds>(deadline - now));
+}
+
+// 已停止但可能还在发送剩余消息的工作线程，client 过期时线程已经结束
+struct StoppedWorker
+{
+    std::thread thread;
+    std::weak_ptr<NetworkClient> client;
+};
+
+std::mutex g_StoppedMutex;
+std::vector<StoppedWorker> g_StoppedWorkers;
+
+[[nodiscard]] std::string SocketErrorString(int error)
+{
+#ifdef _WIN32
+    return "error code: " + std::to_string(error);
+#else
+    return std::strerror(error);
+#endif
+}
+
+}       // namespace
+
+
+NetworkClient::NetworkClient(Protocol protocol, std::string host, std::uint16_t port, std::size_t bufferSize)
+    : m_Protocol(protocol), m_Host(std::move(host)), m_Port(port), m_BufferSize(bufferSize), m_Socket(InvalidSocket)
+{
+    if (!m_BufferSize)
+        ThrowLog4spEx("Network client buffer size must be greater than 0");
+
+#ifdef _WIN32
+    WSADATA data;
+    if (int error = ::WSAStartup(MAKEWORD(2, 2), &data); error != 0)
+        ThrowLog4spEx("WSAStartup failed (error code: " + std::to_string(error) + ")");
+#endif
+}
+
+[[nodiscard]]
+std::shared_ptr<NetworkClient> NetworkClient::Create(Protocol protocol, std::string host, std::uint16_t port, std::size_t bufferSize)
+{
+    std::shared_ptr<NetworkClient> client(new NetworkClient(protocol, std::move(host), port, bufferSize));
+
+    // 工作线程持有 client，停止后发送完剩余的消息再释放
+    client->m_Thread = std::thread([client]() { client->Run(); });
+    return client;
+}
+
+void NetworkClient::Destroy() noexcept
+{
+    std::vector<StoppedWorker> workers;
+    {
+        std::lock_guard<std::mutex> lock(g_StoppedMutex);
+        workers.swap(g_StoppedWorkers);
+    }
+
+    for (auto &worker : workers)
+        worker.thread.join();
+}
+
+NetworkClient::~NetworkClient() noexcept
+{
+#ifdef _WIN32
+    ::WSACleanup();
+#endif
+}
+
+void NetworkClient::Stop() noexcept
+{
+    std::thread thread;
+    {
+        // 在锁内取走线程对象，工作线程看到 m_Stop 并释放 client 时 m_Thread 已经为空
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        if (m_Stop)
+            return;
+        m_Stop = true;
+        thread = std::move(m_Thread);
+    }
+    m_Cond.notify_one();
+
+    if (!thread.joinable())
+        return;
+
+    std::lock_guard<std::mutex> lock(g_StoppedMutex);
+
+    // 顺便 join 已经结束的工作线程，避免列表一直增长
+    for (auto iter = g_StoppedWorkers.begin(); iter != g_StoppedWorkers.end(); )
+    {
+        if (iter->client.expired())
+        {
+            iter->thread.join();
+            iter = g_StoppedWorkers.erase(iter);
+        }
+        else
+        {
+            ++iter;
+        }
+    }
+
+    try
+    {
+        g_StoppedWorkers.push_back(StoppedWorker{std::move(thread), weak_from_this()});
+    }
+    catch (const std::bad_alloc &)
+    {
+        thread.detach();
+    }
+}
+
+void NetworkClient::Send(const char *data, std::size_t size) noexcept
+{
+    auto packetSize = PacketSize();
+    if (m_Protocol == Protocol::Udp)
+        size = std::min(size, DatagramSize);
+    if (!size)
+        return;
+
+    bool notify;
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        if (m_Buffered + size > m_BufferSize)
+        {
+            m_Dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+        try
+        {
+            if (m_Packets.empty() || m_Packets.back().data.size() + size > packetSize)
+                m_Packets.emplace_back();
+            m_Packets.back().data.append(data, size);
+        }
+        catch (const std::bad_alloc &)
+        {
+            m_Dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+        ++m_Packets.back().records;
+
+        // 刚凑满一个包时唤醒工作线程，不必每条消息都唤醒
+        notify = m_Buffered < packetSize && m_Buffered + size >= packetSize;
+        m_Buffered += size;
+    }
+
+    if (notify)
+        m_Cond.notify_one();
+}
+
+void NetworkClient::Flush() noexcept
+{
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_FlushRequested = true;
+    }
+    m_Cond.notify_one();
+}
+
+void NetworkClient::Run() noexcept
+{
+    std::deque<Packet> packets;
+    auto nextConnect = std::chrono::steady_clock::now();
+
+    while (true)
+    {
+        bool stop;
+        {
+            std::unique_lock<std::mutex> lock(m_Mutex);
+            if (m_Socket != InvalidSocket)
+                m_Cond.wait_for(lock, Interval, [this]() { return m_Stop || m_FlushRequested || m_Buffered >= PacketSize(); });
+            else
+                m_Cond.wait_until(lock, nextConnect, [this]() { return m_Stop; });
+
+            stop = m_Stop;
+            m_FlushRequested = false;
+        }
+
+        if (m_Socket == InvalidSocket)
+        {
+            // 停止时不再连接，连接与解析地址可能阻塞很久，剩余的消息全部丢弃
+            if (stop)
+            {
+                std::lock_guard<std::mutex> lock(m_Mutex);
+                for (const auto &packet : m_Packets)
+                    m_Dropped.fetch_add(packet.records, std::memory_order_relaxed);
+                m_Packets.clear();
+                m_Buffered = 0;
+                return;
+            }
+
+            auto now = std::chrono::steady_clock::now();
+            if (now >= nextConnect && !Connect())
+                nextConnect = now + RetryInterval;
+
+            if (m_Socket == InvalidSocket)
+                continue;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            packets.swap(m_Packets);
+            m_Buffered = 0;
+        }
+
+        // 停止时剩余的消息共用 DrainTimeout，超时后的消息被丢弃
+        auto deadline = stop ? std::chrono::steady_clock::now() + DrainTimeout : std::chrono::steady_clock::time_point::max();
+        for (const auto &packet : packets)
+        {
+            if (m_Socket == InvalidSocket || !Write(packet, deadline))
+                m_Dropped.fetch_add(packet.records, std::memory_order_relaxed);
+        }
+        packets.clear();
+
+        if (m_Socket == InvalidSocket)
+            nextConnect = std::chrono::steady_clock::now() + RetryInterval;
+
+        if (stop)
+            break;
+    }
+
+    Disconnect();
+}
+
+[[nodiscard]]
+bool NetworkClient::Connect() noexcept
+{
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = m_Protocol == Protocol::Udp ? SOCK_DGRAM : SOCK_STREAM;
+    hints.ai_protocol = m_Protocol == Protocol::Udp ? IPPROTO_UDP : IPPROTO_TCP;
+
+    auto target = m_Host + ":" + std::to_string(m_Port);
+
+    addrinfo *result = nullptr;
+    if (int error = ::getaddrinfo(m_Host.c_str(), std::to_string(m_Port).c_str(), &hints, &result); error != 0)
+    {
+        ReportError("Failed resolving " + target + " (" + ::gai_strerror(error) + ")");
+        return false;
+    }
+
+    int error = 0;
+    for (auto info = result; info; info = info->ai_next)
+    {
+        auto socket = static_cast<Socket>(::socket(info->ai_family, info->ai_socktype, info->ai_protocol));
+        if (socket == InvalidSocket)
+        {
+            error = LastSocketError();
+            continue;
+        }
+
+        // UDP 的 connect 只是记录目标地址，不会阻塞
+        if (!SetNonBlocking(socket))
+        {
+            error = LastSocketError();
+            CloseSocket(socket);
+            continue;
+        }
+
+        if (::connect(socket, info->ai_addr, static_cast<int>(info->ai_addrlen)) != 0)
+        {
+            error = LastSocketError();
+            if (!WouldBlock(error) || !WaitWritable(socket, Timeout))
+            {
+                CloseSocket(socket);
+                continue;
+            }
+
+            socklen_t length = sizeof(error);
+            if (::getsockopt(socket, SOL_SOCKET, SO_ERROR, reinterpret_cast<char *>(&error), &length) != 0 || error != 0)
+            {
+                CloseSocket(socket);
+                continue;
+            }
+        }
+
+        m_Socket = socket;
+        break;
+    }
+    ::freeaddrinfo(result);
+
+    if (m_Socket == InvalidSocket)
+    {
+        ReportError("Failed connecting to " + target + " (" + SocketErrorString(error) + ")");
+        return false;
+    }
+
+    m_Reported = false;
+    return true;
+}
+
+[[nodiscard]]
+bool NetworkClient::Write(const Packet &packet, std::chrono::steady_clock::time_point deadline) noexcept
+{
+#ifdef MSG_NOSIGNAL
+    constexpr int flags = MSG_NOSIGNAL;     // 对端关闭连接时不产生 SIGPIPE
+#else
+    constexpr int flags = 0;
+#endif
+
+    const char *data = packet.data.data();
+    std::size_t remaining = packet.data.size();
+    while (remaining)
+    {
+        auto sent = ::send(m_Socket, data, static_cast<int>(remaining), flags);
+        if (sent >= 0)
+        {
+            data += sent;
+            remaining -= static_cast<std::size_t>(sent);
+            continue;
+        }
+
+        int error = LastSocketError();
+#ifndef _WIN32
+        if (error == EINTR)
+            continue;
+#endif
+        if (WouldBlock(error) && WaitWritable(m_Socket, WaitTime(deadline)))
+            continue;
+
+        // UDP 的错误 (例如收到 ICMP 端口不可达) 只影响这一个数据报
+        // TCP 已经写入了一部分，剩下的部分无法再对齐到消息边界，只能重新连接
+        if (m_Protocol == Protocol::Tcp)
+        {
+            ReportError("Failed sending to " + m_Host + ":" + std::to_string(m_Port) + " (" + SocketErrorString(error) + ")");
+            Disconnect();
+        }
+        return false;
+    }
+    return true;
+}
+
+void NetworkClient::Disconnect() noexcept
+{
+    if (m_Socket != InvalidSocket)
+    {
+        CloseSocket(m_Socket);
+        m_Socket = InvalidSocket;
+    }
+}
+
+void NetworkClient::ReportError(const std::string &msg) noexcept
+{
+    if (m_Reported)
+        return;
+    m_Reported = true;
+
+    try
+    {
+        FrameTaskQueue::Instance().Post([msg]() {
+            smutils->LogError(myself, "[%s] %s", SMEXT_CONF_LOGTAG, msg.c_str());
+        });
+    }
+    catch (...)
+    {
+        // 无法报告错误，忽略
+    }
+}
+
+[[nodiscard]]
+std::size_t NetworkClient::PacketSize() const noexcept
+{
+    return m_Protocol == Protocol::Udp ? DatagramSize : StreamWriteSize;
+}
+
+
+}       // namespace Log4sp
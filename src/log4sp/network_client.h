@@ -0,0 +1,137 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+
+namespace Log4sp {
+
+/**
+ * 在后台线程中发送日志消息的 UDP / TCP 客户端
+ *
+ * 游戏线程只把消息追加到发送缓冲区，解析地址、连接与发送全部在工作线程中进行，所以不会阻塞游戏线程
+ * 工作线程每隔 Interval，或缓冲的数据足够一个包时，把多条消息合并发送:
+ *      UDP: 合并为不超过 DatagramSize 的数据报，超长的单条消息被截断
+ *      TCP: 合并为不超过 StreamWriteSize 的一次写入，连接断开后每隔 RetryInterval 重新连接
+ *
+ * 缓冲区的大小有上限，例如 TCP 无法连接时，缓冲区写满后的新消息被丢弃
+ * 发送失败的一批消息同样被丢弃，丢弃的消息数量可以通过 GetDroppedCount 获取
+ *
+ * 工作线程持有客户端对象，Stop 之后由工作线程在 DrainTimeout 内发送剩余的消息再释放，游戏线程不等待
+ * 停止的工作线程在拓展卸载时由 Destroy 统一 join
+ */
+class NetworkClient final : public std::enable_shared_from_this<NetworkClient>
+{
+public:
+    enum class Protocol
+    {
+        Udp,
+        Tcp
+    };
+
+    static constexpr std::size_t DatagramSize = 1400;                       // 小于常见的 MTU，避免 IP 分片
+    static constexpr std::size_t StreamWriteSize = 64 * 1024;
+    static constexpr std::chrono::milliseconds Interval{100};
+    static constexpr std::chrono::milliseconds Timeout{1000};               // 连接与每次写入的超时
+    static constexpr std::chrono::milliseconds RetryInterval{5000};
+    static constexpr std::chrono::milliseconds DrainTimeout{100};           // 停止时发送剩余消息的总时间
+
+    /**
+     * @brief 创建客户端并启动工作线程
+     *
+     * @param protocol      UDP 或 TCP
+     * @param host          主机名或 IP 地址，在工作线程中解析
+     * @param port          端口
+     * @param bufferSize    发送缓冲区的大小 (字节)
+     * @exception           bufferSize 为 0，或工作线程启动失败
+     */
+    [[nodiscard]]
+    static std::shared_ptr<NetworkClient> Create(Protocol protocol, std::string host, std::uint16_t port, std::size_t bufferSize);
+
+    /**
+     * @brief 用于 SDK_OnUnload 时等待所有已停止的工作线程结束
+     */
+    static void Destroy() noexcept;
+
+    ~NetworkClient() noexcept;
+
+    /**
+     * @brief 通知工作线程结束，不等待
+     *        已连接时工作线程先发送缓冲区中剩余的消息，总共最多 DrainTimeout，未连接时不再重新连接，剩余的消息被丢弃
+     */
+    void Stop() noexcept;
+
+    NetworkClient(const NetworkClient &) = delete;
+    NetworkClient &operator=(const NetworkClient &) = delete;
+
+    /**
+     * @brief 追加一条消息到发送缓冲区，缓冲区已满时丢弃
+     * @note  线程安全
+     */
+    void Send(const char *data, std::size_t size) noexcept;
+
+    /**
+     * @brief 唤醒工作线程立即发送缓冲区中的消息，不等待发送完成
+     * @note  线程安全
+     */
+    void Flush() noexcept;
+
+    [[nodiscard]] Protocol GetProtocol() const noexcept { return m_Protocol; }
+    [[nodiscard]] const std::string &GetHost() const noexcept { return m_Host; }
+    [[nodiscard]] std::uint16_t GetPort() const noexcept { return m_Port; }
+    [[nodiscard]] std::size_t GetBufferSize() const noexcept { return m_BufferSize; }
+    [[nodiscard]] std::uint64_t GetDroppedCount() const noexcept { return m_Dropped.load(std::memory_order_relaxed); }
+
+private:
+#ifdef _WIN32
+    using Socket = std::uintptr_t;          // SOCKET
+#else
+    using Socket = int;
+#endif
+
+    NetworkClient(Protocol protocol, std::string host, std::uint16_t port, std::size_t bufferSize);
+
+    struct Packet
+    {
+        std::string data;
+        std::size_t records{0};
+    };
+
+    void Run() noexcept;
+
+    // 以下函数只在工作线程中调用
+    [[nodiscard]] bool Connect() noexcept;
+    [[nodiscard]] bool Write(const Packet &packet, std::chrono::steady_clock::time_point deadline) noexcept;
+    void Disconnect() noexcept;
+    void ReportError(const std::string &msg) noexcept;
+
+    [[nodiscard]] std::size_t PacketSize() const noexcept;
+
+    const Protocol m_Protocol;
+    const std::string m_Host;
+    const std::uint16_t m_Port;
+    const std::size_t m_BufferSize;
+
+    std::mutex m_Mutex;
+    std::condition_variable m_Cond;
+    std::deque<Packet> m_Packets;           // 等待发送的消息，每个元素是一个数据报或一次写入
+    std::size_t m_Buffered{0};              // m_Packets 的总字节数
+    bool m_FlushRequested{false};
+    bool m_Stop{false};
+
+    std::atomic<std::uint64_t> m_Dropped{0};
+
+    Socket m_Socket;
+    bool m_Reported{false};                 // 连接失败只报告一次，直到再次连接成功
+    std::thread m_Thread;
+};
+
+
+}       // namespace Log4sp
@@ -0,0 +1,62 @@
+#include <algorithm>
+#include <utility>
+
+#include "log4sp/rate_limiter.h"
+
+
+namespace Log4sp {
+
+void RateLimiter::SetRate(std::uint32_t rate, std::uint32_t burst) noexcept
+{
+    m_Rate = rate;
+    m_Burst = burst != 0 ? burst : rate;
+    m_Tokens = m_Burst;                 // 修改后立即允许一次突发
+    m_LastRefill = Clock::now();
+}
+
+void RateLimiter::SetSample(std::uint32_t sample) noexcept
+{
+    m_Sample = std::max<std::uint32_t>(sample, 1);
+    m_SampleCounter = 0;
+}
+
+[[nodiscard]]
+bool RateLimiter::Allow(Clock::time_point now) noexcept
+{
+    // 先采样，被采样丢弃的消息不消耗令牌
+    if (m_Sample > 1 && m_SampleCounter++ % m_Sample != 0)
+    {
+        ++m_PendingSuppressed;
+        ++m_TotalSuppressed;
+        return false;
+    }
+
+    if (m_Rate != 0)
+    {
+        std::chrono::duration<double> elapsed = now - m_LastRefill;
+        m_LastRefill = now;
+        m_Tokens = std::min<double>(m_Tokens + elapsed.count() * m_Rate, m_Burst);
+
+        if (m_Tokens < 1.0)
+        {
+            ++m_PendingSuppressed;
+            ++m_TotalSuppressed;
+            return false;
+        }
+        m_Tokens -= 1.0;
+    }
+    return true;
+}
+
+[[nodiscard]]
+std::uint64_t RateLimiter::TakeSuppressed(Clock::time_point now) noexcept
+{
+    if (m_PendingSuppressed == 0 || now - m_LastSummary < SummaryInterval)
+        return 0;
+
+    m_LastSummary = now;
+    return std::exchange(m_PendingSuppressed, 0);
+}
+
+
+}       // namespace Log4sp
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+
+namespace Log4sp {
+
+/**
+ * Logger 的限流与采样
+ *
+ * 令牌桶: 每秒补充 rate 个令牌，最多积累 burst 个，每条消息消耗一个令牌，没有令牌时丢弃
+ * 采样:   每 N 条消息只保留 1 条
+ *
+ * 被丢弃的消息只计数，不会读取参数也不会格式化
+ * 被丢弃的数量由 Logger 以 warn 级别的 "N messages suppressed" 报告，每个 SummaryInterval 最多一次:
+ * 在下一条通过的消息之前，或者没有消息通过时由 FlushScheduler 在之后的游戏帧报告
+ *
+ * 只能在主线程使用
+ */
+class RateLimiter final
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr std::chrono::seconds SummaryInterval{1};
+
+    // return true if rate limiting or sampling is enabled
+    [[nodiscard]]
+    bool Enabled() const noexcept {
+        return m_Rate != 0 || m_Sample > 1;
+    }
+
+    [[nodiscard]] std::uint32_t GetRate() const noexcept    { return m_Rate; }
+    [[nodiscard]] std::uint32_t GetBurst() const noexcept   { return m_Burst; }
+    [[nodiscard]] std::uint32_t GetSample() const noexcept  { return m_Sample; }
+
+    /**
+     * @brief 设置令牌桶
+     *
+     * @param rate      每秒允许的消息数量，0 表示不限流
+     * @param burst     最多可以连续通过的消息数量，0 表示与 rate 相同
+     */
+    void SetRate(std::uint32_t rate, std::uint32_t burst) noexcept;
+
+    /**
+     * @brief 设置采样
+     *
+     * @param sample    每 sample 条消息保留 1 条，0 或 1 表示不采样
+     */
+    void SetSample(std::uint32_t sample) noexcept;
+
+    /**
+     * @brief 判断消息是否可以通过，不能通过时计数
+     *
+     * @return          true 表示消息可以通过
+     */
+    [[nodiscard]]
+    bool Allow(Clock::time_point now) noexcept;
+
+    /**
+     * @brief 取出需要报告的被丢弃数量
+     *
+     * @return          距离上次报告不足 SummaryInterval 或没有被丢弃的消息时返回 0
+     */
+    [[nodiscard]]
+    std::uint64_t TakeSuppressed(Clock::time_point now) noexcept;
+
+    // return true if TakeSuppressed would not wait for SummaryInterval (there may be nothing to report)
+    [[nodiscard]]
+    bool SummaryDue(Clock::time_point now) const noexcept {
+        return m_PendingSuppressed == 0 || now - m_LastSummary >= SummaryInterval;
+    }
+
+    // 累计被丢弃的消息数量
+    [[nodiscard]]
+    std::uint64_t GetTotalSuppressed() const noexcept {
+        return m_TotalSuppressed;
+    }
+
+private:
+    std::uint32_t m_Rate{0};
+    std::uint32_t m_Burst{0};
+    double m_Tokens{0};
+    Clock::time_point m_LastRefill{};
+
+    std::uint32_t m_Sample{1};
+    std::uint32_t m_SampleCounter{0};
+
+    std::uint64_t m_PendingSuppressed{0};       // 尚未报告的数量
+    std::uint64_t m_TotalSuppressed{0};
+    Clock::time_point m_LastSummary{};
+};
+
+
+}       // namespace Log4sp
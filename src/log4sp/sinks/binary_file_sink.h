@@ -0,0 +1,189 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+#include "spdlog/details/file_helper.h"
+#include "spdlog/details/null_mutex.h"
+#include "spdlog/sinks/base_sink.h"
+
+
+namespace Log4sp {
+namespace Sinks {
+
+/**
+ * 二进制日志文件的格式 (本机字节序)
+ *
+ * 文件头:  "L4SPBIN1" + uint32 版本
+ * 之后是连续的记录，每条记录以 1 字节类型开头:
+ *      Logger      uint32 id + uint32 长度 + logger 名称
+ *      Format      uint32 id + uint32 长度 + 格式化字符串
+ *      Deferred    int64 时间 (自 epoch 起的纳秒) + uint8 级别 + uint32 logger id + uint32 format id + uint32 长度 + 参数 (编码见 PutCaptured)
+ *      Text        int64 时间 + uint8 级别 + uint32 logger id + uint32 长度 + 已格式化的消息
+ *
+ * Logger 与 Format 记录在 id 第一次被使用之前写入，同一个 id 被再次定义时以新的定义为准
+ * 所以在已有的文件末尾追加 (每次打开都重新分配 id) 不会产生歧义
+ */
+namespace BinaryLog {
+
+inline constexpr char Magic[8] = {'L', '4', 'S', 'P', 'B', 'I', 'N', '1'};
+inline constexpr std::uint32_t Version = 1;
+
+enum class RecordType : std::uint8_t
+{
+    Logger = 1,
+    Format,
+    Deferred,
+    Text
+};
+
+}       // namespace BinaryLog
+
+/**
+ * 二进制日志文件 sink
+ *
+ * 同步 Logger 使用格式化字符串记录日志时 (例如 Logger.Info) 调用 LogDeferred，只保存格式化字符串的 id 与参数，不格式化消息
+ * 其他消息 (以及异步 Logger 的所有消息) 保存已格式化的消息本身
+ * 文件需要使用 tools/binlog_decode 离线解码
+ *
+ * 字典 (logger 名称与格式化字符串) 的条目数达到上限时清空，之后重新分配 id
+ */
+template <typename Mutex>
+class BinaryFileSink final : public spdlog::sinks::base_sink<Mutex>
+{
+    using LogMsg = spdlog::details::log_msg;
+
+public:
+    explicit BinaryFileSink(const spdlog::filename_t &filename, bool truncate = false,
+                            const spdlog::file_event_handlers &handlers = {})
+        : m_FileHelper{handlers}
+    {
+        m_FileHelper.open(filename, truncate);
+        if (m_FileHelper.size() == 0)
+            WriteHeader();
+    }
+
+    [[nodiscard]]
+    const spdlog::filename_t &GetFilename() noexcept {
+        std::lock_guard<Mutex> lock(spdlog::sinks::base_sink<Mutex>::mutex_);
+        return m_FileHelper.filename();
+    }
+
+    /**
+     * @brief 写入一条延迟格式化的消息，调用者负责检查日志级别
+     *
+     * @param msg       消息的时间、级别与 logger 名称，不使用 payload
+     * @param format    格式化字符串
+     * @param args      CaptureToBuffer 保存的参数
+     */
+    void LogDeferred(const LogMsg &msg, std::string_view format, std::string_view args) {
+        std::lock_guard<Mutex> lock(spdlog::sinks::base_sink<Mutex>::mutex_);
+
+        auto loggerId = DefineLogger({msg.logger_name.data(), msg.logger_name.size()});
+        auto formatId = Define(m_Formats, BinaryLog::RecordType::Format, format);
+
+        m_Record.clear();
+        Put(BinaryLog::RecordType::Deferred);
+        Put(TimeOf(msg));
+        Put(static_cast<std::uint8_t>(msg.level));
+        Put(loggerId);
+        Put(formatId);
+        PutString(args);
+        m_FileHelper.write(m_Record);
+    }
+
+private:
+    using Dictionary = std::unordered_map<std::string_view, std::uint32_t>;     // 键指向 m_Strings
+
+    static constexpr std::size_t MaxDictEntries = 4096;
+
+    spdlog::details::file_helper m_FileHelper;
+    spdlog::memory_buf_t m_Record;
+    std::deque<std::string> m_Strings;
+    Dictionary m_Loggers;
+    Dictionary m_Formats;
+
+    void sink_it_(const LogMsg &msg) override {
+        auto loggerId = DefineLogger({msg.logger_name.data(), msg.logger_name.size()});
+
+        m_Record.clear();
+        Put(BinaryLog::RecordType::Text);
+        Put(TimeOf(msg));
+        Put(static_cast<std::uint8_t>(msg.level));
+        Put(loggerId);
+        PutString({msg.payload.data(), msg.payload.size()});
+        m_FileHelper.write(m_Record);
+    }
+
+    void flush_() override {
+        m_FileHelper.flush();
+    }
+
+    [[nodiscard]]
+    static std::int64_t TimeOf(const LogMsg &msg) noexcept {
+        using std::chrono::duration_cast;
+        using std::chrono::nanoseconds;
+        return static_cast<std::int64_t>(duration_cast<nanoseconds>(msg.time.time_since_epoch()).count());
+    }
+
+    template <typename T>
+    void Put(T value) {
+        const char *data = reinterpret_cast<const char *>(&value);
+        m_Record.append(data, data + sizeof(T));
+    }
+
+    void PutString(std::string_view str) {
+        Put(static_cast<std::uint32_t>(str.size()));
+        m_Record.append(str.data(), str.data() + str.size());
+    }
+
+    void WriteHeader() {
+        m_Record.clear();
+        m_Record.append(std::begin(BinaryLog::Magic), std::end(BinaryLog::Magic));
+        Put(BinaryLog::Version);
+        m_FileHelper.write(m_Record);
+    }
+
+    [[nodiscard]]
+    std::uint32_t DefineLogger(std::string_view name) {
+        return Define(m_Loggers, BinaryLog::RecordType::Logger, name);
+    }
+
+    // 返回 str 的 id，第一次出现时写入定义记录
+    [[nodiscard]]
+    std::uint32_t Define(Dictionary &dict, BinaryLog::RecordType type, std::string_view str) {
+        auto iter = dict.find(str);
+        if (iter != dict.end())
+            return iter->second;
+
+        if (dict.size() >= MaxDictEntries)
+        {
+            m_Loggers.clear();
+            m_Formats.clear();
+            m_Strings.clear();
+        }
+
+        auto id = static_cast<std::uint32_t>(dict.size());
+        const std::string &key = m_Strings.emplace_back(str);
+        dict.emplace(std::string_view{key}, id);
+
+        m_Record.clear();
+        Put(type);
+        Put(id);
+        PutString(key);
+        m_FileHelper.write(m_Record);
+        return id;
+    }
+};
+
+using BinaryFileSinkMT = BinaryFileSink<std::mutex>;
+using BinaryFileSinkST = BinaryFileSink<spdlog::details::null_mutex>;
+
+
+}       // namespace Sinks
+}       // namespace Log4sp
@@ -1,9 +1,13 @@
 #pragma once
 
+#include <memory>
+
 #include "spdlog/sinks/base_sink.h"
 
 #include "extension.h"
 
+#include "log4sp/frame_task_queue.h"
+
 
 namespace Log4sp {
 namespace Sinks {
@@ -12,8 +16,11 @@ namespace Sinks {
  * spdlog 1.x 的 callback_sink 仅支持单回调 (在 log -> sink_it 时)
  * 且回调函数初始化完毕后无法修改，因此重新实现一个增强版
  * 初始化后仍支持修改似乎并不是一个特别好的特性，但目前没有遇到阻碍，暂时保留
+ *
+ * 被异步 Logger 的工作线程调用时，回调会被推迟到下一帧由主线程执行
  */
-class CallbackSink final : public spdlog::sinks::base_sink<spdlog::details::null_mutex>
+class CallbackSink final : public spdlog::sinks::base_sink<spdlog::details::null_mutex>,
+                           public std::enable_shared_from_this<CallbackSink>
 {
 public:
     using LogMsg = spdlog::details::log_msg;
@@ -84,33 +91,77 @@ private:
     SourceMod::IChangeableForward *m_LogPostFwd{nullptr};
     SourceMod::IChangeableForward *m_FlushFwd{nullptr};
 
-    void sink_it_(const LogMsg &logMsg) noexcept override {
+    void sink_it_(const LogMsg &logMsg) override {
+        if (!m_LogFwd && !m_LogPostFwd) {
+            return;
+        }
+
+        auto logTime = std::chrono::duration_cast<std::chrono::seconds>(logMsg.time.time_since_epoch());
+        std::string name{logMsg.logger_name.data(), logMsg.logger_name.size()};
+        std::string msg{logMsg.payload.data(), logMsg.payload.size()};
+        std::string file = logMsg.source.filename ? logMsg.source.filename : "";
+        std::string func = logMsg.source.funcname ? logMsg.source.funcname : "";
+        std::string formatted = m_LogPostFwd ? to_pattern(logMsg) : std::string{};
+
+        if (FrameTaskQueue::Instance().IsMainThread()) {
+            ExecuteLogForwards(name, logMsg.level, msg, file, logMsg.source.line, func, static_cast<cell_t>(logTime.count()), formatted);
+            return;
+        }
+
+        // 回调可能在下一帧前被修改或 sink 已被释放，所以执行时再读取
+        FrameTaskQueue::Instance().Post(
+            [weak = weak_from_this(), name = std::move(name), lvl = logMsg.level, msg = std::move(msg), file = std::move(file),
+             line = logMsg.source.line, func = std::move(func), logTime = static_cast<cell_t>(logTime.count()), formatted = std::move(formatted)]()
+            {
+                if (auto sink = weak.lock()) {
+                    sink->ExecuteLogForwards(name, lvl, msg, file, line, func, logTime, formatted);
+                }
+            }
+        );
+    }
+
+    void flush_() override {
+        if (!m_FlushFwd) {
+            return;
+        }
+
+        if (FrameTaskQueue::Instance().IsMainThread()) {
+            ExecuteFlushForward();
+            return;
+        }
+
+        FrameTaskQueue::Instance().Post(
+            [weak = weak_from_this()]()
+            {
+                if (auto sink = weak.lock()) {
+                    sink->ExecuteFlushForward();
+                }
+            }
+        );
+    }
+
+    void ExecuteLogForwards(const std::string &name, spdlog::level::level_enum lvl, const std::string &msg, const std::string &file,
+                            int line, const std::string &func, cell_t logTime, const std::string &formatted) noexcept {
         if (m_LogFwd) {
             auto fwd = m_LogFwd;
-            auto logTime = std::chrono::duration_cast<std::chrono::seconds>(logMsg.time.time_since_epoch());
-            auto file    = logMsg.source.filename ? logMsg.source.filename : "";
-            auto func    = logMsg.source.funcname ? logMsg.source.funcname : "";
-
-            FWD_PUSH_STRING(logMsg.logger_name.data());             // name
-            FWD_PUSH_CELL(logMsg.level);                            // lvl
-            FWD_PUSH_STRING(logMsg.payload.data());                 // msg
-            FWD_PUSH_STRING(file);                                  // file
-            FWD_PUSH_CELL(logMsg.source.line);                      // line
-            FWD_PUSH_STRING(func);                                  // func
-            FWD_PUSH_CELL(static_cast<cell_t>(logTime.count()));    // logTime
+            FWD_PUSH_STRING(name.c_str());                          // name
+            FWD_PUSH_CELL(lvl);                                     // lvl
+            FWD_PUSH_STRING(msg.c_str());                           // msg
+            FWD_PUSH_STRING(file.c_str());                          // file
+            FWD_PUSH_CELL(line);                                    // line
+            FWD_PUSH_STRING(func.c_str());                          // func
+            FWD_PUSH_CELL(logTime);                                 // logTime
             FWD_EXECUTE();
         }
 
         if (m_LogPostFwd) {
             auto fwd = m_LogPostFwd;
-            std::string formatted = to_pattern(logMsg);
-
             FWD_PUSH_STRING(formatted.c_str());
             FWD_EXECUTE();
         }
     }
 
-    void flush_() noexcept override {
+    void ExecuteFlushForward() noexcept {
         if (m_FlushFwd) {
             auto fwd = m_FlushFwd;
             FWD_EXECUTE();
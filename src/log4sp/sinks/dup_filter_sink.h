@@ -0,0 +1,139 @@
+// ref: https://github.com/gabime/spdlog/blob/v1.x/include/spdlog/sinks/dup_filter_sink.h
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include "spdlog/sinks/dist_sink.h"
+
+#include "extension.h"
+
+
+namespace Log4sp {
+namespace Sinks {
+
+/**
+ * 重复消息过滤 sink，将消息转发给子 sinks
+ * 与上一条消息相同且间隔小于 maxSkipDuration 时跳过，并在下一条不同的消息之前 (或刷新时) 输出 "skipped N duplicate messages"
+ *
+ * spdlog 1.x 的 dup_filter_sink 每条消息都需要比较并拷贝完整的 payload
+ * 这里只保存 payload 的哈希值与长度，重复消息只需要计算一次哈希
+ * 哈希碰撞会导致一条不同的消息被当作重复消息跳过，所以在 32 位平台上也使用 64 位哈希 (FNV-1a)
+ */
+template <typename Mutex>
+class DupFilterSink final : public spdlog::sinks::dist_sink<Mutex>
+{
+    using LogMsg    = spdlog::details::log_msg;
+    using LevelEnum = spdlog::level::level_enum;
+
+public:
+    template <class Rep, class Period>
+    explicit DupFilterSink(std::chrono::duration<Rep, Period> maxSkipDuration, LevelEnum notificationLevel = LevelEnum::info) noexcept
+        : m_MaxSkipDuration{maxSkipDuration}, m_NotificationLevel{notificationLevel} {}
+
+    // 累计跳过的重复消息数量
+    [[nodiscard]]
+    std::size_t GetSkippedCount() noexcept {
+        std::lock_guard<Mutex> lock(spdlog::sinks::base_sink<Mutex>::mutex_);
+        return m_TotalSkipped;
+    }
+
+    // return true if the sink is a child (or a descendant) of this sink
+    // 用于防止 sink 循环嵌套
+    [[nodiscard]]
+    bool Contains(const spdlog::sinks::sink *sink) noexcept {
+        std::lock_guard<Mutex> lock(spdlog::sinks::base_sink<Mutex>::mutex_);
+        for (auto &child : spdlog::sinks::dist_sink<Mutex>::sinks_)
+        {
+            if (child.get() == sink)
+                return true;
+
+            auto dup = dynamic_cast<DupFilterSink *>(child.get());
+            if (dup && dup->Contains(sink))
+                return true;
+        }
+        return false;
+    }
+
+private:
+    std::chrono::microseconds m_MaxSkipDuration;
+    LevelEnum m_NotificationLevel;
+
+    spdlog::log_clock::time_point m_LastTime{};
+    std::uint64_t m_LastHash{0};
+    std::size_t m_LastSize{0};
+    LevelEnum m_LastLevel{LevelEnum::off};
+    std::string m_LastLoggerName;               // 刷新时输出跳过数量使用
+    std::size_t m_Skipped{0};
+    std::size_t m_TotalSkipped{0};
+
+    void sink_it_(const LogMsg &msg) override {
+        std::string_view payload(msg.payload.data(), msg.payload.size());
+        auto hash = Hash(payload);
+
+        if (hash == m_LastHash && payload.size() == m_LastSize && msg.level == m_LastLevel &&
+            msg.time - m_LastTime < m_MaxSkipDuration)
+        {
+            ++m_Skipped;
+            ++m_TotalSkipped;
+            return;
+        }
+
+        SinkSkipped(msg);
+        spdlog::sinks::dist_sink<Mutex>::sink_it_(msg);
+
+        m_LastTime  = msg.time;
+        m_LastHash  = hash;
+        m_LastSize  = payload.size();
+        m_LastLevel = msg.level;
+        if (std::string_view(m_LastLoggerName) != std::string_view(msg.logger_name.data(), msg.logger_name.size()))
+            m_LastLoggerName.assign(msg.logger_name.data(), msg.logger_name.size());
+    }
+
+    void flush_() override {
+        // 刷新时输出已跳过的数量，之后的重复消息仍然会被跳过
+        if (m_Skipped > 0)
+        {
+            LogMsg msg{spdlog::source_loc{}, m_LastLoggerName, m_NotificationLevel, spdlog::string_view_t{}};
+            SinkSkipped(msg);
+        }
+        spdlog::sinks::dist_sink<Mutex>::flush_();
+    }
+
+    // std::hash 的结果是 size_t，在 x86 上只有 32 位
+    [[nodiscard]]
+    static std::uint64_t Hash(std::string_view data) noexcept {
+        std::uint64_t hash = 14695981039346656037ULL;
+        for (unsigned char c : data)
+        {
+            hash ^= c;
+            hash *= 1099511628211ULL;
+        }
+        return hash;
+    }
+
+    // 输出 "skipped N duplicate messages"，使用 msg 的 logger 名称与源码位置
+    void SinkSkipped(const LogMsg &msg) {
+        if (m_Skipped == 0)
+            return;
+
+        char buf[64];
+        auto size = ::snprintf(buf, sizeof(buf), "skipped %zu duplicate messages", m_Skipped);
+        m_Skipped = 0;
+
+        if (size > 0 && static_cast<std::size_t>(size) < sizeof(buf))
+        {
+            LogMsg skippedMsg{msg.source, msg.logger_name, m_NotificationLevel, spdlog::string_view_t{buf, static_cast<std::size_t>(size)}};
+            spdlog::sinks::dist_sink<Mutex>::sink_it_(skippedMsg);
+        }
+    }
+};
+
+using DupFilterSinkMT = DupFilterSink<std::mutex>;
+using DupFilterSinkST = DupFilterSink<spdlog::details::null_mutex>;
+
+
+}       // namespace Sinks
+}       // namespace Log4sp
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <mutex>
+
+#include "spdlog/details/null_mutex.h"
+#include "spdlog/sinks/base_sink.h"
+
+#include "log4sp/mapped_file.h"
+
+
+namespace Log4sp {
+namespace Sinks {
+
+/**
+ * 内存映射文件 sink
+ * 每条消息只需要一次 memcpy，适合高吞吐量的 logger，文件的写入方式见 MappedFile
+ *
+ * 数据写入映射内存后即对系统可见，所以 flush 不需要做任何事
+ */
+template <typename Mutex>
+class MappedFileSink final : public spdlog::sinks::base_sink<Mutex>
+{
+    using LogMsg = spdlog::details::log_msg;
+
+public:
+    MappedFileSink(const spdlog::filename_t &filename, std::size_t segmentSize, bool truncate = false,
+                   const spdlog::file_event_handlers &handlers = {})
+        : m_File{handlers}
+    {
+        m_File.Open(filename, truncate, segmentSize);
+    }
+
+    ~MappedFileSink() override
+    {
+        std::lock_guard<Mutex> lock(spdlog::sinks::base_sink<Mutex>::mutex_);
+        m_File.Close();
+    }
+
+    [[nodiscard]]
+    const spdlog::filename_t &GetFilename() noexcept {
+        std::lock_guard<Mutex> lock(spdlog::sinks::base_sink<Mutex>::mutex_);
+        return m_File.GetFilename();
+    }
+
+    [[nodiscard]]
+    std::size_t GetSegmentSize() noexcept {
+        std::lock_guard<Mutex> lock(spdlog::sinks::base_sink<Mutex>::mutex_);
+        return m_File.GetSegmentSize();
+    }
+
+    //* @log4sp hack *//
+    [[nodiscard]] bool accepts_formatted() const override { return true; }
+
+private:
+    MappedFile m_File;
+
+    void sink_it_(const LogMsg &msg) override {
+        spdlog::memory_buf_t formatted;
+        spdlog::sinks::base_sink<Mutex>::formatter_->format(msg, formatted);
+        sink_formatted_(msg, formatted);
+    }
+
+    //* @log4sp hack *//
+    void sink_formatted_(const LogMsg &msg, const spdlog::memory_buf_t &formatted) override {
+        (void)msg;
+        m_File.Write(formatted.data(), formatted.size());
+    }
+
+    void flush_() override {}
+};
+
+using MappedFileSinkMT = MappedFileSink<std::mutex>;
+using MappedFileSinkST = MappedFileSink<spdlog::details::null_mutex>;
+
+
+}       // namespace Sinks
+}       // namespace Log4sp
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <mutex>
+
+#include "spdlog/details/null_mutex.h"
+#include "spdlog/sinks/base_sink.h"
+
+#include "log4sp/network_client.h"
+
+
+namespace Log4sp {
+namespace Sinks {
+
+/**
+ * 网络 sink，将格式化后的消息通过 UDP 或 TCP 发送
+ * 游戏线程只把消息追加到发送缓冲区，批量发送在后台线程中进行，见 NetworkClient
+ *
+ * flush 只唤醒后台线程，不等待发送完成
+ * 析构时只通知后台线程结束，不等待剩余的消息发送完成
+ */
+template <typename Mutex, NetworkClient::Protocol P>
+class NetworkSink final : public spdlog::sinks::base_sink<Mutex>
+{
+    using LogMsg = spdlog::details::log_msg;
+
+public:
+    NetworkSink(std::string host, std::uint16_t port, std::size_t bufferSize)
+        : m_Client{NetworkClient::Create(P, std::move(host), port, bufferSize)} {}
+
+    ~NetworkSink() override {
+        m_Client->Stop();
+    }
+
+    // NetworkClient 自身是线程安全的，不需要 sink 的锁
+    [[nodiscard]] const std::string &GetHost() const noexcept { return m_Client->GetHost(); }
+    [[nodiscard]] std::uint16_t GetPort() const noexcept { return m_Client->GetPort(); }
+    [[nodiscard]] std::size_t GetBufferSize() const noexcept { return m_Client->GetBufferSize(); }
+    [[nodiscard]] std::uint64_t GetDroppedCount() const noexcept { return m_Client->GetDroppedCount(); }
+
+    //* @log4sp hack *//
+    [[nodiscard]] bool accepts_formatted() const override { return true; }
+
+private:
+    std::shared_ptr<NetworkClient> m_Client;
+
+    void sink_it_(const LogMsg &msg) override {
+        spdlog::memory_buf_t formatted;
+        spdlog::sinks::base_sink<Mutex>::formatter_->format(msg, formatted);
+        sink_formatted_(msg, formatted);
+    }
+
+    //* @log4sp hack *//
+    void sink_formatted_(const LogMsg &msg, const spdlog::memory_buf_t &formatted) override {
+        (void)msg;
+        m_Client->Send(formatted.data(), formatted.size());
+    }
+
+    void flush_() override {
+        m_Client->Flush();
+    }
+};
+
+using UdpSinkMT = NetworkSink<std::mutex, NetworkClient::Protocol::Udp>;
+using UdpSinkST = NetworkSink<spdlog::details::null_mutex, NetworkClient::Protocol::Udp>;
+using TcpSinkMT = NetworkSink<std::mutex, NetworkClient::Protocol::Tcp>;
+using TcpSinkST = NetworkSink<spdlog::details::null_mutex, NetworkClient::Protocol::Tcp>;
+
+
+}       // namespace Sinks
+}       // namespace Log4sp
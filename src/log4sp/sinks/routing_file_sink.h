@@ -0,0 +1,272 @@
+#pragma once
+
+#include <algorithm>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "spdlog/details/file_helper.h"
+#include "spdlog/details/null_mutex.h"
+#include "spdlog/sinks/base_sink.h"
+
+#include "log4sp/common.h"
+#include "log4sp/frame_task_queue.h"
+#include "log4sp/source_helper.h"
+
+
+namespace Log4sp {
+namespace Sinks {
+
+/**
+ * 按来源分流的文件 sink，每个插件 (或每个 logger 名称) 写入各自的文件
+ * 文件名由模板中的 "{}" 替换为插件的文件名 (去掉 .smx) 或 logger 名称得到
+ *
+ * 多个插件共用一个 sink 时，打开的文件数量不超过 maxOpenFiles，超过时关闭最久未写入的文件 (LRU)
+ * 消息先追加到每个文件各自的缓冲区，在下一个游戏帧 (或 flush 时) 一次写入，缓冲区超过 BatchSize 时立即写入
+ *
+ * 插件只能在同步写入 sinks 时确定 (见 CallerScope)，异步 Logger 或没有调用插件的消息按 logger 名称分流
+ */
+template <typename Mutex>
+class RoutingFileSink final : public spdlog::sinks::base_sink<Mutex>,
+                              public std::enable_shared_from_this<RoutingFileSink<Mutex>>
+{
+    using LogMsg = spdlog::details::log_msg;
+
+public:
+    enum class Key
+    {
+        Plugin,
+        LoggerName
+    };
+
+    static constexpr std::size_t BatchSize = 64 * 1024;
+
+    /**
+     * @param pattern       文件名模板，必须包含 "{}"
+     * @param key           按插件还是按 logger 名称分流
+     * @param maxOpenFiles  同时打开的文件数量上限
+     * @exception           pattern 不包含 "{}"，或 maxOpenFiles 为 0
+     */
+    RoutingFileSink(spdlog::filename_t pattern, Key key, std::size_t maxOpenFiles)
+        : m_Pattern(std::move(pattern)), m_Key(key), m_MaxOpenFiles(maxOpenFiles)
+    {
+        if (m_Pattern.find("{}") == spdlog::filename_t::npos)
+            ThrowLog4spEx("Routing file pattern must contain \"{}\"");
+
+        if (!m_MaxOpenFiles)
+            ThrowLog4spEx("Routing file sink max open files must be greater than 0");
+    }
+
+    ~RoutingFileSink() override
+    {
+        std::lock_guard<std::mutex> lock(m_BatchMutex);
+        try
+        {
+            WriteBatches();
+        }
+        catch (...)
+        {
+            // 析构时无法报告错误
+        }
+    }
+
+    [[nodiscard]] const spdlog::filename_t &GetPattern() const noexcept { return m_Pattern; }
+    [[nodiscard]] Key GetKey() const noexcept { return m_Key; }
+    [[nodiscard]] std::size_t GetMaxOpenFiles() const noexcept { return m_MaxOpenFiles; }
+
+    [[nodiscard]]
+    std::size_t GetRouteCount() noexcept {
+        std::lock_guard<std::mutex> lock(m_BatchMutex);
+        return m_Routes.size();
+    }
+
+    [[nodiscard]]
+    std::size_t GetOpenFileCount() noexcept {
+        std::lock_guard<std::mutex> lock(m_BatchMutex);
+        return m_OpenFiles.size();
+    }
+
+    //* @log4sp hack *//
+    [[nodiscard]] bool accepts_formatted() const override { return true; }
+
+private:
+    struct Route
+    {
+        spdlog::filename_t filename;
+        spdlog::memory_buf_t pending;                               // 等待写入的消息
+        std::unique_ptr<spdlog::details::file_helper> file;         // 文件打开时非空
+        typename std::list<Route *>::iterator lru;                  // 文件打开时在 m_OpenFiles 中的位置
+    };
+
+    const spdlog::filename_t m_Pattern;
+    const Key m_Key;
+    const std::size_t m_MaxOpenFiles;
+
+    // 批量写入的任务在主线程执行，而异步 Logger 在工作线程写入 sink，所以需要独立于 sink 的锁
+    std::mutex m_BatchMutex;
+    std::unordered_map<std::string, Route> m_Routes;
+    std::list<Route *> m_OpenFiles;                 // 最近写入的在前
+    std::vector<Route *> m_Dirty;                   // pending 不为空的 routes
+    bool m_Scheduled{false};                        // 已经安排在下一个游戏帧写入
+
+    void sink_it_(const LogMsg &msg) override {
+        spdlog::memory_buf_t formatted;
+        spdlog::sinks::base_sink<Mutex>::formatter_->format(msg, formatted);
+        sink_formatted_(msg, formatted);
+    }
+
+    //* @log4sp hack *//
+    void sink_formatted_(const LogMsg &msg, const spdlog::memory_buf_t &formatted) override {
+        auto name = RouteName(msg);
+
+        std::lock_guard<std::mutex> lock(m_BatchMutex);
+        auto [it, inserted] = m_Routes.try_emplace(name);
+        auto &route = it->second;
+        if (inserted)
+        {
+            route.filename = m_Pattern;
+            route.filename.replace(route.filename.find("{}"), 2, name);
+        }
+
+        if (!route.pending.size())
+            m_Dirty.push_back(&route);
+        route.pending.append(formatted.data(), formatted.data() + formatted.size());
+
+        if (route.pending.size() >= BatchSize)
+        {
+            m_Dirty.erase(std::find(m_Dirty.begin(), m_Dirty.end(), &route));
+            WriteRoute(route);
+            return;
+        }
+
+        if (!m_Scheduled)
+            Schedule();
+    }
+
+    void flush_() override {
+        std::lock_guard<std::mutex> lock(m_BatchMutex);
+        WriteBatches();
+        for (auto route : m_OpenFiles)
+            route->file->flush();
+    }
+
+    // 插件文件名或 logger 名称，不能用于文件名的字符被替换为 '_'
+    [[nodiscard]]
+    std::string RouteName(const LogMsg &msg) const {
+        SourceMod::IPlugin *plugin = nullptr;
+        if (m_Key == Key::Plugin)
+        {
+            if (auto ctx = CallerScope::Current())
+                plugin = PluginSysFindPluginByCtx(ctx);
+        }
+
+        std::string name;
+        if (plugin)
+        {
+            name = plugin->GetFilename();
+            if (name.size() > 4 && !name.compare(name.size() - 4, 4, ".smx"))
+                name.resize(name.size() - 4);
+        }
+        else
+        {
+            name.assign(msg.logger_name.data(), msg.logger_name.size());
+        }
+
+        for (auto &c : name)
+        {
+            if (c == '/' || c == '\\' || c == ':' || c == '*' || c == '?' || c == '"' || c == '<' || c == '>' || c == '|')
+                c = '_';
+        }
+        return name;
+    }
+
+    // 在下一个游戏帧写入所有 routes，sink 已经销毁时什么都不做
+    void Schedule() {
+        try
+        {
+            std::weak_ptr<RoutingFileSink> weak = this->weak_from_this();
+            FrameTaskQueue::Instance().Post([weak]() {
+                if (auto sink = weak.lock())
+                {
+                    std::lock_guard<std::mutex> lock(sink->m_BatchMutex);
+                    sink->m_Scheduled = false;
+                    try
+                    {
+                        sink->WriteBatches();
+                    }
+                    catch (const std::exception &ex)
+                    {
+                        smutils->LogError(myself, "[%s] %s", SMEXT_CONF_LOGTAG, ex.what());
+                    }
+                }
+            });
+            m_Scheduled = true;
+        }
+        catch (const std::bad_alloc &)
+        {
+            // 无法安排时立即写入
+            WriteBatches();
+        }
+    }
+
+    void WriteBatches() {
+        while (!m_Dirty.empty())
+        {
+            auto route = m_Dirty.back();
+            m_Dirty.pop_back();
+            WriteRoute(*route);
+        }
+    }
+
+    void WriteRoute(Route &route) {
+        if (route.file)
+        {
+            m_OpenFiles.splice(m_OpenFiles.begin(), m_OpenFiles, route.lru);
+        }
+        else
+        {
+            if (m_OpenFiles.size() >= m_MaxOpenFiles)
+            {
+                auto oldest = m_OpenFiles.back();
+                m_OpenFiles.pop_back();
+                oldest->file.reset();               // file_helper 析构时关闭文件
+            }
+
+            try
+            {
+                auto file = std::make_unique<spdlog::details::file_helper>();
+                file->open(route.filename, false);
+                route.file = std::move(file);
+            }
+            catch (...)
+            {
+                // 写入失败的消息被丢弃，下一条消息会重新尝试打开
+                route.pending.clear();
+                throw;
+            }
+            m_OpenFiles.push_front(&route);
+            route.lru = m_OpenFiles.begin();
+        }
+
+        try
+        {
+            route.file->write(route.pending);
+        }
+        catch (...)
+        {
+            route.pending.clear();
+            throw;
+        }
+        route.pending.clear();
+    }
+};
+
+using RoutingFileSinkMT = RoutingFileSink<std::mutex>;
+using RoutingFileSinkST = RoutingFileSink<spdlog::details::null_mutex>;
+
+
+}       // namespace Sinks
+}       // namespace Log4sp
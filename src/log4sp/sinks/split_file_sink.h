@@ -0,0 +1,152 @@
+#pragma once
+
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "spdlog/details/file_helper.h"
+#include "spdlog/details/null_mutex.h"
+#include "spdlog/sinks/base_sink.h"
+
+#include "log4sp/common.h"
+
+
+namespace Log4sp {
+namespace Sinks {
+
+/**
+ * 按日志级别分流的多文件 sink
+ * 每个文件有自己的最低级别，消息只格式化一次，然后把同一份数据追加到所有级别满足的文件
+ *
+ * 相比每个文件各用一个 file sink，Logger 只需要一次 should_log 检查与一次格式化
+ * 格式化使用 sink 内部复用的缓冲区，长消息不会每次都重新分配内存
+ *
+ * sink 的级别跟随所有文件中最低的级别，Logger 缓存的 sinks 最低级别可以直接过滤掉没有文件需要的消息
+ * 一个文件写入失败不影响其他文件，所有文件写完后再抛出第一个异常
+ */
+template <typename Mutex>
+class SplitFileSink final : public spdlog::sinks::base_sink<Mutex>
+{
+    using LogMsg    = spdlog::details::log_msg;
+    using LevelEnum = spdlog::level::level_enum;
+
+public:
+    SplitFileSink() = default;
+    ~SplitFileSink() override = default;
+
+    /**
+     * @brief 添加一个文件，级别大于等于 level 的消息会写入此文件
+     *        sink 的级别被设置为所有文件中最低的级别，调用者需要更新 Logger 缓存的 sinks 最低级别
+     *
+     * @exception       文件已经添加过，或打开文件失败
+     */
+    void AddFile(const spdlog::filename_t &filename, LevelEnum level, bool truncate = false) {
+        std::lock_guard<Mutex> lock(spdlog::sinks::base_sink<Mutex>::mutex_);
+        for (const auto &file : m_Files)
+        {
+            if (file.helper->filename() == filename)
+                ThrowLog4spEx("File " + spdlog::details::os::filename_to_str(filename) + " already added");
+        }
+
+        auto helper = std::make_unique<spdlog::details::file_helper>();
+        helper->open(filename, truncate);
+        m_Files.push_back({level, std::move(helper)});
+
+        if (level < m_MinLevel)
+            m_MinLevel = level;
+        spdlog::sinks::base_sink<Mutex>::set_level(m_MinLevel);
+    }
+
+    [[nodiscard]]
+    std::size_t GetFileCount() noexcept {
+        std::lock_guard<Mutex> lock(spdlog::sinks::base_sink<Mutex>::mutex_);
+        return m_Files.size();
+    }
+
+    // index 由调用者检查
+    [[nodiscard]]
+    const spdlog::filename_t &GetFilename(std::size_t index) noexcept {
+        std::lock_guard<Mutex> lock(spdlog::sinks::base_sink<Mutex>::mutex_);
+        return m_Files[index].helper->filename();
+    }
+
+    [[nodiscard]]
+    LevelEnum GetFileLevel(std::size_t index) noexcept {
+        std::lock_guard<Mutex> lock(spdlog::sinks::base_sink<Mutex>::mutex_);
+        return m_Files[index].level;
+    }
+
+    //* @log4sp hack *//
+    [[nodiscard]] bool accepts_formatted() const override { return true; }
+
+private:
+    struct File
+    {
+        LevelEnum level;
+        std::unique_ptr<spdlog::details::file_helper> helper;
+    };
+
+    std::vector<File> m_Files;
+    LevelEnum m_MinLevel{LevelEnum::off};
+    spdlog::memory_buf_t m_Buffer;
+
+    void sink_it_(const LogMsg &msg) override {
+        // 没有文件需要这条消息时不必格式化
+        if (msg.level < m_MinLevel)
+            return;
+
+        m_Buffer.clear();
+        spdlog::sinks::base_sink<Mutex>::formatter_->format(msg, m_Buffer);
+        sink_formatted_(msg, m_Buffer);
+    }
+
+    //* @log4sp hack *//
+    void sink_formatted_(const LogMsg &msg, const spdlog::memory_buf_t &formatted) override {
+        std::exception_ptr error;
+        for (auto &file : m_Files)
+        {
+            if (msg.level < file.level)
+                continue;
+
+            try
+            {
+                file.helper->write(formatted);
+            }
+            catch (...)
+            {
+                if (!error)
+                    error = std::current_exception();
+            }
+        }
+
+        if (error)
+            std::rethrow_exception(error);
+    }
+
+    void flush_() override {
+        std::exception_ptr error;
+        for (auto &file : m_Files)
+        {
+            try
+            {
+                file.helper->flush();
+            }
+            catch (...)
+            {
+                if (!error)
+                    error = std::current_exception();
+            }
+        }
+
+        if (error)
+            std::rethrow_exception(error);
+    }
+};
+
+using SplitFileSinkMT = SplitFileSink<std::mutex>;
+using SplitFileSinkST = SplitFileSink<spdlog::details::null_mutex>;
+
+
+}       // namespace Sinks
+}       // namespace Log4sp
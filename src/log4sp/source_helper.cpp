@@ -1,4 +1,5 @@
 #include <cassert>
+#include <iterator>
 
 #include "log4sp/common.h"
 #include "log4sp/source_helper.h"
@@ -48,8 +49,7 @@ spdlog::source_loc SrcHelper::GetFromPluginCtx(SourcePawn::IPluginContext *ctx)
     return spdlog::source_loc(file, static_cast<int>(line), func);
 }
 
-[[nodiscard]]
-std::vector<std::string> SrcHelper::GetStackTrace(SourcePawn::IPluginContext *ctx) noexcept
+std::size_t SrcHelper::RenderStackTrace(SourcePawn::IPluginContext *ctx, spdlog::memory_buf_t &out)
 {
     assert(ctx);
 
@@ -57,45 +57,54 @@ std::vector<std::string> SrcHelper::GetStackTrace(SourcePawn::IPluginContext *ct
     if (iter->Done())
     {
         ctx->DestroyFrameIterator(iter);
-        return {};
+        return 0;
     }
 
-    std::vector<std::string> trace{"Call stack trace:"};
+    using spdlog::fmt_lib::format_to;
+    auto it = std::back_inserter(out);
+    std::size_t lines = 0;
 
-    for (int index = 0; !iter->Done(); iter->Next(), ++index)
+    try
     {
-        using spdlog::fmt_lib::format;
-
-        if (iter->IsNativeFrame())
-        {
-            const char *func = iter->FunctionName();
-            if (!func)
-            {
-                func = "<unknown function>";
-            }
-
-            trace.emplace_back(format("  [{}] {}", index, func));
-        }
-        else if (iter->IsScriptedFrame())
+        for (int index = 0; !iter->Done(); iter->Next(), ++index)
         {
-            const char *func = iter->FunctionName();
-            if (!func)
+            if (iter->IsNativeFrame())
             {
-                func = "<unknown function>";
+                const char *func = iter->FunctionName();
+                if (!func)
+                {
+                    func = "<unknown function>";
+                }
+
+                format_to(it, "  [{}] {}\n", index, func);
+                ++lines;
             }
-
-            const char *file = iter->FilePath();
-            if (!file)
+            else if (iter->IsScriptedFrame())
             {
-                file = "<unknown>";
+                const char *func = iter->FunctionName();
+                const char *file = iter->FilePath();
+                if (!func)
+                {
+                    func = "<unknown function>";
+                }
+                if (!file)
+                {
+                    file = "<unknown>";
+                }
+
+                format_to(it, "  [{}] Line {}, {}::{}\n", index, iter->LineNumber(), file, func);
+                ++lines;
             }
-
-            trace.emplace_back(format("  [{}] Line {}, {}::{}", index, iter->LineNumber(), file, func));
         }
     }
+    catch (...)
+    {
+        ctx->DestroyFrameIterator(iter);
+        throw;
+    }
 
     ctx->DestroyFrameIterator(iter);
-    return trace;
+    return lines;
 }
 
 // ErrHelper
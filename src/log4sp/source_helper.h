@@ -1,6 +1,6 @@
 #pragma once
 
-#include <vector>
+#include <cstddef>
 
 #include "spdlog/common.h"
 
@@ -33,14 +33,43 @@ public:
     }
 
     [[nodiscard]] spdlog::source_loc Get() const noexcept;
+    [[nodiscard]] SourcePawn::IPluginContext *GetCtx() const noexcept { return m_Ctx; }
     [[nodiscard]] static spdlog::source_loc GetFromPluginCtx(SourcePawn::IPluginContext *ctx) noexcept;
-    [[nodiscard]] static std::vector<std::string> GetStackTrace(SourcePawn::IPluginContext *ctx) noexcept;
+
+    /**
+     * 将调用栈的每一帧追加到 out，每行以 '\n' 结尾，不包括 "Call stack trace:" 标题
+     * 渲染过程不分配额外的字符串
+     *
+     * @return          追加的帧数，没有调用栈时返回 0
+     */
+    static std::size_t RenderStackTrace(SourcePawn::IPluginContext *ctx, spdlog::memory_buf_t &out);
 
 private:
     mutable spdlog::source_loc m_Loc;
     SourcePawn::IPluginContext *m_Ctx;
 };
 
+/**
+ * 同步写入 sinks 期间记录调用 native 的插件，供按插件区分消息的 sink 使用 (例如 RoutingFileSink)
+ *
+ * 每个线程各自记录，异步 Logger 的工作线程中总是 nullptr
+ */
+class CallerScope final
+{
+public:
+    explicit CallerScope(SourcePawn::IPluginContext *ctx) noexcept : m_Prev(s_Current) { s_Current = ctx; }
+    ~CallerScope() noexcept { s_Current = m_Prev; }
+
+    CallerScope(const CallerScope &) = delete;
+    CallerScope &operator=(const CallerScope &) = delete;
+
+    [[nodiscard]] static SourcePawn::IPluginContext *Current() noexcept { return s_Current; }
+
+private:
+    SourcePawn::IPluginContext *m_Prev;
+    static inline thread_local SourcePawn::IPluginContext *s_Current{nullptr};
+};
+
 class ErrHelper final
 {
 public:
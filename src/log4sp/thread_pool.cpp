@@ -0,0 +1,233 @@
+#include <cassert>
+#include <cstring>
+
+#include "log4sp/logger.h"
+#include "log4sp/thread_pool.h"
+
+
+namespace Log4sp {
+
+AsyncMsg::AsyncMsg(AsyncMsgType type, const LogMsg &msg)
+    : LogMsg{msg}, m_Type(type), m_HasFilename(msg.source.filename), m_HasFuncname(msg.source.funcname)
+{
+    m_Buffer.append(logger_name.begin(), logger_name.end());
+    m_Buffer.append(payload.begin(), payload.end());
+
+    if (m_HasFilename)
+        m_Buffer.append(source.filename, source.filename + std::strlen(source.filename) + 1);
+
+    if (m_HasFuncname)
+        m_Buffer.append(source.funcname, source.funcname + std::strlen(source.funcname) + 1);
+
+    UpdateStringViews();
+}
+
+AsyncMsg::AsyncMsg(AsyncMsg &&other) noexcept
+    : LogMsg{other},
+      m_Type(other.m_Type),
+      m_Buffer(std::move(other.m_Buffer)),
+      m_HasFilename(other.m_HasFilename),
+      m_HasFuncname(other.m_HasFuncname)
+{
+    UpdateStringViews();
+}
+
+AsyncMsg &AsyncMsg::operator=(AsyncMsg &&other) noexcept
+{
+    LogMsg::operator=(other);
+    m_Type = other.m_Type;
+    m_Buffer = std::move(other.m_Buffer);
+    m_HasFilename = other.m_HasFilename;
+    m_HasFuncname = other.m_HasFuncname;
+    UpdateStringViews();
+    return *this;
+}
+
+void AsyncMsg::UpdateStringViews() noexcept
+{
+    const char *data = m_Buffer.data();
+    logger_name = spdlog::string_view_t{data, logger_name.size()};
+    payload = spdlog::string_view_t{data + logger_name.size(), payload.size()};
+
+    const char *iter = data + logger_name.size() + payload.size();
+    if (m_HasFilename)
+    {
+        source.filename = iter;
+        iter += std::strlen(iter) + 1;
+    }
+
+    if (m_HasFuncname)
+    {
+        source.funcname = iter;
+    }
+}
+
+
+ThreadPool::ThreadPool(Logger &logger, std::size_t queueSize, OverflowPolicy policy)
+    : m_Logger(logger), m_Policy(policy), m_Queue(queueSize)
+{
+    assert(queueSize > 0 && queueSize <= MaxQueueSize);
+    m_Thread = std::thread(&ThreadPool::WorkerLoop, this);
+}
+
+ThreadPool::~ThreadPool() noexcept
+{
+    try
+    {
+        // 即使策略不是 Block，也必须保证结束消息入队
+        m_Queue.enqueue(AsyncMsg(AsyncMsgType::Terminate));
+        m_Thread.join();
+    }
+    catch (...)
+    {
+        // 不能让异常离开析构函数
+    }
+}
+
+void ThreadPool::PostLog(const LogMsg &msg, bool flush)
+{
+    if (PostAsyncMsg(AsyncMsg(AsyncMsgType::Log, msg)))
+    {
+        m_Enqueued.fetch_add(1, std::memory_order_relaxed);
+    }
+    else
+    {
+        m_Dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    if (flush)
+        PostFlush();
+}
+
+void ThreadPool::PostFlush()
+{
+    // 刷新请求不能被丢弃
+    // OverwriteOldest 策略下直接覆盖最旧的消息，之后它自己被覆盖时由 PostAsyncMsg 转为 m_PendingFlush
+    // DropNewest 策略下不能等待空位 (会阻塞主线程)，队列已满时同样转为 m_PendingFlush
+    switch (m_Policy)
+    {
+    case OverflowPolicy::Block:
+    case OverflowPolicy::OverwriteOldest:
+        PostAsyncMsg(AsyncMsg(AsyncMsgType::Flush));
+        return;
+
+    case OverflowPolicy::DropNewest:
+    {
+        if (PostAsyncMsg(AsyncMsg(AsyncMsgType::Flush)))
+            return;
+
+        // 队列已满: 工作线程处理完目前已入队的最后一条消息后刷新
+        std::uint64_t target = m_Posted;
+        m_FlushTarget.store(target);
+
+        // 设置目标之前工作线程可能已经处理完了所有消息，此时队列为空，由主线程补发刷新请求
+        // 两个线程都发现目标已达到时，只有 CAS 成功的一方执行刷新
+        if (m_Processed.load() >= target && m_FlushTarget.compare_exchange_strong(target, 0))
+            PostAsyncMsg(AsyncMsg(AsyncMsgType::Flush));
+        return;
+    }
+    }
+}
+
+QueueStats ThreadPool::GetStats() const noexcept
+{
+    QueueStats stats;
+    stats.enqueued    = m_Enqueued.load(std::memory_order_relaxed);
+    stats.dropped     = m_Dropped.load(std::memory_order_relaxed);
+    stats.overwritten = m_Overwritten.load(std::memory_order_relaxed);
+    stats.highWater   = m_HighWater.load(std::memory_order_relaxed);
+    return stats;
+}
+
+std::size_t ThreadPool::PostAsyncMsg(AsyncMsg &&msg)
+{
+    std::size_t depth = 0;
+
+    switch (m_Policy)
+    {
+    case OverflowPolicy::Block:
+        depth = m_Queue.log4sp_enqueue(std::move(msg));
+        break;
+
+    case OverflowPolicy::DropNewest:
+        depth = m_Queue.log4sp_enqueue_if_have_room(std::move(msg));
+        if (depth)
+            ++m_Posted;
+        break;
+
+    case OverflowPolicy::OverwriteOldest:
+    {
+        bool overrun = false;
+        AsyncMsg overwritten;
+        depth = m_Queue.log4sp_enqueue_nowait(std::move(msg), overwritten, overrun);
+        if (!overrun)
+            break;
+
+        if (overwritten.Type() == AsyncMsgType::Flush)
+        {
+            // 被覆盖的刷新请求位于队首，它之前的消息都已写入，由工作线程在下一条消息之后刷新
+            m_PendingFlush.store(true, std::memory_order_release);
+        }
+        else
+        {
+            m_Overwritten.fetch_add(1, std::memory_order_relaxed);
+        }
+        break;
+    }
+    }
+
+    UpdateHighWater(depth);
+    return depth;
+}
+
+void ThreadPool::UpdateHighWater(std::size_t depth) noexcept
+{
+    // 只有主线程写入，不需要 CAS
+    if (depth > m_HighWater.load(std::memory_order_relaxed))
+        m_HighWater.store(depth, std::memory_order_relaxed);
+}
+
+void ThreadPool::WorkerLoop() noexcept
+{
+    while (ProcessNextMsg()) {}
+}
+
+bool ThreadPool::ProcessNextMsg() noexcept
+{
+    AsyncMsg msg;
+    m_Queue.dequeue(msg);
+    m_Processed.fetch_add(1);
+
+    switch (msg.Type())
+    {
+    case AsyncMsgType::Log:
+        m_Logger.BackendSinkIt(msg);
+        // 使用 | 而不是 ||: 两种刷新请求都需要清除
+        if (m_PendingFlush.exchange(false, std::memory_order_acquire) | ReachFlushTarget())
+            m_Logger.BackendFlush();
+        return true;
+
+    case AsyncMsgType::Flush:
+        m_PendingFlush.store(false, std::memory_order_relaxed);
+        (void)ReachFlushTarget();
+        m_Logger.BackendFlush();
+        return true;
+
+    case AsyncMsgType::Terminate:
+        return false;
+    }
+
+    assert(false);
+    return true;
+}
+
+bool ThreadPool::ReachFlushTarget() noexcept
+{
+    std::uint64_t target = m_FlushTarget.load();
+    return target != 0 && m_Processed.load(std::memory_order_relaxed) >= target &&
+           m_FlushTarget.compare_exchange_strong(target, 0);
+}
+
+
+}       // namespace Log4sp
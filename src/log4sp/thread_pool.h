@@ -0,0 +1,142 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+
+#include "spdlog/details/log_msg.h"
+#include "spdlog/details/mpmc_blocking_q.h"
+
+
+namespace Log4sp {
+
+class Logger;
+
+// 队列已满时的处理策略
+enum class OverflowPolicy
+{
+    Block,              // 等待工作线程腾出空位
+    DropNewest,         // 丢弃新消息
+    OverwriteOldest     // 覆盖队列中最旧的消息
+};
+
+// 队列的统计数据，由主线程写入，任意线程读取
+struct QueueStats
+{
+    std::size_t enqueued{0};        // 成功入队的日志消息数量 (包括之后被覆盖的)
+    std::size_t dropped{0};         // DropNewest 策略下被丢弃的日志消息数量
+    std::size_t overwritten{0};     // OverwriteOldest 策略下被覆盖的日志消息数量 (不包括刷新请求)
+    std::size_t highWater{0};       // 队列长度的最大值
+};
+
+enum class AsyncMsgType
+{
+    Log,
+    Flush,
+    Terminate
+};
+
+/**
+ * spdlog 的 async_msg 绑定了 spdlog::async_logger，不适用于 Log4sp::Logger，所以参考它重新实现
+ *
+ * 与 spdlog::details::log_msg_buffer 不同，source_loc 的 filename 和 funcname 也会被拷贝
+ * 因为它们可能指向插件的内存 (例如 LogLoc 的参数)，工作线程处理时可能已经失效
+ */
+class AsyncMsg final : public spdlog::details::log_msg
+{
+public:
+    using LogMsg = spdlog::details::log_msg;
+
+    AsyncMsg() = default;
+    explicit AsyncMsg(AsyncMsgType type) noexcept : m_Type(type) {}
+    AsyncMsg(AsyncMsgType type, const LogMsg &msg);
+
+    // should only be moved in or out of the queue..
+    AsyncMsg(const AsyncMsg &) = delete;
+    AsyncMsg &operator=(const AsyncMsg &) = delete;
+    AsyncMsg(AsyncMsg &&other) noexcept;
+    AsyncMsg &operator=(AsyncMsg &&other) noexcept;
+
+    [[nodiscard]] AsyncMsgType Type() const noexcept { return m_Type; }
+
+private:
+    void UpdateStringViews() noexcept;
+
+    AsyncMsgType m_Type{AsyncMsgType::Log};
+    spdlog::memory_buf_t m_Buffer;
+    bool m_HasFilename{false};
+    bool m_HasFuncname{false};
+};
+
+/**
+ * 异步 Logger 的后端
+ * 主线程只负责将消息拷贝进预分配的队列，由专属的工作线程调用 sinks 完成 pattern 格式化与文件 I/O
+ */
+class ThreadPool final
+{
+public:
+    using LogMsg    = spdlog::details::log_msg;
+    using QueueType = spdlog::details::mpmc_blocking_queue<AsyncMsg>;
+
+    static constexpr std::size_t DefaultQueueSize = 8192;
+    static constexpr std::size_t MaxQueueSize     = 1024 * 1024;
+
+    /**
+     * @param logger    工作线程处理消息时使用的 logger，其生命周期必须长于 ThreadPool
+     * @param queueSize 队列最多可以容纳的消息数量
+     * @param policy    队列已满时的处理策略
+     * @exception       创建线程失败
+     */
+    ThreadPool(Logger &logger, std::size_t queueSize, OverflowPolicy policy = OverflowPolicy::Block);
+
+    // 等待工作线程处理完队列中剩余的消息
+    ~ThreadPool() noexcept;
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    void PostLog(const LogMsg &msg, bool flush);
+
+    // 刷新请求不会被溢出策略丢弃
+    // 队列已满时: Block 策略等待一个空位，OverwriteOldest 策略覆盖最旧的消息
+    //            DropNewest 策略不等待，由工作线程在处理完当前队列中的消息后刷新
+    void PostFlush();
+
+    [[nodiscard]] OverflowPolicy GetOverflowPolicy() const noexcept { return m_Policy; }
+
+    [[nodiscard]] QueueStats GetStats() const noexcept;
+
+private:
+    // 返回入队后的队列长度，消息被丢弃时返回 0
+    std::size_t PostAsyncMsg(AsyncMsg &&msg);
+    void UpdateHighWater(std::size_t depth) noexcept;
+    void WorkerLoop() noexcept;
+    bool ProcessNextMsg() noexcept;
+
+    // 工作线程已处理到 DropNewest 策略记录的刷新目标时返回 true，并清除目标
+    [[nodiscard]] bool ReachFlushTarget() noexcept;
+
+    Logger &m_Logger;
+    const OverflowPolicy m_Policy;
+    QueueType m_Queue;
+
+    // 只有主线程 (生产者) 会修改计数器，relaxed 即可
+    std::atomic<std::size_t> m_Enqueued{0};
+    std::atomic<std::size_t> m_Dropped{0};
+    std::atomic<std::size_t> m_Overwritten{0};
+    std::atomic<std::size_t> m_HighWater{0};
+
+    // OverwriteOldest 策略下刷新请求被覆盖时置为 true，工作线程处理下一条消息后刷新
+    std::atomic<bool> m_PendingFlush{false};
+
+    // DropNewest 策略下刷新请求无法入队时，记录当时已入队的消息数量，工作线程处理到这条消息后刷新 (0 表示没有)
+    // m_FlushTarget 与 m_Processed 使用 seq_cst，保证主线程与工作线程至少有一方发现目标已达到
+    std::uint64_t m_Posted = 0;                     // 只由主线程访问
+    std::atomic<std::uint64_t> m_Processed{0};
+    std::atomic<std::uint64_t> m_FlushTarget{0};
+
+    std::thread m_Thread;
+};
+
+
+}       // namespace Log4sp
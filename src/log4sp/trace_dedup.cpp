@@ -0,0 +1,48 @@
+#include <algorithm>
+#include <functional>
+
+#include "log4sp/trace_dedup.h"
+
+
+namespace Log4sp {
+
+[[nodiscard]]
+TraceDedup::Result TraceDedup::Check(std::string_view frames, Clock::time_point now)
+{
+    auto fingerprint = std::hash<std::string_view>{}(frames);
+    auto id = static_cast<std::uint32_t>(fingerprint ^ (static_cast<std::uint64_t>(fingerprint) >> 32));
+
+    auto found = m_Traces.find(fingerprint);
+    if (found == m_Traces.end())
+    {
+        if (m_Traces.size() >= m_MaxTraces)
+            EvictOldest();
+
+        m_Traces.emplace(fingerprint, Entry{1, now, now});
+        return {id, 1, true};
+    }
+
+    auto &entry = found->second;
+    ++entry.seen;
+    entry.lastSeen = now;
+
+    if (now - entry.lastFull >= m_Window)
+    {
+        entry.lastFull = now;
+        return {id, entry.seen, true};
+    }
+    return {id, entry.seen, false};
+}
+
+void TraceDedup::EvictOldest() noexcept
+{
+    // 只在出现新的指纹且表已满时执行，线性查找即可
+    auto oldest = std::min_element(m_Traces.begin(), m_Traces.end(), [](const auto &a, const auto &b) {
+        return a.second.lastSeen < b.second.lastSeen;
+    });
+    if (oldest != m_Traces.end())
+        m_Traces.erase(oldest);
+}
+
+
+}       // namespace Log4sp
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string_view>
+#include <unordered_map>
+
+
+namespace Log4sp {
+
+/**
+ * 调用栈去重
+ *
+ * 以调用栈文本 (所有帧) 的哈希值作为指纹，同一个调用路径在窗口时间内只输出一次完整的调用栈
+ * 之后的重复只输出一行 "stack trace #id (seen N times)"，窗口结束后再次输出完整的调用栈
+ *
+ * 指纹表的容量有上限，满时淘汰最久没有出现的指纹
+ *
+ * 只能在主线程使用
+ */
+class TraceDedup final
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    struct Result
+    {
+        std::uint32_t id;           // 指纹的短 id，用于关联完整的调用栈与之后的重复
+        std::uint64_t seen;         // 包括本次在内出现的次数
+        bool full;                  // true 表示需要输出完整的调用栈
+    };
+
+    TraceDedup(std::chrono::milliseconds window, std::size_t maxTraces) noexcept
+        : m_Window(window), m_MaxTraces(maxTraces != 0 ? maxTraces : 1) {}
+
+    [[nodiscard]] std::chrono::milliseconds GetWindow() const noexcept { return m_Window; }
+    [[nodiscard]] std::size_t GetMaxTraces() const noexcept            { return m_MaxTraces; }
+
+    /**
+     * @brief 记录一次调用栈
+     *
+     * @param frames    调用栈文本
+     * @return          指纹 id、出现次数以及是否需要输出完整的调用栈
+     */
+    [[nodiscard]]
+    Result Check(std::string_view frames, Clock::time_point now);
+
+private:
+    struct Entry
+    {
+        std::uint64_t seen;
+        Clock::time_point lastFull;     // 上次输出完整调用栈的时间
+        Clock::time_point lastSeen;
+    };
+
+    void EvictOldest() noexcept;
+
+    std::chrono::milliseconds m_Window;
+    std::size_t m_MaxTraces;
+    std::unordered_map<std::size_t, Entry> m_Traces;
+};
+
+
+}       // namespace Log4sp
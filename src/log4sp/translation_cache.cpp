@@ -0,0 +1,188 @@
+#include <algorithm>
+#include <cassert>
+#include <filesystem>
+#include <system_error>
+
+#include "log4sp/common.h"
+#include "log4sp/translation_cache.h"
+
+
+namespace Log4sp {
+
+[[nodiscard]]
+TranslationCache &TranslationCache::Instance() noexcept
+{
+    static TranslationCache instance;
+    return instance;
+}
+
+void TranslationCache::Initialize() noexcept
+{
+    plsys->AddPluginsListener(&Instance());
+}
+
+void TranslationCache::Destroy() noexcept
+{
+    plsys->RemovePluginsListener(&Instance());
+    Instance().Clear();
+}
+
+[[nodiscard]]
+const TranslationCache::Entry *TranslationCache::Find(SourcePawn::IPluginContext *ctx, SourceMod::IPhraseCollection **phrases,
+                                                      const char *key, unsigned int langid, unsigned int serverLangid)
+{
+    auto found = m_Plugins.find(ctx);
+    if (found == m_Plugins.end())
+    {
+        auto phrasesPtr = PluginSysFindPluginByCtx(ctx)->GetPhrases();
+        found = m_Plugins.emplace(ctx, PluginCache{phrasesPtr, phrasesPtr->GetFileCount(), 0, m_CheckRound, {}, {}}).first;
+        found->second.fileStamp = GetFileStamp(found->second);
+    }
+
+    auto &cache = found->second;
+    *phrases = cache.phrases;
+
+    // sm_reload_translations 重新解析了被修改的翻译文件
+    if (cache.checkedRound != m_CheckRound)
+    {
+        cache.checkedRound = m_CheckRound;
+        if (auto fileStamp = GetFileStamp(cache); fileStamp != cache.fileStamp)
+        {
+            cache.fileStamp = fileStamp;
+            cache.byKey.clear();
+            return nullptr;
+        }
+    }
+
+    // LoadTranslations 之后，之前回退到其他语言的短语可能有了更合适的翻译
+    if (auto fileCount = cache.phrases->GetFileCount(); fileCount != cache.fileCount)
+    {
+        cache.fileCount = fileCount;
+        cache.byKey.clear();
+        return nullptr;
+    }
+
+    auto phraseEntries = cache.byKey.find(key);
+    if (phraseEntries == cache.byKey.end())
+        return nullptr;
+
+    for (const auto &entry : phraseEntries->second->entries)
+    {
+        if (entry.langid == langid && entry.serverLangid == serverLangid)
+            return &entry;
+    }
+    return nullptr;
+}
+
+const TranslationCache::Entry &TranslationCache::Insert(SourcePawn::IPluginContext *ctx, const char *key,
+                                                        unsigned int langid, unsigned int serverLangid, const SourceMod::Translation &trans)
+{
+    auto found = m_Plugins.find(ctx);
+    assert(found != m_Plugins.end());
+
+    auto &cache = found->second;
+    bool newLang = false;
+    for (auto id : {langid, serverLangid})
+    {
+        if (std::find(cache.langids.begin(), cache.langids.end(), id) == cache.langids.end())
+        {
+            cache.langids.push_back(id);
+            newLang = true;
+        }
+    }
+
+    // 新语言的翻译文件也需要检查，避免下一次检查误判为文件被修改
+    if (newLang)
+        cache.fileStamp = GetFileStamp(cache);
+
+    auto &byKey = cache.byKey;
+    auto phraseEntries = byKey.find(key);
+    if (phraseEntries == byKey.end())
+    {
+        auto entries = std::make_unique<PhraseEntries>();
+        entries->key = key;
+        std::string_view view = entries->key;
+        phraseEntries = byKey.emplace(view, std::move(entries)).first;
+    }
+
+    assert(trans.fmt_count <= MAX_TRANSLATE_PARAMS);
+
+    Entry entry;
+    entry.langid = langid;
+    entry.serverLangid = serverLangid;
+    entry.phrase = trans.szPhrase;
+    entry.fmtCount = trans.fmt_count;
+    entry.inOrder = true;
+    for (unsigned int i = 0; i < trans.fmt_count; ++i)
+    {
+        entry.fmtOrder[i] = trans.fmt_order[i];
+        entry.inOrder &= (trans.fmt_order[i] == static_cast<int>(i));
+    }
+
+    // 每个短语只有少量语言，线性查找即可
+    auto &entries = phraseEntries->second->entries;
+    return entries.emplace_back(std::move(entry));
+}
+
+void TranslationCache::Clear() noexcept
+{
+    m_Plugins.clear();
+}
+
+void TranslationCache::RunFrame() noexcept
+{
+    auto now = Clock::now();
+    if (now < m_NextCheck)
+        return;
+
+    m_NextCheck = now + FileCheckInterval;
+    ++m_CheckRound;
+}
+
+[[nodiscard]]
+std::uint64_t TranslationCache::GetFileStamp(const PluginCache &cache) noexcept
+{
+    char path[PLATFORM_MAX_PATH];
+    std::uint64_t stamp = 0;
+
+    auto addFile = [&stamp, &path]() noexcept {
+        std::error_code ec;
+        auto time = std::filesystem::last_write_time(path, ec);
+        if (ec)
+            return;
+
+        auto size = std::filesystem::file_size(path, ec);
+        stamp += static_cast<std::uint64_t>(time.time_since_epoch().count()) + (ec ? 0 : size);
+    };
+
+    // sm_reload_translations 也会重新解析语言列表
+    smutils->BuildPath(SourceMod::Path_SM, path, sizeof(path), "configs/languages.cfg");
+    addFile();
+
+    for (unsigned int i = 0, count = cache.phrases->GetFileCount(); i < count; ++i)
+    {
+        const char *file = cache.phrases->GetFile(i)->GetFilename();
+
+        smutils->BuildPath(SourceMod::Path_SM, path, sizeof(path), "translations/%s.txt", file);
+        addFile();
+
+        for (auto langid : cache.langids)
+        {
+            const char *code, *name;
+            if (!translator->GetLanguageInfo(langid, &code, &name))
+                continue;
+
+            smutils->BuildPath(SourceMod::Path_SM, path, sizeof(path), "translations/%s/%s.txt", code, file);
+            addFile();
+        }
+    }
+    return stamp;
+}
+
+void TranslationCache::OnPluginUnloaded(SourceMod::IPlugin *plugin)
+{
+    m_Plugins.erase(plugin->GetBaseContext());
+}
+
+
+}       // namespace Log4sp
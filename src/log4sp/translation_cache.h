@@ -0,0 +1,143 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "extension.h"
+
+
+namespace Log4sp {
+
+/**
+ * %T / %t 的翻译查找缓存
+ *
+ * 每次翻译都需要查找插件、获取 phrases、最多三次 FindTranslation (客户端语言 -> 服务器语言 -> 英语)
+ * 日志中的翻译短语通常是固定的少量几个，所以按插件缓存 (短语, 请求语言, 服务器语言) 的查找结果
+ *
+ * 缓存保存的是短语与参数顺序的拷贝，而不是 SourceMod 内部字符串表的指针
+ * 因为 sm_reload_translations 与换图时的重新解析会重用或重新分配那块内存
+ *
+ * 失效时机:
+ *  - 插件卸载时，移除该插件的缓存
+ *  - 插件加载了新的翻译文件 (phrases 的文件数量改变) 时，清空该插件的缓存
+ *  - 翻译文件被修改 (sm_reload_translations 会重新解析) 时，清空该插件的缓存
+ *    SourceMod 没有提供重新解析翻译文件的通知 (扩展不依赖 SDK，也无法拦截 sm_reload_translations)
+ *    所以每秒最多比较一次翻译文件的修改时间与大小，文件被修改但未重新加载时多清空一次缓存也不会出错
+ *  - 地图结束时 (下一张地图开始前 SourceMod 会重新解析翻译文件)，清空所有缓存
+ *
+ * 只能在主线程使用
+ */
+class TranslationCache final : public SourceMod::IPluginsListener
+{
+public:
+    // 查找成功的翻译
+    struct Entry
+    {
+        unsigned int langid;                        // 请求的语言
+        unsigned int serverLangid;                  // 查找时的服务器语言 (回退时使用)
+        std::string phrase;
+        unsigned int fmtCount;
+        int fmtOrder[MAX_TRANSLATE_PARAMS];
+        bool inOrder;                               // 参数顺序不需要调整
+    };
+
+    /**
+     * @brief 全局单例对象
+     */
+    [[nodiscard]]
+    static TranslationCache &Instance() noexcept;
+
+    /**
+     * @brief 用于 SDK_OnLoad 时注册插件监听器。
+     * @note  需要与 Destroy 配对使用。
+     */
+    static void Initialize() noexcept;
+
+    /**
+     * @brief 用于 SDK_OnUnload 时移除插件监听器并清空缓存。
+     */
+    static void Destroy() noexcept;
+
+    /**
+     * @brief 查找插件的翻译缓存
+     *
+     * @param ctx           插件上下文
+     * @param phrases       [out] 插件的 phrases，未命中时可以用于查找翻译
+     * @param key           短语
+     * @param langid        请求的语言
+     * @param serverLangid  当前服务器语言
+     * @return              缓存的翻译，未命中时返回 nullptr
+     */
+    [[nodiscard]]
+    const Entry *Find(SourcePawn::IPluginContext *ctx, SourceMod::IPhraseCollection **phrases,
+                      const char *key, unsigned int langid, unsigned int serverLangid);
+
+    /**
+     * @brief 缓存查找成功的翻译，需要先调用 Find
+     *
+     * @return              缓存的翻译
+     */
+    const Entry &Insert(SourcePawn::IPluginContext *ctx, const char *key,
+                        unsigned int langid, unsigned int serverLangid, const SourceMod::Translation &trans);
+
+    /**
+     * @brief 清空所有插件的缓存
+     */
+    void Clear() noexcept;
+
+    /**
+     * @brief 每帧调用，每隔 FileCheckInterval 使下一次命中时重新检查翻译文件是否被修改
+     */
+    void RunFrame() noexcept;
+
+    // IPluginsListener
+    void OnPluginUnloaded(SourceMod::IPlugin *plugin) override;
+
+    TranslationCache(const TranslationCache &) = delete;
+    TranslationCache &operator=(const TranslationCache &) = delete;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    // 检查翻译文件的最小间隔，每次检查需要 stat 插件的所有翻译文件
+    static constexpr auto FileCheckInterval = std::chrono::seconds(1);
+
+    TranslationCache() = default;
+    ~TranslationCache() = default;
+
+    // 同一个短语在不同语言下的查找结果
+    struct PhraseEntries
+    {
+        std::string key;
+        std::deque<Entry> entries;                  // 翻译短语可能嵌套 %t，插入时不能使已返回的 Entry 失效
+    };
+
+    struct PluginCache
+    {
+        SourceMod::IPhraseCollection *phrases;
+        unsigned int fileCount;
+        std::uint64_t fileStamp;                    // 翻译文件的修改时间与大小
+        unsigned int checkedRound;                  // 最后一次检查 fileStamp 的轮次
+        std::vector<unsigned int> langids;          // 缓存中出现过的语言，只检查这些语言的翻译文件
+        std::unordered_map<std::string_view, std::unique_ptr<PhraseEntries>> byKey;    // key 指向 PhraseEntries::key
+    };
+
+    /**
+     * @brief 计算插件所有翻译文件 (以及 languages.cfg) 的修改时间与大小之和
+     */
+    [[nodiscard]]
+    static std::uint64_t GetFileStamp(const PluginCache &cache) noexcept;
+
+    std::unordered_map<SourcePawn::IPluginContext *, PluginCache> m_Plugins;
+    unsigned int m_CheckRound{0};                   // 每隔 FileCheckInterval 增加 1
+    Clock::time_point m_NextCheck{};
+};
+
+
+}       // namespace Log4sp
@@ -24,6 +24,22 @@
     }
 
 
+/**
+ * 异步 Logger 的 sinks 只能由它的工作线程写入
+ * 所以异步 Logger 不能使用其他 logger 的 sinks，其他 logger 也不能使用异步 Logger 的 sinks
+ *
+ * @param logger    sink 将要添加到的 logger，创建 logger 时为 nullptr
+ * @param async     logger 是否为异步 Logger
+ * @return          true 表示可以添加
+ */
+[[nodiscard]]
+static bool CanAttachSink(const Log4sp::Logger *logger, bool async, spdlog::sinks::sink *sink) noexcept
+{
+    auto &handler = Log4sp::LoggerHandler::Instance();
+    return async ? !handler.IsSinkUsedByOthers(sink, logger) : !handler.IsAsyncSink(sink);
+}
+
+
 static cell_t Logger(SourcePawn::IPluginContext *ctx, const cell_t *params) noexcept
 {
     char *name;
@@ -76,6 +92,12 @@ static cell_t CreateLoggerWith(SourcePawn::IPluginContext *ctx, const cell_t *pa
             return BAD_HANDLE;
         }
 
+        if (!CanAttachSink(nullptr, false, sink.get()))
+        {
+            ctx->ReportError("Sink %x (index: %d) cannot be shared between an asynchronous logger and other loggers.", sinks[i], i);
+            return BAD_HANDLE;
+        }
+
         sinkVector[i] = sink;
     }
 
@@ -118,6 +140,12 @@ static cell_t CreateLoggerWithEx(SourcePawn::IPluginContext *ctx, const cell_t *
             return BAD_HANDLE;
         }
 
+        if (!CanAttachSink(nullptr, false, sink.get()))
+        {
+            ctx->ReportError("Sink %x (index: %d) cannot be shared between an asynchronous logger and other loggers.", sinks[i], i);
+            return BAD_HANDLE;
+        }
+
         sinkVector[i] = sink;
     }
 
@@ -136,6 +164,87 @@ static cell_t CreateLoggerWithEx(SourcePawn::IPluginContext *ctx, const cell_t *
     return handle;
 }
 
+static cell_t CreateAsyncLogger(SourcePawn::IPluginContext *ctx, const cell_t *params) noexcept
+{
+    char *name;
+    CTX_LOCAL_TO_STRING(params[1], &name);
+    if (Log4sp::LoggerHandler::Instance().FindHandle(name))
+    {
+        ctx->ReportError("Logger with name \"%s\" already exists.", name);
+        return BAD_HANDLE;
+    }
+
+    cell_t *sinks;
+    CTX_LOCAL_TO_PHYS_ADDR(params[2], &sinks);
+
+    using spdlog::sink_ptr;
+    int numSinks = params[3];
+    std::vector<sink_ptr> sinkVector(numSinks, nullptr);
+
+    int queueSize = params[4];
+    if (queueSize <= 0 || static_cast<std::size_t>(queueSize) > Log4sp::ThreadPool::MaxQueueSize)
+    {
+        ctx->ReportError("Invalid queueSize %d. (1-%d)", queueSize, static_cast<int>(Log4sp::ThreadPool::MaxQueueSize));
+        return BAD_HANDLE;
+    }
+
+    int policy = params[5];
+    if (policy < static_cast<int>(Log4sp::OverflowPolicy::Block) || policy > static_cast<int>(Log4sp::OverflowPolicy::OverwriteOldest))
+    {
+        ctx->ReportError("Invalid overflow policy %d. (%d-%d)", policy,
+                         static_cast<int>(Log4sp::OverflowPolicy::Block), static_cast<int>(Log4sp::OverflowPolicy::OverwriteOldest));
+        return BAD_HANDLE;
+    }
+
+    SourceMod::HandleSecurity security(ctx->GetIdentity(), myself->GetIdentity());
+    SourceMod::HandleError error;
+
+    for (int i = 0; i < numSinks; ++i)
+    {
+        auto sink = Log4sp::SinkHandler::Instance().ReadHandle(sinks[i], &security, &error);
+        if (!sink)
+        {
+            ctx->ReportError("Invalid Sink Handle %x (index: %d, error code: %d)", sinks[i], i, error);
+            return BAD_HANDLE;
+        }
+
+        if (!CanAttachSink(nullptr, true, sink.get()))
+        {
+            ctx->ReportError("Sink %x (index: %d) cannot be shared between an asynchronous logger and other loggers.", sinks[i], i);
+            return BAD_HANDLE;
+        }
+
+        sinkVector[i] = sink;
+    }
+
+    std::shared_ptr<Log4sp::Logger> logger;
+    try
+    {
+        Log4sp::Logger::AsyncOptions options;
+        options.queueSize = static_cast<std::size_t>(queueSize);
+        options.policy    = static_cast<Log4sp::OverflowPolicy>(policy);
+        logger = std::make_shared<Log4sp::Logger>(name, options);
+    }
+    catch (const std::exception &ex)
+    {
+        ctx->ReportError(ex.what());
+        return BAD_HANDLE;
+    }
+
+    for (auto &sink : sinkVector)
+    {
+        logger->AddSink(sink);
+    }
+
+    auto handle = Log4sp::LoggerHandler::Instance().CreateHandle(logger, &security, nullptr, &error);
+    if (!handle)
+    {
+        ctx->ReportError("Failed to creates a Logger Handle (error code: %d)", error);
+        return BAD_HANDLE;
+    }
+    return handle;
+}
+
 static cell_t Get(SourcePawn::IPluginContext *ctx, const cell_t *params) noexcept
 {
     char *name;
@@ -204,6 +313,21 @@ static cell_t SetLevel(SourcePawn::IPluginContext *ctx, const cell_t *params) no
     return 0;
 }
 
+static cell_t ResetLevel(SourcePawn::IPluginContext *ctx, const cell_t *params) noexcept
+{
+    READ_LOGGER_HANDLE_OR_ERROR(params[1]);
+
+    logger->ResetLevel();
+    return 0;
+}
+
+static cell_t HasLevel(SourcePawn::IPluginContext *ctx, const cell_t *params) noexcept
+{
+    READ_LOGGER_HANDLE_OR_ERROR(params[1]);
+
+    return logger->HasLevel();
+}
+
 static cell_t SetPattern(SourcePawn::IPluginContext *ctx, const cell_t *params) noexcept
 {
     READ_LOGGER_HANDLE_OR_ERROR(params[1]);
@@ -232,6 +356,9 @@ static cell_t Log(SourcePawn::IPluginContext *ctx, const cell_t *params) noexcep
 
     auto lvl = Log4sp::NumToLvl(params[2]);
 
+    if (!logger->ShouldFormat(lvl))
+        return 0;
+
     char *msg;
     CTX_LOCAL_TO_STRING(params[3], &msg);
 
@@ -265,10 +392,13 @@ static cell_t LogSrc(SourcePawn::IPluginContext *ctx, const cell_t *params) noex
 
     auto lvl = Log4sp::NumToLvl(params[2]);
 
+    if (!logger->ShouldFormat(lvl))
+        return 0;
+
     char *msg;
     CTX_LOCAL_TO_STRING(params[3], &msg);
 
-    logger->Log(Log4sp::SrcHelper::GetFromPluginCtx(ctx), lvl, msg);
+    logger->LogSrc(ctx, lvl, msg);
     return 0;
 }
 
@@ -278,7 +408,10 @@ static cell_t LogSrcEx(SourcePawn::IPluginContext *ctx, const cell_t *params) no
 
     auto lvl = Log4sp::NumToLvl(params[2]);
 
-    logger->Log(ctx, Log4sp::SrcHelper::GetFromPluginCtx(ctx), lvl, params, 3);
+    if (!logger->ShouldFormat(lvl))
+        return 0;
+
+    logger->LogSrc(ctx, lvl, params, 3);
     return 0;
 }
 
@@ -288,7 +421,10 @@ static cell_t LogSrcAmxTpl(SourcePawn::IPluginContext *ctx, const cell_t *params
 
     auto lvl = Log4sp::NumToLvl(params[2]);
 
-    logger->LogAmxTpl(ctx, Log4sp::SrcHelper::GetFromPluginCtx(ctx), lvl, params, 3);
+    if (!logger->ShouldFormat(lvl))
+        return 0;
+
+    logger->LogSrcAmxTpl(ctx, lvl, params, 3);
     return 0;
 }
 
@@ -296,13 +432,17 @@ static cell_t LogLoc(SourcePawn::IPluginContext *ctx, const cell_t *params) noex
 {
     READ_LOGGER_HANDLE_OR_ERROR(params[1]);
 
+    auto lvl = Log4sp::NumToLvl(params[5]);
+
+    if (!logger->ShouldFormat(lvl))
+        return 0;
+
     char *file, *func, *msg;
     CTX_LOCAL_TO_STRING(params[2], &file);
     CTX_LOCAL_TO_STRING(params[4], &func);
     CTX_LOCAL_TO_STRING(params[6], &msg);
 
     int line = params[3];
-    auto lvl = Log4sp::NumToLvl(params[5]);
 
     logger->Log(spdlog::source_loc(file, line, func), lvl, msg);
     return 0;
@@ -312,12 +452,16 @@ static cell_t LogLocEx(SourcePawn::IPluginContext *ctx, const cell_t *params) no
 {
     READ_LOGGER_HANDLE_OR_ERROR(params[1]);
 
+    auto lvl = Log4sp::NumToLvl(params[5]);
+
+    if (!logger->ShouldFormat(lvl))
+        return 0;
+
     char *file, *func;
     CTX_LOCAL_TO_STRING(params[2], &file);
     CTX_LOCAL_TO_STRING(params[4], &func);
 
     int line = params[3];
-    auto lvl = Log4sp::NumToLvl(params[5]);
 
     logger->Log(ctx, spdlog::source_loc(file, line, func), lvl, params, 6);
     return 0;
@@ -327,12 +471,16 @@ static cell_t LogLocAmxTpl(SourcePawn::IPluginContext *ctx, const cell_t *params
 {
     READ_LOGGER_HANDLE_OR_ERROR(params[1]);
 
+    auto lvl = Log4sp::NumToLvl(params[5]);
+
+    if (!logger->ShouldFormat(lvl))
+        return 0;
+
     char *file, *func;
     CTX_LOCAL_TO_STRING(params[2], &file);
     CTX_LOCAL_TO_STRING(params[4], &func);
 
     int line = params[3];
-    auto lvl = Log4sp::NumToLvl(params[5]);
 
     logger->LogAmxTpl(ctx, spdlog::source_loc(file, line, func), lvl, params, 6);
     return 0;
@@ -344,18 +492,13 @@ static cell_t LogStackTrace(SourcePawn::IPluginContext *ctx, const cell_t *param
 
     auto lvl = Log4sp::NumToLvl(params[2]);
 
+    if (!logger->ShouldFormat(lvl))
+        return 0;
+
     char *msg;
     CTX_LOCAL_TO_STRING(params[3], &msg);
 
-    using spdlog::fmt_lib::format;
-    logger->Log(ctx, lvl, format("Stack trace requested: {}", msg));
-    logger->Log(ctx, lvl, format("Called from: {}", Log4sp::PluginSysFindPluginByCtx(ctx)->GetFilename()));
-
-    std::vector<std::string> messages = Log4sp::SrcHelper::GetStackTrace(ctx);
-    for (auto &iter : messages)
-    {
-        logger->Log(ctx, lvl, iter);
-    }
+    logger->LogStackTrace(ctx, lvl, msg);
     return 0;
 }
 
@@ -390,15 +533,7 @@ static cell_t ThrowError(SourcePawn::IPluginContext *ctx, const cell_t *params)
 
     ctx->ReportError(msg);
 
-    using spdlog::fmt_lib::format;
-    logger->Log(ctx, lvl, format("Exception reported: {}", msg));
-    logger->Log(ctx, lvl, format("Blaming: {}", Log4sp::PluginSysFindPluginByCtx(ctx)->GetFilename()));
-
-    std::vector<std::string> messages = Log4sp::SrcHelper::GetStackTrace(ctx);
-    for (auto &iter : messages)
-    {
-        logger->Log(ctx, lvl, iter);
-    }
+    logger->LogReportedError(ctx, lvl, msg);
     return 0;
 }
 
@@ -427,6 +562,9 @@ static cell_t Trace(SourcePawn::IPluginContext *ctx, const cell_t *params) noexc
     using spdlog::level::level_enum;
     READ_LOGGER_HANDLE_OR_ERROR(params[1]);
 
+    if (!logger->ShouldFormat(level_enum::trace))
+        return 0;
+
     char *msg;
     CTX_LOCAL_TO_STRING(params[2], &msg);
 
@@ -457,6 +595,9 @@ static cell_t Debug(SourcePawn::IPluginContext *ctx, const cell_t *params) noexc
     using spdlog::level::level_enum;
     READ_LOGGER_HANDLE_OR_ERROR(params[1]);
 
+    if (!logger->ShouldFormat(level_enum::debug))
+        return 0;
+
     char *msg;
     CTX_LOCAL_TO_STRING(params[2], &msg);
 
@@ -487,6 +628,9 @@ static cell_t Info(SourcePawn::IPluginContext *ctx, const cell_t *params) noexce
     using spdlog::level::level_enum;
     READ_LOGGER_HANDLE_OR_ERROR(params[1]);
 
+    if (!logger->ShouldFormat(level_enum::info))
+        return 0;
+
     char *msg;
     CTX_LOCAL_TO_STRING(params[2], &msg);
 
@@ -517,6 +661,9 @@ static cell_t Warn(SourcePawn::IPluginContext *ctx, const cell_t *params) noexce
     using spdlog::level::level_enum;
     READ_LOGGER_HANDLE_OR_ERROR(params[1]);
 
+    if (!logger->ShouldFormat(level_enum::warn))
+        return 0;
+
     char *msg;
     CTX_LOCAL_TO_STRING(params[2], &msg);
 
@@ -547,6 +694,9 @@ static cell_t Error(SourcePawn::IPluginContext *ctx, const cell_t *params) noexc
     using spdlog::level::level_enum;
     READ_LOGGER_HANDLE_OR_ERROR(params[1]);
 
+    if (!logger->ShouldFormat(level_enum::err))
+        return 0;
+
     char *msg;
     CTX_LOCAL_TO_STRING(params[2], &msg);
 
@@ -577,6 +727,9 @@ static cell_t Fatal(SourcePawn::IPluginContext *ctx, const cell_t *params) noexc
     using spdlog::level::level_enum;
     READ_LOGGER_HANDLE_OR_ERROR(params[1]);
 
+    if (!logger->ShouldFormat(level_enum::critical))
+        return 0;
+
     char *msg;
     CTX_LOCAL_TO_STRING(params[2], &msg);
 
@@ -627,6 +780,168 @@ static cell_t FlushOn(SourcePawn::IPluginContext *ctx, const cell_t *params) noe
     return 0;
 }
 
+static cell_t GetFlushPolicy(SourcePawn::IPluginContext *ctx, const cell_t *params) noexcept
+{
+    READ_LOGGER_HANDLE_OR_ERROR(params[1]);
+
+    return static_cast<cell_t>(logger->GetFlushPolicy());
+}
+
+static cell_t GetFlushInterval(SourcePawn::IPluginContext *ctx, const cell_t *params) noexcept
+{
+    READ_LOGGER_HANDLE_OR_ERROR(params[1]);
+
+    return static_cast<cell_t>(logger->GetFlushInterval().count());
+}
+
+static cell_t SetFlushPolicy(SourcePawn::IPluginContext *ctx, const cell_t *params) noexcept
+{
+    READ_LOGGER_HANDLE_OR_ERROR(params[1]);
+
+    int policy = params[2];
+    if (policy < static_cast<int>(Log4sp::FlushPolicy::Immediate) || policy > static_cast<int>(Log4sp::FlushPolicy::Interval))
+    {
+        ctx->ReportError("Invalid flush policy %d. (%d-%d)", policy,
+                         static_cast<int>(Log4sp::FlushPolicy::Immediate), static_cast<int>(Log4sp::FlushPolicy::Interval));
+        return 0;
+    }
+
+    int interval = params[3];
+    if (interval < 0)
+    {
+        ctx->ReportError("Invalid flush interval %d.", interval);
+        return 0;
+    }
+
+    logger->SetFlushPolicy(static_cast<Log4sp::FlushPolicy>(policy), std::chrono::milliseconds(interval));
+    return 0;
+}
+
+static cell_t GetQueueStats(SourcePawn::IPluginContext *ctx, const cell_t *params) noexcept
+{
+    READ_LOGGER_HANDLE_OR_ERROR(params[1]);
+
+    cell_t *enqueued, *dropped, *overwritten, *highWater;
+    CTX_LOCAL_TO_PHYS_ADDR(params[2], &enqueued);
+    CTX_LOCAL_TO_PHYS_ADDR(params[3], &dropped);
+    CTX_LOCAL_TO_PHYS_ADDR(params[4], &overwritten);
+    CTX_LOCAL_TO_PHYS_ADDR(params[5], &highWater);
+
+    auto stats = logger->GetQueueStats();
+    *enqueued    = static_cast<cell_t>(stats.enqueued);
+    *dropped     = static_cast<cell_t>(stats.dropped);
+    *overwritten = static_cast<cell_t>(stats.overwritten);
+    *highWater   = static_cast<cell_t>(stats.highWater);
+    return logger->IsAsync();
+}
+
+static cell_t EnableBacktrace(SourcePawn::IPluginContext *ctx, const cell_t *params) noexcept
+{
+    READ_LOGGER_HANDLE_OR_ERROR(params[1]);
+
+    int amount = params[2];
+    if (amount <= 0)
+    {
+        logger->DisableBacktrace();
+        return 0;
+    }
+
+    if (static_cast<std::size_t>(amount) > Log4sp::Logger::MaxBacktraceSize)
+    {
+        ctx->ReportError("Invalid amount %d. (max %d)", amount, static_cast<int>(Log4sp::Logger::MaxBacktraceSize));
+        return 0;
+    }
+
+    auto dumpLevel = Log4sp::NumToLvl(params[3]);
+
+    try
+    {
+        logger->EnableBacktrace(static_cast<std::size_t>(amount), dumpLevel);
+    }
+    catch (const std::exception &ex)
+    {
+        ctx->ReportError(ex.what());
+    }
+    return 0;
+}
+
+static cell_t DisableBacktrace(SourcePawn::IPluginContext *ctx, const cell_t *params) noexcept
+{
+    READ_LOGGER_HANDLE_OR_ERROR(params[1]);
+
+    logger->DisableBacktrace();
+    return 0;
+}
+
+static cell_t DumpBacktrace(SourcePawn::IPluginContext *ctx, const cell_t *params) noexcept
+{
+    READ_LOGGER_HANDLE_OR_ERROR(params[1]);
+
+    logger->DumpBacktrace(ctx);
+    return 0;
+}
+
+static cell_t SetStackTraceDedup(SourcePawn::IPluginContext *ctx, const cell_t *params) noexcept
+{
+    READ_LOGGER_HANDLE_OR_ERROR(params[1]);
+
+    int window = params[2];
+    int maxTraces = params[3];
+    if (maxTraces <= 0)
+    {
+        ctx->ReportError("Invalid max traces %d.", maxTraces);
+        return 0;
+    }
+
+    try
+    {
+        logger->SetTraceDedup(std::chrono::milliseconds(window), static_cast<std::size_t>(maxTraces));
+    }
+    catch (const std::exception &ex)
+    {
+        ctx->ReportError(ex.what());
+    }
+    return 0;
+}
+
+static cell_t SetRateLimit(SourcePawn::IPluginContext *ctx, const cell_t *params) noexcept
+{
+    READ_LOGGER_HANDLE_OR_ERROR(params[1]);
+
+    int rate = params[2];
+    int burst = params[3];
+    if (rate < 0 || burst < 0)
+    {
+        ctx->ReportError("Invalid rate limit %d (burst: %d).", rate, burst);
+        return 0;
+    }
+
+    logger->SetRateLimit(static_cast<std::uint32_t>(rate), static_cast<std::uint32_t>(burst));
+    return 0;
+}
+
+static cell_t SetSampleRate(SourcePawn::IPluginContext *ctx, const cell_t *params) noexcept
+{
+    READ_LOGGER_HANDLE_OR_ERROR(params[1]);
+
+    int sample = params[2];
+    if (sample < 0)
+    {
+        ctx->ReportError("Invalid sample rate %d.", sample);
+        return 0;
+    }
+
+    logger->SetSampleRate(static_cast<std::uint32_t>(sample));
+    return 0;
+}
+
+static cell_t GetSuppressedCount(SourcePawn::IPluginContext *ctx, const cell_t *params) noexcept
+{
+    READ_LOGGER_HANDLE_OR_ERROR(params[1]);
+
+    return static_cast<cell_t>(logger->GetRateLimiter().GetTotalSuppressed());
+}
+
 static cell_t AddSink(SourcePawn::IPluginContext *ctx, const cell_t *params) noexcept
 {
     READ_LOGGER_HANDLE_OR_ERROR(params[1]);
@@ -640,6 +955,12 @@ static cell_t AddSink(SourcePawn::IPluginContext *ctx, const cell_t *params) noe
         return 0;
     }
 
+    if (!CanAttachSink(logger, logger->IsAsync(), sink.get()))
+    {
+        ctx->ReportError("Sink %x cannot be shared between an asynchronous logger and other loggers.", params[2]);
+        return 0;
+    }
+
     logger->AddSink(sink);
     return 0;
 }
@@ -658,6 +979,12 @@ static cell_t AddSinkEx(SourcePawn::IPluginContext *ctx, const cell_t *params) n
         return 0;
     }
 
+    if (!CanAttachSink(logger, logger->IsAsync(), sink.get()))
+    {
+        ctx->ReportError("Sink %x cannot be shared between an asynchronous logger and other loggers.", params[2]);
+        return 0;
+    }
+
     HANDLE_SYS_FREE_HANDLE(params[2], &security);
 
     logger->AddSink(sink);
@@ -706,6 +1033,7 @@ const sp_nativeinfo_t LoggerNatives[] =
     {"Logger.Logger",                           Logger},
     {"Logger.CreateLoggerWith",                 CreateLoggerWith},
     {"Logger.CreateLoggerWithEx",               CreateLoggerWithEx},
+    {"Logger.CreateAsyncLogger",                CreateAsyncLogger},
     {"Logger.Get",                              Get},
     {"Logger.ApplyAll",                         ApplyAll},
 
@@ -713,6 +1041,8 @@ const sp_nativeinfo_t LoggerNatives[] =
     {"Logger.GetNameLength",                    GetNameLength},
     {"Logger.GetLevel",                         GetLevel},
     {"Logger.SetLevel",                         SetLevel},
+    {"Logger.ResetLevel",                       ResetLevel},
+    {"Logger.HasLevel",                         HasLevel},
     {"Logger.SetPattern",                       SetPattern},
     {"Logger.ShouldLog",                        ShouldLog},
 
@@ -754,6 +1084,17 @@ const sp_nativeinfo_t LoggerNatives[] =
     {"Logger.Flush",                            Flush},
     {"Logger.GetFlushLevel",                    GetFlushLevel},
     {"Logger.FlushOn",                          FlushOn},
+    {"Logger.GetFlushPolicy",                   GetFlushPolicy},
+    {"Logger.GetFlushInterval",                 GetFlushInterval},
+    {"Logger.SetFlushPolicy",                   SetFlushPolicy},
+    {"Logger.GetQueueStats",                    GetQueueStats},
+    {"Logger.EnableBacktrace",                  EnableBacktrace},
+    {"Logger.DisableBacktrace",                 DisableBacktrace},
+    {"Logger.DumpBacktrace",                    DumpBacktrace},
+    {"Logger.SetStackTraceDedup",               SetStackTraceDedup},
+    {"Logger.SetRateLimit",                     SetRateLimit},
+    {"Logger.SetSampleRate",                    SetSampleRate},
+    {"Logger.GetSuppressedCount",               GetSuppressedCount},
     {"Logger.AddSink",                          AddSink},
     {"Logger.AddSinkEx",                        AddSinkEx},
     {"Logger.DropSink",                         DropSink},
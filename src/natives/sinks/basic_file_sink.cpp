@@ -1,6 +1,7 @@
 #include "spdlog/sinks/basic_file_sink.h"
 
 #include "log4sp/common.h"
+#include "log4sp/flush_scheduler.h"
 #include "log4sp/adapter/logger_handler.h"
 #include "log4sp/adapter/sink_handler.h"
 
@@ -12,17 +13,44 @@
  *      读取失败时: 抛出错误并结束执行, 返回 0 (与 BAD_HANDLE 相同)
  */
 #define READ_BASIC_FILE_SINK_HANDLE_OR_ERROR(handle)                                                \
-    std::shared_ptr<spdlog::sinks::basic_file_sink_st> basicFileSink;                               \
+    spdlog::sinks::basic_file_sink_st *basicFileSink;                                               \
     {                                                                                               \
         SourceMod::HandleSecurity security(nullptr, myself->GetIdentity());                         \
         SourceMod::HandleError error;                                                               \
-        auto sink = Log4sp::SinkHandler::Instance().ReadHandle(handle, &security, &error);          \
+        auto sink = Log4sp::SinkHandler::Instance().ReadHandleRaw(handle, &security, &error);       \
         if (!sink)                                                                                  \
         {                                                                                           \
             ctx->ReportError("Invalid Sink Handle %x (error code: %d)", handle, error);             \
             return 0;                                                                               \
         }                                                                                           \
-        basicFileSink = std::dynamic_pointer_cast<spdlog::sinks::basic_file_sink_st>(sink);         \
+        basicFileSink = dynamic_cast<spdlog::sinks::basic_file_sink_st *>(sink);                    \
+        if (!basicFileSink)                                                                         \
+        {                                                                                           \
+            ctx->ReportError("Invalid BasicFileSink Handle %x.", handle);                           \
+            return 0;                                                                               \
+        }                                                                                           \
+    }
+
+/**
+ * 封装读取 basic file sink handle 代码，并持有 sink 直到 native 结束
+ * 用于可能执行插件回调的 native (回调中插件可能关闭 handle)
+ * 这会创建 2 个变量: sinkPtr, basicFileSink
+ *      读取成功时: 继续执行后续代码
+ *      读取失败时: 抛出错误并结束执行, 返回 0 (与 BAD_HANDLE 相同)
+ */
+#define READ_BASIC_FILE_SINK_HANDLE_SHARED_OR_ERROR(handle)                                         \
+    spdlog::sink_ptr sinkPtr;                                                                       \
+    spdlog::sinks::basic_file_sink_st *basicFileSink;                                               \
+    {                                                                                               \
+        SourceMod::HandleSecurity security(nullptr, myself->GetIdentity());                         \
+        SourceMod::HandleError error;                                                               \
+        sinkPtr = Log4sp::SinkHandler::Instance().ReadHandle(handle, &security, &error);            \
+        if (!sinkPtr)                                                                               \
+        {                                                                                           \
+            ctx->ReportError("Invalid Sink Handle %x (error code: %d)", handle, error);             \
+            return 0;                                                                               \
+        }                                                                                           \
+        basicFileSink = dynamic_cast<spdlog::sinks::basic_file_sink_st *>(sinkPtr.get());           \
         if (!basicFileSink)                                                                         \
         {                                                                                           \
             ctx->ReportError("Invalid BasicFileSink Handle %x.", handle);                           \
@@ -43,6 +71,8 @@ static cell_t BasicFileSink(SourcePawn::IPluginContext *ctx, const cell_t *param
     SourcePawn::IPluginFunction *openFunc  = ctx->GetFunctionById(params[3]);
     SourcePawn::IPluginFunction *closeFunc = ctx->GetFunctionById(params[4]);
 
+    READ_WRITE_BUFFER_PARAMS_OR_ERROR(5);
+
     spdlog::file_event_handlers handlers;
     handlers.before_open = FILE_EVENT_FUNCTION(openFunc);
     handlers.after_close = FILE_EVENT_FUNCTION(closeFunc);
@@ -51,6 +81,8 @@ static cell_t BasicFileSink(SourcePawn::IPluginContext *ctx, const cell_t *param
     try
     {
         sink = std::make_shared<spdlog::sinks::basic_file_sink_st>(absPath, truncate, handlers);
+        sink->set_write_buffer(writeBufferSize, writeBufferInterval);
+        Log4sp::FlushScheduler::Instance().ScheduleWriteBuffer(sink);
     }
     catch (const std::exception &ex)
     {
@@ -81,7 +113,8 @@ static cell_t BasicFileSink_GetFilename(SourcePawn::IPluginContext *ctx, const c
 
 static cell_t BasicFileSink_Truncate(SourcePawn::IPluginContext *ctx, const cell_t *params) noexcept
 {
-    READ_BASIC_FILE_SINK_HANDLE_OR_ERROR(params[1]);
+    READ_BASIC_FILE_SINK_HANDLE_SHARED_OR_ERROR(params[1]);
+    CHECK_SINK_NOT_ASYNC_OR_ERROR(params[1], basicFileSink);
 
     try
     {
@@ -114,6 +147,8 @@ static cell_t BasicFileSink_CreateLogger(SourcePawn::IPluginContext *ctx, const
     SourcePawn::IPluginFunction *openFunc  = ctx->GetFunctionById(params[4]);
     SourcePawn::IPluginFunction *closeFunc = ctx->GetFunctionById(params[5]);
 
+    READ_WRITE_BUFFER_PARAMS_OR_ERROR(6);
+
     spdlog::file_event_handlers handlers;
     handlers.before_open = FILE_EVENT_FUNCTION(openFunc);
     handlers.after_close = FILE_EVENT_FUNCTION(closeFunc);
@@ -122,6 +157,8 @@ static cell_t BasicFileSink_CreateLogger(SourcePawn::IPluginContext *ctx, const
     try
     {
         sink = std::make_shared<spdlog::sinks::basic_file_sink_st>(absPath, truncate, handlers);
+        sink->set_write_buffer(writeBufferSize, writeBufferInterval);
+        Log4sp::FlushScheduler::Instance().ScheduleWriteBuffer(sink);
     }
     catch (const std::exception &ex)
     {
@@ -11,17 +11,17 @@
  *      读取失败时: 抛出错误并结束执行, 返回 0 (与 BAD_HANDLE 相同)
  */
 #define READ_CALLBACK_SINK_HANDLE_OR_ERROR(handle)                                                  \
-    std::shared_ptr<Log4sp::Sinks::CallbackSink> callbackSink;                                      \
+    Log4sp::Sinks::CallbackSink *callbackSink;                                                      \
     {                                                                                               \
         SourceMod::HandleSecurity security(nullptr, myself->GetIdentity());                         \
         SourceMod::HandleError error;                                                               \
-        auto sink = Log4sp::SinkHandler::Instance().ReadHandle(handle, &security, &error);          \
+        auto sink = Log4sp::SinkHandler::Instance().ReadHandleRaw(handle, &security, &error);       \
         if (!sink)                                                                                  \
         {                                                                                           \
             ctx->ReportError("Invalid Sink Handle %x (error code: %d)", handle, error);             \
             return 0;                                                                               \
         }                                                                                           \
-        callbackSink = std::dynamic_pointer_cast<Log4sp::Sinks::CallbackSink>(sink);                \
+        callbackSink = dynamic_cast<Log4sp::Sinks::CallbackSink *>(sink);                           \
         if (!callbackSink)                                                                          \
         {                                                                                           \
             ctx->ReportError("Invalid CallbackSink Handle %x.", handle);                            \
@@ -62,6 +62,7 @@ static cell_t CallbackSink(SourcePawn::IPluginContext *ctx, const cell_t *params
 static cell_t CallbackSink_SetLogCallback(SourcePawn::IPluginContext *ctx, const cell_t *params) noexcept
 {
     READ_CALLBACK_SINK_HANDLE_OR_ERROR(params[1]);
+    CHECK_SINK_NOT_ASYNC_OR_ERROR(params[1], callbackSink);
 
     try
     {
@@ -77,6 +78,7 @@ static cell_t CallbackSink_SetLogCallback(SourcePawn::IPluginContext *ctx, const
 static cell_t CallbackSink_SetLogPostCallback(SourcePawn::IPluginContext *ctx, const cell_t *params) noexcept
 {
     READ_CALLBACK_SINK_HANDLE_OR_ERROR(params[1]);
+    CHECK_SINK_NOT_ASYNC_OR_ERROR(params[1], callbackSink);
 
     try
     {
@@ -92,6 +94,7 @@ static cell_t CallbackSink_SetLogPostCallback(SourcePawn::IPluginContext *ctx, c
 static cell_t CallbackSink_SetFlushCallback(SourcePawn::IPluginContext *ctx, const cell_t *params) noexcept
 {
     READ_CALLBACK_SINK_HANDLE_OR_ERROR(params[1]);
+    CHECK_SINK_NOT_ASYNC_OR_ERROR(params[1], callbackSink);
 
     try
     {
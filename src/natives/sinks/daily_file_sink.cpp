@@ -3,6 +3,8 @@
 #include "spdlog/sinks/daily_file_sink.h"
 
 #include "log4sp/common.h"
+#include "log4sp/flush_scheduler.h"
+#include "log4sp/file_compressor.h"
 #include "log4sp/adapter/logger_handler.h"
 #include "log4sp/adapter/sink_handler.h"
 
@@ -14,17 +16,17 @@
  *      读取失败时: 抛出错误并结束执行, 返回 0 (与 BAD_HANDLE 相同)
  */
 #define READ_DAILY_FILE_SINK_HANDLE_OR_ERROR(handle)                                                \
-    std::shared_ptr<spdlog::sinks::daily_file_sink_st> dailyFileSink;                               \
+    spdlog::sinks::daily_file_sink_st *dailyFileSink;                                               \
     {                                                                                               \
         SourceMod::HandleSecurity security(nullptr, myself->GetIdentity());                         \
         SourceMod::HandleError error;                                                               \
-        auto sink = Log4sp::SinkHandler::Instance().ReadHandle(handle, &security, &error);          \
+        auto sink = Log4sp::SinkHandler::Instance().ReadHandleRaw(handle, &security, &error);       \
         if (!sink)                                                                                  \
         {                                                                                           \
             ctx->ReportError("Invalid Sink Handle %x (error code: %d)", handle, error);             \
             return 0;                                                                               \
         }                                                                                           \
-        dailyFileSink = std::dynamic_pointer_cast<spdlog::sinks::daily_file_sink_st>(sink);         \
+        dailyFileSink = dynamic_cast<spdlog::sinks::daily_file_sink_st *>(sink);                    \
         if (!dailyFileSink)                                                                         \
         {                                                                                           \
             ctx->ReportError("Invalid DailyFileSink Handle %x.", handle);                           \
@@ -52,6 +54,10 @@
 #define DAILY_FILE_CUSTOM_CALCULATOR(func)                                                          \
     [func](const spdlog::filename_t &filename, const tm &now_tm)                                    \
     {                                                                                               \
+        /* 异步 Logger 的工作线程无法调用插件函数，也不能等待主线程，退回默认的文件名 */                   \
+        if (!Log4sp::FrameTaskQueue::Instance().IsMainThread())                                     \
+            return DAILY_FILE_DEFAULT_CALCULATOR()(filename, now_tm);                               \
+                                                                                                    \
         char relPath[PLATFORM_MAX_PATH];                                                            \
         ke::SafeStrcpy(relPath, sizeof(relPath), filename.data());                                  \
                                                                                                     \
@@ -86,6 +92,9 @@ static cell_t DailyFileSink(SourcePawn::IPluginContext *ctx, const cell_t *param
     auto openFunc = ctx->GetFunctionById(params[7]);
     auto closeFunc= ctx->GetFunctionById(params[8]);
 
+    READ_WRITE_BUFFER_PARAMS_OR_ERROR(9);
+    auto compress = params[0] >= 11 && static_cast<bool>(params[11]);
+
     if (params[5] < 0 || params[5] > UINT16_MAX)
     {
         ctx->ReportError("Invalid maxFiles %d. (0-%d)", params[5], UINT16_MAX);
@@ -105,7 +114,10 @@ static cell_t DailyFileSink(SourcePawn::IPluginContext *ctx, const cell_t *param
     std::shared_ptr<spdlog::sinks::daily_file_sink_st> sink;
     try
     {
-        sink = std::make_shared<spdlog::sinks::daily_file_sink_st>(file, hour, minute, truncate, maxFiles, handlers, calculator);
+        auto rotatedHandlers = compress ? Log4sp::FileCompressor::DailyHandlers() : spdlog::rotated_file_handlers{};
+        sink = std::make_shared<spdlog::sinks::daily_file_sink_st>(file, hour, minute, truncate, maxFiles, handlers, calculator, rotatedHandlers);
+        sink->set_write_buffer(writeBufferSize, writeBufferInterval);
+        Log4sp::FlushScheduler::Instance().ScheduleWriteBuffer(sink);
     }
     catch (const std::exception &ex)
     {
@@ -128,6 +140,7 @@ static cell_t DailyFileSink(SourcePawn::IPluginContext *ctx, const cell_t *param
 static cell_t GetFilename(SourcePawn::IPluginContext *ctx, const cell_t *params) noexcept
 {
     READ_DAILY_FILE_SINK_HANDLE_OR_ERROR(params[1]);
+    CHECK_SINK_NOT_ASYNC_OR_ERROR(params[1], dailyFileSink);
 
     std::size_t bytes = 0;
     CTX_STRING_TO_LOCAL_UTF8(params[2], params[3], dailyFileSink->filename().c_str(), &bytes);
@@ -137,6 +150,7 @@ static cell_t GetFilename(SourcePawn::IPluginContext *ctx, const cell_t *params)
 static cell_t GetFilenameLength(SourcePawn::IPluginContext *ctx, const cell_t *params) noexcept
 {
     READ_DAILY_FILE_SINK_HANDLE_OR_ERROR(params[1]);
+    CHECK_SINK_NOT_ASYNC_OR_ERROR(params[1], dailyFileSink);
 
     return static_cast<cell_t>(dailyFileSink->filename().length());
 }
@@ -162,6 +176,9 @@ static cell_t CreateLogger(SourcePawn::IPluginContext *ctx, const cell_t *params
     auto openFunc = ctx->GetFunctionById(params[8]);
     auto closeFunc= ctx->GetFunctionById(params[9]);
 
+    READ_WRITE_BUFFER_PARAMS_OR_ERROR(10);
+    auto compress = params[0] >= 12 && static_cast<bool>(params[12]);
+
     if (params[6] < 0 || params[6] > UINT16_MAX)
     {
         ctx->ReportError("Invalid maxFiles %d. (0-%d)", params[6], UINT16_MAX);
@@ -181,7 +198,10 @@ static cell_t CreateLogger(SourcePawn::IPluginContext *ctx, const cell_t *params
     std::shared_ptr<spdlog::sinks::daily_file_sink_st> sink;
     try
     {
-        sink = std::make_shared<spdlog::sinks::daily_file_sink_st>(file, hour, minute, truncate, maxFiles, handlers, calculator);
+        auto rotatedHandlers = compress ? Log4sp::FileCompressor::DailyHandlers() : spdlog::rotated_file_handlers{};
+        sink = std::make_shared<spdlog::sinks::daily_file_sink_st>(file, hour, minute, truncate, maxFiles, handlers, calculator, rotatedHandlers);
+        sink->set_write_buffer(writeBufferSize, writeBufferInterval);
+        Log4sp::FlushScheduler::Instance().ScheduleWriteBuffer(sink);
     }
     catch (const std::exception &ex)
     {
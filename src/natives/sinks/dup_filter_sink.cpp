@@ -0,0 +1,130 @@
+#include "log4sp/common.h"
+#include "log4sp/adapter/logger_handler.h"
+#include "log4sp/adapter/sink_handler.h"
+#include "log4sp/sinks/dup_filter_sink.h"
+
+
+/**
+ * 封装读取 dup filter sink handle 代码
+ * 这会创建 1 个变量: dupFilterSink
+ *      读取成功时: 继续执行后续代码
+ *      读取失败时: 抛出错误并结束执行, 返回 0 (与 BAD_HANDLE 相同)
+ */
+#define READ_DUP_FILTER_SINK_HANDLE_OR_ERROR(handle)                                                \
+    Log4sp::Sinks::DupFilterSinkST *dupFilterSink;                                                  \
+    {                                                                                               \
+        SourceMod::HandleSecurity security(nullptr, myself->GetIdentity());                         \
+        SourceMod::HandleError error;                                                               \
+        auto sink = Log4sp::SinkHandler::Instance().ReadHandleRaw(handle, &security, &error);       \
+        if (!sink)                                                                                  \
+        {                                                                                           \
+            ctx->ReportError("Invalid Sink Handle %x (error code: %d)", handle, error);             \
+            return 0;                                                                               \
+        }                                                                                           \
+        dupFilterSink = dynamic_cast<Log4sp::Sinks::DupFilterSinkST *>(sink);                       \
+        if (!dupFilterSink)                                                                         \
+        {                                                                                           \
+            ctx->ReportError("Invalid DupFilterSink Handle %x.", handle);                           \
+            return 0;                                                                               \
+        }                                                                                           \
+    }
+
+
+static cell_t DupFilterSink(SourcePawn::IPluginContext *ctx, const cell_t *params) noexcept
+{
+    int maxSkipDuration = params[1];
+    if (maxSkipDuration < 0)
+    {
+        ctx->ReportError("Invalid max skip duration %d.", maxSkipDuration);
+        return BAD_HANDLE;
+    }
+
+    auto lvl = Log4sp::NumToLvl(params[2]);
+
+    SourceMod::HandleSecurity security(nullptr, myself->GetIdentity());
+    SourceMod::HandleError error;
+
+    auto sink = std::make_shared<Log4sp::Sinks::DupFilterSinkST>(std::chrono::milliseconds(maxSkipDuration), lvl);
+    auto handle = Log4sp::SinkHandler::Instance().CreateHandle(sink, &security, nullptr, &error);
+    if (!handle)
+    {
+        ctx->ReportError("Failed to creates a DupFilterSink Handle (error code: %d)", error);
+        return BAD_HANDLE;
+    }
+    return handle;
+}
+
+static cell_t DupFilterSink_AddSink(SourcePawn::IPluginContext *ctx, const cell_t *params) noexcept
+{
+    READ_DUP_FILTER_SINK_HANDLE_OR_ERROR(params[1]);
+    CHECK_SINK_NOT_ASYNC_OR_ERROR(params[1], dupFilterSink);
+
+    SourceMod::HandleSecurity security(nullptr, myself->GetIdentity());
+    SourceMod::HandleError error;
+    auto sink = Log4sp::SinkHandler::Instance().ReadHandle(params[2], &security, &error);
+    if (!sink)
+    {
+        ctx->ReportError("Invalid Sink Handle %x (error code: %d)", params[2], error);
+        return 0;
+    }
+
+    // 子 sink 不能包含 dupFilterSink 本身，否则会无限递归
+    auto child = dynamic_cast<Log4sp::Sinks::DupFilterSinkST *>(sink.get());
+    if (sink.get() == dupFilterSink || (child && child->Contains(dupFilterSink)))
+    {
+        ctx->ReportError("DupFilterSink %x cannot contain itself.", params[1]);
+        return 0;
+    }
+
+    if (Log4sp::LoggerHandler::Instance().IsAsyncSink(sink.get()))
+    {
+        ctx->ReportError("Sink %x is written by an asynchronous logger and cannot be accessed directly.", params[2]);
+        return 0;
+    }
+
+    try
+    {
+        dupFilterSink->add_sink(sink);
+    }
+    catch (const std::exception &ex)
+    {
+        ctx->ReportError(ex.what());
+    }
+    return 0;
+}
+
+static cell_t DupFilterSink_DropSink(SourcePawn::IPluginContext *ctx, const cell_t *params) noexcept
+{
+    READ_DUP_FILTER_SINK_HANDLE_OR_ERROR(params[1]);
+    CHECK_SINK_NOT_ASYNC_OR_ERROR(params[1], dupFilterSink);
+
+    SourceMod::HandleSecurity security(nullptr, myself->GetIdentity());
+    SourceMod::HandleError error;
+    auto sink = Log4sp::SinkHandler::Instance().ReadHandle(params[2], &security, &error);
+    if (!sink)
+    {
+        ctx->ReportError("Invalid Sink Handle %x (error code: %d)", params[2], error);
+        return 0;
+    }
+
+    dupFilterSink->remove_sink(sink);
+    return 0;
+}
+
+static cell_t DupFilterSink_GetSkippedCount(SourcePawn::IPluginContext *ctx, const cell_t *params) noexcept
+{
+    READ_DUP_FILTER_SINK_HANDLE_OR_ERROR(params[1]);
+    CHECK_SINK_NOT_ASYNC_OR_ERROR(params[1], dupFilterSink);
+
+    return static_cast<cell_t>(dupFilterSink->GetSkippedCount());
+}
+
+const sp_nativeinfo_t DupFilterSinkNatives[] =
+{
+    {"DupFilterSink.DupFilterSink",                 DupFilterSink},
+    {"DupFilterSink.AddSink",                       DupFilterSink_AddSink},
+    {"DupFilterSink.DropSink",                      DupFilterSink_DropSink},
+    {"DupFilterSink.GetSkippedCount",               DupFilterSink_GetSkippedCount},
+
+    {nullptr,                                       nullptr}
+};
@@ -0,0 +1,159 @@
+#include "log4sp/common.h"
+#include "log4sp/adapter/logger_handler.h"
+#include "log4sp/adapter/sink_handler.h"
+#include "log4sp/sinks/mapped_file_sink.h"
+
+
+/**
+ * 封装读取 mapped file sink handle 代码
+ * 这会创建 1 个变量: mappedFileSink
+ *      读取成功时: 继续执行后续代码
+ *      读取失败时: 抛出错误并结束执行, 返回 0 (与 BAD_HANDLE 相同)
+ */
+#define READ_MAPPED_FILE_SINK_HANDLE_OR_ERROR(handle)                                               \
+    Log4sp::Sinks::MappedFileSinkST *mappedFileSink;                                                \
+    {                                                                                               \
+        SourceMod::HandleSecurity security(nullptr, myself->GetIdentity());                         \
+        SourceMod::HandleError error;                                                               \
+        auto sink = Log4sp::SinkHandler::Instance().ReadHandleRaw(handle, &security, &error);       \
+        if (!sink)                                                                                  \
+        {                                                                                           \
+            ctx->ReportError("Invalid Sink Handle %x (error code: %d)", handle, error);             \
+            return 0;                                                                               \
+        }                                                                                           \
+        mappedFileSink = dynamic_cast<Log4sp::Sinks::MappedFileSinkST *>(sink);                     \
+        if (!mappedFileSink)                                                                        \
+        {                                                                                           \
+            ctx->ReportError("Invalid MappedFileSink Handle %x.", handle);                          \
+            return 0;                                                                               \
+        }                                                                                           \
+    }
+
+
+static cell_t MappedFileSink(SourcePawn::IPluginContext *ctx, const cell_t *params) noexcept
+{
+    char *file;
+    CTX_LOCAL_TO_STRING(params[1], &file);
+
+    char absPath[PLATFORM_MAX_PATH];
+    smutils->BuildPath(Path_Game, absPath, sizeof(absPath), "%s", file);
+
+    int segmentSize = params[2];
+    auto truncate = static_cast<bool>(params[3]);
+    SourcePawn::IPluginFunction *openFunc  = ctx->GetFunctionById(params[4]);
+    SourcePawn::IPluginFunction *closeFunc = ctx->GetFunctionById(params[5]);
+
+    if (segmentSize <= 0)
+    {
+        ctx->ReportError("Invalid segment size %d.", segmentSize);
+        return BAD_HANDLE;
+    }
+
+    spdlog::file_event_handlers handlers;
+    handlers.before_open = FILE_EVENT_FUNCTION(openFunc);
+    handlers.after_close = FILE_EVENT_FUNCTION(closeFunc);
+
+    std::shared_ptr<Log4sp::Sinks::MappedFileSinkST> sink;
+    try
+    {
+        sink = std::make_shared<Log4sp::Sinks::MappedFileSinkST>(absPath, static_cast<std::size_t>(segmentSize), truncate, handlers);
+    }
+    catch (const std::exception &ex)
+    {
+        ctx->ReportError(ex.what());
+        return BAD_HANDLE;
+    }
+
+    SourceMod::HandleSecurity security(nullptr, myself->GetIdentity());
+    SourceMod::HandleError error;
+
+    auto handle = Log4sp::SinkHandler::Instance().CreateHandle(sink, &security, nullptr, &error);
+    if (!handle)
+    {
+        ctx->ReportError("Failed to creates a MappedFileSink Handle (error code: %d)", error);
+        return BAD_HANDLE;
+    }
+    return handle;
+}
+
+static cell_t MappedFileSink_GetFilename(SourcePawn::IPluginContext *ctx, const cell_t *params) noexcept
+{
+    READ_MAPPED_FILE_SINK_HANDLE_OR_ERROR(params[1]);
+
+    std::size_t bytes = 0;
+    CTX_STRING_TO_LOCAL_UTF8(params[2], params[3], mappedFileSink->GetFilename().c_str(), &bytes);
+    return static_cast<cell_t>(bytes);
+}
+
+static cell_t MappedFileSink_GetSegmentSize(SourcePawn::IPluginContext *ctx, const cell_t *params) noexcept
+{
+    READ_MAPPED_FILE_SINK_HANDLE_OR_ERROR(params[1]);
+
+    return static_cast<cell_t>(mappedFileSink->GetSegmentSize());
+}
+
+static cell_t MappedFileSink_CreateLogger(SourcePawn::IPluginContext *ctx, const cell_t *params) noexcept
+{
+    char *name;
+    CTX_LOCAL_TO_STRING(params[1], &name);
+    if (Log4sp::LoggerHandler::Instance().FindHandle(name))
+    {
+        ctx->ReportError("Logger with name \"%s\" already exists.", name);
+        return BAD_HANDLE;
+    }
+
+    char *file;
+    CTX_LOCAL_TO_STRING(params[2], &file);
+
+    char absPath[PLATFORM_MAX_PATH];
+    smutils->BuildPath(Path_Game, absPath, sizeof(absPath), "%s", file);
+
+    int segmentSize = params[3];
+    auto truncate = static_cast<bool>(params[4]);
+    SourcePawn::IPluginFunction *openFunc  = ctx->GetFunctionById(params[5]);
+    SourcePawn::IPluginFunction *closeFunc = ctx->GetFunctionById(params[6]);
+
+    if (segmentSize <= 0)
+    {
+        ctx->ReportError("Invalid segment size %d.", segmentSize);
+        return BAD_HANDLE;
+    }
+
+    spdlog::file_event_handlers handlers;
+    handlers.before_open = FILE_EVENT_FUNCTION(openFunc);
+    handlers.after_close = FILE_EVENT_FUNCTION(closeFunc);
+
+    std::shared_ptr<Log4sp::Sinks::MappedFileSinkST> sink;
+    try
+    {
+        sink = std::make_shared<Log4sp::Sinks::MappedFileSinkST>(absPath, static_cast<std::size_t>(segmentSize), truncate, handlers);
+    }
+    catch (const std::exception &ex)
+    {
+        ctx->ReportError(ex.what());
+        return BAD_HANDLE;
+    }
+
+    SourceMod::HandleSecurity security(ctx->GetIdentity(), myself->GetIdentity());
+    SourceMod::HandleError error;
+
+    auto logger = std::make_shared<Log4sp::Logger>(name, sink);
+    auto handle = Log4sp::LoggerHandler::Instance().CreateHandle(logger, &security, nullptr, &error);
+    if (!handle)
+    {
+        ctx->ReportError("Failed to creates a Logger Handle (error code: %d)", error);
+        return BAD_HANDLE;
+    }
+    return handle;
+}
+
+const sp_nativeinfo_t MappedFileSinkNatives[] =
+{
+    {"MappedFileSink.MappedFileSink",           MappedFileSink},
+    {"MappedFileSink.GetFilename",              MappedFileSink_GetFilename},
+    {"MappedFileSink.GetSegmentSize",           MappedFileSink_GetSegmentSize},
+
+    {"MappedFileSink.CreateLogger",             MappedFileSink_CreateLogger},
+
+    {nullptr,                                   nullptr}
+};
@@ -0,0 +1,184 @@
+#include <type_traits>
+
+#include "log4sp/common.h"
+#include "log4sp/adapter/logger_handler.h"
+#include "log4sp/adapter/sink_handler.h"
+#include "log4sp/sinks/network_sink.h"
+
+
+/**
+ * UdpSink 与 TcpSink 的 natives 只有 sink 类型不同，共用下面的模板实现
+ */
+template <typename NetworkSink>
+constexpr const char *NetworkSinkName = std::is_same_v<NetworkSink, Log4sp::Sinks::UdpSinkST> ? "UdpSink" : "TcpSink";
+
+/**
+ * 封装读取 udp / tcp sink handle 代码
+ * 这会创建 1 个变量: networkSink
+ *      读取成功时: 继续执行后续代码
+ *      读取失败时: 抛出错误并结束执行, 返回 0 (与 BAD_HANDLE 相同)
+ */
+#define READ_NETWORK_SINK_HANDLE_OR_ERROR(handle)                                                   \
+    NetworkSink *networkSink;                                                                       \
+    {                                                                                               \
+        SourceMod::HandleSecurity security(nullptr, myself->GetIdentity());                         \
+        SourceMod::HandleError error;                                                               \
+        auto sink = Log4sp::SinkHandler::Instance().ReadHandleRaw(handle, &security, &error);       \
+        if (!sink)                                                                                  \
+        {                                                                                           \
+            ctx->ReportError("Invalid Sink Handle %x (error code: %d)", handle, error);             \
+            return 0;                                                                               \
+        }                                                                                           \
+        networkSink = dynamic_cast<NetworkSink *>(sink);                                            \
+        if (!networkSink)                                                                           \
+        {                                                                                           \
+            ctx->ReportError("Invalid %s Handle %x.", NetworkSinkName<NetworkSink>, handle);        \
+            return 0;                                                                               \
+        }                                                                                           \
+    }
+
+
+/**
+ * 读取从 params[index] 开始的 host, port, bufferSize 参数并创建 sink
+ * 参数无效或创建失败时抛出错误，返回 nullptr
+ */
+template <typename NetworkSink>
+[[nodiscard]]
+static std::shared_ptr<NetworkSink> MakeNetworkSink(SourcePawn::IPluginContext *ctx, const cell_t *params, int index) noexcept
+{
+    char *host;
+    CTX_LOCAL_TO_STRING(params[index], &host);
+
+    int port = params[index + 1];
+    int bufferSize = params[index + 2];
+
+    if (port <= 0 || port > 65535)
+    {
+        ctx->ReportError("Invalid port %d.", port);
+        return nullptr;
+    }
+
+    if (bufferSize <= 0)
+    {
+        ctx->ReportError("Invalid buffer size %d.", bufferSize);
+        return nullptr;
+    }
+
+    try
+    {
+        return std::make_shared<NetworkSink>(host, static_cast<std::uint16_t>(port), static_cast<std::size_t>(bufferSize));
+    }
+    catch (const std::exception &ex)
+    {
+        ctx->ReportError(ex.what());
+        return nullptr;
+    }
+}
+
+template <typename NetworkSink>
+static cell_t NetworkSink_Create(SourcePawn::IPluginContext *ctx, const cell_t *params) noexcept
+{
+    auto sink = MakeNetworkSink<NetworkSink>(ctx, params, 1);
+    if (!sink)
+        return BAD_HANDLE;
+
+    SourceMod::HandleSecurity security(nullptr, myself->GetIdentity());
+    SourceMod::HandleError error;
+
+    auto handle = Log4sp::SinkHandler::Instance().CreateHandle(sink, &security, nullptr, &error);
+    if (!handle)
+    {
+        ctx->ReportError("Failed to creates a %s Handle (error code: %d)", NetworkSinkName<NetworkSink>, error);
+        return BAD_HANDLE;
+    }
+    return handle;
+}
+
+template <typename NetworkSink>
+static cell_t NetworkSink_GetHost(SourcePawn::IPluginContext *ctx, const cell_t *params) noexcept
+{
+    READ_NETWORK_SINK_HANDLE_OR_ERROR(params[1]);
+
+    std::size_t bytes = 0;
+    CTX_STRING_TO_LOCAL_UTF8(params[2], params[3], networkSink->GetHost().c_str(), &bytes);
+    return static_cast<cell_t>(bytes);
+}
+
+template <typename NetworkSink>
+static cell_t NetworkSink_GetPort(SourcePawn::IPluginContext *ctx, const cell_t *params) noexcept
+{
+    READ_NETWORK_SINK_HANDLE_OR_ERROR(params[1]);
+
+    return static_cast<cell_t>(networkSink->GetPort());
+}
+
+template <typename NetworkSink>
+static cell_t NetworkSink_GetBufferSize(SourcePawn::IPluginContext *ctx, const cell_t *params) noexcept
+{
+    READ_NETWORK_SINK_HANDLE_OR_ERROR(params[1]);
+
+    return static_cast<cell_t>(networkSink->GetBufferSize());
+}
+
+template <typename NetworkSink>
+static cell_t NetworkSink_GetDroppedCount(SourcePawn::IPluginContext *ctx, const cell_t *params) noexcept
+{
+    READ_NETWORK_SINK_HANDLE_OR_ERROR(params[1]);
+
+    auto count = networkSink->GetDroppedCount();
+    return static_cast<cell_t>(std::min<std::uint64_t>(count, INT32_MAX));
+}
+
+template <typename NetworkSink>
+static cell_t NetworkSink_CreateLogger(SourcePawn::IPluginContext *ctx, const cell_t *params) noexcept
+{
+    char *name;
+    CTX_LOCAL_TO_STRING(params[1], &name);
+    if (Log4sp::LoggerHandler::Instance().FindHandle(name))
+    {
+        ctx->ReportError("Logger with name \"%s\" already exists.", name);
+        return BAD_HANDLE;
+    }
+
+    auto sink = MakeNetworkSink<NetworkSink>(ctx, params, 2);
+    if (!sink)
+        return BAD_HANDLE;
+
+    SourceMod::HandleSecurity security(ctx->GetIdentity(), myself->GetIdentity());
+    SourceMod::HandleError error;
+
+    auto logger = std::make_shared<Log4sp::Logger>(name, sink);
+    auto handle = Log4sp::LoggerHandler::Instance().CreateHandle(logger, &security, nullptr, &error);
+    if (!handle)
+    {
+        ctx->ReportError("Failed to creates a Logger Handle (error code: %d)", error);
+        return BAD_HANDLE;
+    }
+    return handle;
+}
+
+const sp_nativeinfo_t UdpSinkNatives[] =
+{
+    {"UdpSink.UdpSink",                     NetworkSink_Create<Log4sp::Sinks::UdpSinkST>},
+    {"UdpSink.GetHost",                     NetworkSink_GetHost<Log4sp::Sinks::UdpSinkST>},
+    {"UdpSink.GetPort",                     NetworkSink_GetPort<Log4sp::Sinks::UdpSinkST>},
+    {"UdpSink.GetBufferSize",               NetworkSink_GetBufferSize<Log4sp::Sinks::UdpSinkST>},
+    {"UdpSink.GetDroppedCount",             NetworkSink_GetDroppedCount<Log4sp::Sinks::UdpSinkST>},
+
+    {"UdpSink.CreateLogger",                NetworkSink_CreateLogger<Log4sp::Sinks::UdpSinkST>},
+
+    {nullptr,                               nullptr}
+};
+
+const sp_nativeinfo_t TcpSinkNatives[] =
+{
+    {"TcpSink.TcpSink",                     NetworkSink_Create<Log4sp::Sinks::TcpSinkST>},
+    {"TcpSink.GetHost",                     NetworkSink_GetHost<Log4sp::Sinks::TcpSinkST>},
+    {"TcpSink.GetPort",                     NetworkSink_GetPort<Log4sp::Sinks::TcpSinkST>},
+    {"TcpSink.GetBufferSize",               NetworkSink_GetBufferSize<Log4sp::Sinks::TcpSinkST>},
+    {"TcpSink.GetDroppedCount",             NetworkSink_GetDroppedCount<Log4sp::Sinks::TcpSinkST>},
+
+    {"TcpSink.CreateLogger",                NetworkSink_CreateLogger<Log4sp::Sinks::TcpSinkST>},
+
+    {nullptr,                               nullptr}
+};
@@ -6,22 +6,24 @@
 
 /**
  * 封装读取 ringbuffer sink handle 代码
- * 这会创建 4 个变量: security, error, sink, ringBufferSink
+ * Drain 会执行插件回调 (回调中插件可能关闭 handle)，所以 sinkPtr 会持有 sink 直到 native 结束
+ * 这会创建 2 个变量: sinkPtr, ringBufferSink
  *      读取成功时: 继续执行后续代码
  *      读取失败时: 抛出错误并结束执行, 返回 0 (与 BAD_HANDLE 相同)
  */
 #define READ_RING_BUFFER_SINK_HANDLE_OR_ERROR(handle)                                               \
-    std::shared_ptr<Log4sp::Sinks::RingBufferSinkST> ringBufferSink;                                \
+    spdlog::sink_ptr sinkPtr;                                                                       \
+    Log4sp::Sinks::RingBufferSinkST *ringBufferSink;                                                \
     {                                                                                               \
         SourceMod::HandleSecurity security(nullptr, myself->GetIdentity());                         \
         SourceMod::HandleError error;                                                               \
-        auto sink = Log4sp::SinkHandler::Instance().ReadHandle(handle, &security, &error);          \
-        if (!sink)                                                                                  \
+        sinkPtr = Log4sp::SinkHandler::Instance().ReadHandle(handle, &security, &error);            \
+        if (!sinkPtr)                                                                               \
         {                                                                                           \
             ctx->ReportError("Invalid Sink Handle %x (error code: %d)", handle, error);             \
             return 0;                                                                               \
         }                                                                                           \
-        ringBufferSink = std::dynamic_pointer_cast<Log4sp::Sinks::RingBufferSinkST>(sink);          \
+        ringBufferSink = dynamic_cast<Log4sp::Sinks::RingBufferSinkST *>(sinkPtr.get());            \
         if (!ringBufferSink)                                                                        \
         {                                                                                           \
             ctx->ReportError("Invalid RingBufferSink Handle %x.", handle);                          \
@@ -50,6 +52,7 @@ static cell_t RingBufferSink(SourcePawn::IPluginContext *ctx, const cell_t *para
 static cell_t RingBufferSink_Drain(SourcePawn::IPluginContext *ctx, const cell_t *params) noexcept
 {
     READ_RING_BUFFER_SINK_HANDLE_OR_ERROR(params[1]);
+    CHECK_SINK_NOT_ASYNC_OR_ERROR(params[1], ringBufferSink);
 
     auto func = ctx->GetFunctionById(params[2]);
     if (!func)
@@ -104,6 +107,7 @@ static cell_t RingBufferSink_Drain(SourcePawn::IPluginContext *ctx, const cell_t
 static cell_t RingBufferSink_DrainFormatted(SourcePawn::IPluginContext *ctx, const cell_t *params) noexcept
 {
     READ_RING_BUFFER_SINK_HANDLE_OR_ERROR(params[1]);
+    CHECK_SINK_NOT_ASYNC_OR_ERROR(params[1], ringBufferSink);
 
     auto func = ctx->GetFunctionById(params[2]);
     if (!func)
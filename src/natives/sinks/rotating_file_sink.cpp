@@ -1,6 +1,8 @@
 #include "spdlog/sinks/rotating_file_sink.h"
 
 #include "log4sp/common.h"
+#include "log4sp/flush_scheduler.h"
+#include "log4sp/file_compressor.h"
 #include "log4sp/adapter/logger_handler.h"
 #include "log4sp/adapter/sink_handler.h"
 
@@ -12,17 +14,44 @@
  *      读取失败时: 抛出错误并结束执行, 返回 0 (与 BAD_HANDLE 相同)
  */
 #define READ_ROTATING_FILE_SINK_HANDLE_OR_ERROR(handle)                                             \
-    std::shared_ptr<spdlog::sinks::rotating_file_sink_st> rotatingFileSink;                         \
+    spdlog::sinks::rotating_file_sink_st *rotatingFileSink;                                         \
     {                                                                                               \
         SourceMod::HandleSecurity security(nullptr, myself->GetIdentity());                         \
         SourceMod::HandleError error;                                                               \
-        auto sink = Log4sp::SinkHandler::Instance().ReadHandle(handle, &security, &error);          \
+        auto sink = Log4sp::SinkHandler::Instance().ReadHandleRaw(handle, &security, &error);       \
         if (!sink)                                                                                  \
         {                                                                                           \
             ctx->ReportError("Invalid Sink Handle %x (error code: %d)", handle, error);             \
             return 0;                                                                               \
         }                                                                                           \
-        rotatingFileSink = std::dynamic_pointer_cast<spdlog::sinks::rotating_file_sink_st>(sink);   \
+        rotatingFileSink = dynamic_cast<spdlog::sinks::rotating_file_sink_st *>(sink);              \
+        if (!rotatingFileSink)                                                                      \
+        {                                                                                           \
+            ctx->ReportError("Invalid RotatingFileSink Handle %x.", handle);                        \
+            return 0;                                                                               \
+        }                                                                                           \
+    }
+
+/**
+ * 封装读取 rotating file sink handle 代码，并持有 sink 直到 native 结束
+ * 用于可能执行插件回调的 native (回调中插件可能关闭 handle)
+ * 这会创建 2 个变量: sinkPtr, rotatingFileSink
+ *      读取成功时: 继续执行后续代码
+ *      读取失败时: 抛出错误并结束执行, 返回 0 (与 BAD_HANDLE 相同)
+ */
+#define READ_ROTATING_FILE_SINK_HANDLE_SHARED_OR_ERROR(handle)                                      \
+    spdlog::sink_ptr sinkPtr;                                                                       \
+    spdlog::sinks::rotating_file_sink_st *rotatingFileSink;                                         \
+    {                                                                                               \
+        SourceMod::HandleSecurity security(nullptr, myself->GetIdentity());                         \
+        SourceMod::HandleError error;                                                               \
+        sinkPtr = Log4sp::SinkHandler::Instance().ReadHandle(handle, &security, &error);            \
+        if (!sinkPtr)                                                                               \
+        {                                                                                           \
+            ctx->ReportError("Invalid Sink Handle %x (error code: %d)", handle, error);             \
+            return 0;                                                                               \
+        }                                                                                           \
+        rotatingFileSink = dynamic_cast<spdlog::sinks::rotating_file_sink_st *>(sinkPtr.get());     \
         if (!rotatingFileSink)                                                                      \
         {                                                                                           \
             ctx->ReportError("Invalid RotatingFileSink Handle %x.", handle);                        \
@@ -45,6 +74,9 @@ static cell_t RotatingFileSink(SourcePawn::IPluginContext *ctx, const cell_t *pa
     SourcePawn::IPluginFunction *openFunc  = ctx->GetFunctionById(params[5]);
     SourcePawn::IPluginFunction *closeFunc = ctx->GetFunctionById(params[6]);
 
+    READ_WRITE_BUFFER_PARAMS_OR_ERROR(7);
+    auto compress = params[0] >= 9 && static_cast<bool>(params[9]);
+
     spdlog::file_event_handlers handlers;
     handlers.before_open = FILE_EVENT_FUNCTION(openFunc);
     handlers.after_close = FILE_EVENT_FUNCTION(closeFunc);
@@ -52,7 +84,10 @@ static cell_t RotatingFileSink(SourcePawn::IPluginContext *ctx, const cell_t *pa
     std::shared_ptr<spdlog::sinks::rotating_file_sink_st> sink;
     try
     {
-        sink = std::make_shared<spdlog::sinks::rotating_file_sink_st>(absPath, maxFileSize, maxFiles, rotateOnOpen, handlers);
+        auto rotatedHandlers = compress ? Log4sp::FileCompressor::RotatingHandlers(absPath, maxFiles) : spdlog::rotated_file_handlers{};
+        sink = std::make_shared<spdlog::sinks::rotating_file_sink_st>(absPath, maxFileSize, maxFiles, rotateOnOpen, handlers, rotatedHandlers);
+        sink->set_write_buffer(writeBufferSize, writeBufferInterval);
+        Log4sp::FlushScheduler::Instance().ScheduleWriteBuffer(sink);
     }
     catch (const std::exception &ex)
     {
@@ -75,6 +110,7 @@ static cell_t RotatingFileSink(SourcePawn::IPluginContext *ctx, const cell_t *pa
 static cell_t GetFilename(SourcePawn::IPluginContext *ctx, const cell_t *params) noexcept
 {
     READ_ROTATING_FILE_SINK_HANDLE_OR_ERROR(params[1]);
+    CHECK_SINK_NOT_ASYNC_OR_ERROR(params[1], rotatingFileSink);
 
     std::size_t bytes = 0;
     CTX_STRING_TO_LOCAL_UTF8(params[2], params[3], rotatingFileSink->filename().c_str(), &bytes);
@@ -84,13 +120,15 @@ static cell_t GetFilename(SourcePawn::IPluginContext *ctx, const cell_t *params)
 static cell_t GetFilenameLength(SourcePawn::IPluginContext *ctx, const cell_t *params) noexcept
 {
     READ_ROTATING_FILE_SINK_HANDLE_OR_ERROR(params[1]);
+    CHECK_SINK_NOT_ASYNC_OR_ERROR(params[1], rotatingFileSink);
 
     return static_cast<cell_t>(rotatingFileSink->filename().length());
 }
 
 static cell_t RotateNow(SourcePawn::IPluginContext *ctx, const cell_t *params) noexcept
 {
-    READ_ROTATING_FILE_SINK_HANDLE_OR_ERROR(params[1]);
+    READ_ROTATING_FILE_SINK_HANDLE_SHARED_OR_ERROR(params[1]);
+    CHECK_SINK_NOT_ASYNC_OR_ERROR(params[1], rotatingFileSink);
 
     try
     {
@@ -138,6 +176,9 @@ static cell_t CreateLogger(SourcePawn::IPluginContext *ctx, const cell_t *params
     SourcePawn::IPluginFunction *openFunc  = ctx->GetFunctionById(params[6]);
     SourcePawn::IPluginFunction *closeFunc = ctx->GetFunctionById(params[7]);
 
+    READ_WRITE_BUFFER_PARAMS_OR_ERROR(8);
+    auto compress = params[0] >= 10 && static_cast<bool>(params[10]);
+
     spdlog::file_event_handlers handlers;
     handlers.before_open = FILE_EVENT_FUNCTION(openFunc);
     handlers.after_close = FILE_EVENT_FUNCTION(closeFunc);
@@ -145,7 +186,10 @@ static cell_t CreateLogger(SourcePawn::IPluginContext *ctx, const cell_t *params
     std::shared_ptr<spdlog::sinks::rotating_file_sink_st> sink;
     try
     {
-        sink = std::make_shared<spdlog::sinks::rotating_file_sink_st>(absPath, maxFileSize, maxFiles, rotateOnOpen, handlers);
+        auto rotatedHandlers = compress ? Log4sp::FileCompressor::RotatingHandlers(absPath, maxFiles) : spdlog::rotated_file_handlers{};
+        sink = std::make_shared<spdlog::sinks::rotating_file_sink_st>(absPath, maxFileSize, maxFiles, rotateOnOpen, handlers, rotatedHandlers);
+        sink->set_write_buffer(writeBufferSize, writeBufferInterval);
+        Log4sp::FlushScheduler::Instance().ScheduleWriteBuffer(sink);
     }
     catch (const std::exception &ex)
     {
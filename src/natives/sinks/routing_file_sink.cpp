@@ -0,0 +1,161 @@
+#include "log4sp/common.h"
+#include "log4sp/adapter/logger_handler.h"
+#include "log4sp/adapter/sink_handler.h"
+#include "log4sp/sinks/routing_file_sink.h"
+
+
+/**
+ * 封装读取 routing file sink handle 代码
+ * 这会创建 1 个变量: routingFileSink
+ *      读取成功时: 继续执行后续代码
+ *      读取失败时: 抛出错误并结束执行, 返回 0 (与 BAD_HANDLE 相同)
+ */
+#define READ_ROUTING_FILE_SINK_HANDLE_OR_ERROR(handle)                                              \
+    Log4sp::Sinks::RoutingFileSinkST *routingFileSink;                                              \
+    {                                                                                               \
+        SourceMod::HandleSecurity security(nullptr, myself->GetIdentity());                         \
+        SourceMod::HandleError error;                                                               \
+        auto sink = Log4sp::SinkHandler::Instance().ReadHandleRaw(handle, &security, &error);       \
+        if (!sink)                                                                                  \
+        {                                                                                           \
+            ctx->ReportError("Invalid Sink Handle %x (error code: %d)", handle, error);             \
+            return 0;                                                                               \
+        }                                                                                           \
+        routingFileSink = dynamic_cast<Log4sp::Sinks::RoutingFileSinkST *>(sink);                   \
+        if (!routingFileSink)                                                                       \
+        {                                                                                           \
+            ctx->ReportError("Invalid RoutingFileSink Handle %x.", handle);                         \
+            return 0;                                                                               \
+        }                                                                                           \
+    }
+
+
+static cell_t RoutingFileSink(SourcePawn::IPluginContext *ctx, const cell_t *params) noexcept
+{
+    char *pattern;
+    CTX_LOCAL_TO_STRING(params[1], &pattern);
+
+    char absPath[PLATFORM_MAX_PATH];
+    smutils->BuildPath(Path_Game, absPath, sizeof(absPath), "%s", pattern);
+
+    int key = params[2];
+    int maxOpenFiles = params[3];
+
+    using Key = Log4sp::Sinks::RoutingFileSinkST::Key;
+    if (key != static_cast<int>(Key::Plugin) && key != static_cast<int>(Key::LoggerName))
+    {
+        ctx->ReportError("Invalid routing key %d.", key);
+        return BAD_HANDLE;
+    }
+
+    if (maxOpenFiles <= 0)
+    {
+        ctx->ReportError("Invalid max open files %d.", maxOpenFiles);
+        return BAD_HANDLE;
+    }
+
+    std::shared_ptr<Log4sp::Sinks::RoutingFileSinkST> sink;
+    try
+    {
+        sink = std::make_shared<Log4sp::Sinks::RoutingFileSinkST>(absPath, static_cast<Key>(key), static_cast<std::size_t>(maxOpenFiles));
+    }
+    catch (const std::exception &ex)
+    {
+        ctx->ReportError(ex.what());
+        return BAD_HANDLE;
+    }
+
+    SourceMod::HandleSecurity security(nullptr, myself->GetIdentity());
+    SourceMod::HandleError error;
+
+    auto handle = Log4sp::SinkHandler::Instance().CreateHandle(sink, &security, nullptr, &error);
+    if (!handle)
+    {
+        ctx->ReportError("Failed to creates a RoutingFileSink Handle (error code: %d)", error);
+        return BAD_HANDLE;
+    }
+    return handle;
+}
+
+static cell_t RoutingFileSink_GetRouteCount(SourcePawn::IPluginContext *ctx, const cell_t *params) noexcept
+{
+    READ_ROUTING_FILE_SINK_HANDLE_OR_ERROR(params[1]);
+    CHECK_SINK_NOT_ASYNC_OR_ERROR(params[1], routingFileSink);
+
+    return static_cast<cell_t>(routingFileSink->GetRouteCount());
+}
+
+static cell_t RoutingFileSink_GetOpenFileCount(SourcePawn::IPluginContext *ctx, const cell_t *params) noexcept
+{
+    READ_ROUTING_FILE_SINK_HANDLE_OR_ERROR(params[1]);
+    CHECK_SINK_NOT_ASYNC_OR_ERROR(params[1], routingFileSink);
+
+    return static_cast<cell_t>(routingFileSink->GetOpenFileCount());
+}
+
+static cell_t RoutingFileSink_CreateLogger(SourcePawn::IPluginContext *ctx, const cell_t *params) noexcept
+{
+    char *name;
+    CTX_LOCAL_TO_STRING(params[1], &name);
+    if (Log4sp::LoggerHandler::Instance().FindHandle(name))
+    {
+        ctx->ReportError("Logger with name \"%s\" already exists.", name);
+        return BAD_HANDLE;
+    }
+
+    char *pattern;
+    CTX_LOCAL_TO_STRING(params[2], &pattern);
+
+    char absPath[PLATFORM_MAX_PATH];
+    smutils->BuildPath(Path_Game, absPath, sizeof(absPath), "%s", pattern);
+
+    int key = params[3];
+    int maxOpenFiles = params[4];
+
+    using Key = Log4sp::Sinks::RoutingFileSinkST::Key;
+    if (key != static_cast<int>(Key::Plugin) && key != static_cast<int>(Key::LoggerName))
+    {
+        ctx->ReportError("Invalid routing key %d.", key);
+        return BAD_HANDLE;
+    }
+
+    if (maxOpenFiles <= 0)
+    {
+        ctx->ReportError("Invalid max open files %d.", maxOpenFiles);
+        return BAD_HANDLE;
+    }
+
+    std::shared_ptr<Log4sp::Sinks::RoutingFileSinkST> sink;
+    try
+    {
+        sink = std::make_shared<Log4sp::Sinks::RoutingFileSinkST>(absPath, static_cast<Key>(key), static_cast<std::size_t>(maxOpenFiles));
+    }
+    catch (const std::exception &ex)
+    {
+        ctx->ReportError(ex.what());
+        return BAD_HANDLE;
+    }
+
+    SourceMod::HandleSecurity security(ctx->GetIdentity(), myself->GetIdentity());
+    SourceMod::HandleError error;
+
+    auto logger = std::make_shared<Log4sp::Logger>(name, sink);
+    auto handle = Log4sp::LoggerHandler::Instance().CreateHandle(logger, &security, nullptr, &error);
+    if (!handle)
+    {
+        ctx->ReportError("Failed to creates a Logger Handle (error code: %d)", error);
+        return BAD_HANDLE;
+    }
+    return handle;
+}
+
+const sp_nativeinfo_t RoutingFileSinkNatives[] =
+{
+    {"RoutingFileSink.RoutingFileSink",         RoutingFileSink},
+    {"RoutingFileSink.GetRouteCount",           RoutingFileSink_GetRouteCount},
+    {"RoutingFileSink.GetOpenFileCount",        RoutingFileSink_GetOpenFileCount},
+
+    {"RoutingFileSink.CreateLogger",            RoutingFileSink_CreateLogger},
+
+    {nullptr,                                   nullptr}
+};
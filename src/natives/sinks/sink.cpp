@@ -2,6 +2,7 @@
 #include "spdlog/pattern_formatter.h"
 
 #include "log4sp/common.h"
+#include "log4sp/adapter/logger_handler.h"
 #include "log4sp/adapter/sink_handler.h"
 
 
@@ -12,11 +13,11 @@
  *      读取失败时: 抛出错误并结束执行, 返回 0 (与 BAD_HANDLE 相同)
  */
 #define READ_SINK_HANDLE_OR_ERROR(handle)                                                           \
-    spdlog::sink_ptr sink;                                                                          \
+    spdlog::sinks::sink *sink;                                                                      \
     {                                                                                               \
         SourceMod::HandleSecurity security(nullptr, myself->GetIdentity());                         \
         SourceMod::HandleError error;                                                               \
-        sink = Log4sp::SinkHandler::Instance().ReadHandle(handle, &security, &error);               \
+        sink = Log4sp::SinkHandler::Instance().ReadHandleRaw(handle, &security, &error);            \
         if (!sink)                                                                                  \
         {                                                                                           \
             ctx->ReportError("Invalid Sink Handle %x (error code: %d)", handle, error);             \
@@ -24,6 +25,28 @@
         }                                                                                           \
     }
 
+/**
+ * 封装读取 sink handle 代码，并持有 sink 直到 native 结束
+ * 用于可能执行插件回调的 native (回调中插件可能关闭 handle)
+ * 这会创建 2 个变量: sinkPtr, sink
+ *      读取成功时: 继续执行后续代码
+ *      读取失败时: 抛出错误并结束执行, 返回 0 (与 BAD_HANDLE 相同)
+ */
+#define READ_SINK_HANDLE_SHARED_OR_ERROR(handle)                                                    \
+    spdlog::sink_ptr sinkPtr;                                                                       \
+    spdlog::sinks::sink *sink;                                                                      \
+    {                                                                                               \
+        SourceMod::HandleSecurity security(nullptr, myself->GetIdentity());                         \
+        SourceMod::HandleError error;                                                               \
+        sinkPtr = Log4sp::SinkHandler::Instance().ReadHandle(handle, &security, &error);            \
+        if (!sinkPtr)                                                                               \
+        {                                                                                           \
+            ctx->ReportError("Invalid Sink Handle %x (error code: %d)", handle, error);             \
+            return 0;                                                                               \
+        }                                                                                           \
+        sink = sinkPtr.get();                                                                       \
+    }
+
 
 static cell_t GetLevel(SourcePawn::IPluginContext *ctx, const cell_t *params) noexcept
 {
@@ -35,16 +58,26 @@ static cell_t GetLevel(SourcePawn::IPluginContext *ctx, const cell_t *params) no
 static cell_t SetLevel(SourcePawn::IPluginContext *ctx, const cell_t *params) noexcept
 {
     READ_SINK_HANDLE_OR_ERROR(params[1]);
+    CHECK_SINK_NOT_ASYNC_OR_ERROR(params[1], sink);
 
     auto lvl = Log4sp::NumToLvl(params[2]);
 
     sink->set_level(lvl);
+
+    // sink 可能属于多个 logger，更新它们缓存的 sinks 最低日志级别
+    Log4sp::LoggerHandler::Instance().ApplyAll(
+        [](std::shared_ptr<Log4sp::Logger> logger)
+        {
+            logger->UpdateSinkLevel();
+        }
+    );
     return 0;
 }
 
 static cell_t SetPattern(SourcePawn::IPluginContext *ctx, const cell_t *params) noexcept
 {
     READ_SINK_HANDLE_OR_ERROR(params[1]);
+    CHECK_SINK_NOT_ASYNC_OR_ERROR(params[1], sink);
 
     char *pattern;
     CTX_LOCAL_TO_STRING(params[2], &pattern);
@@ -53,6 +86,14 @@ static cell_t SetPattern(SourcePawn::IPluginContext *ctx, const cell_t *params)
 
     using spdlog::pattern_formatter;
     sink->set_formatter(std::make_unique<pattern_formatter>(pattern, type));
+
+    // sink 可能属于多个 logger，更新它们的共享格式化分组
+    Log4sp::LoggerHandler::Instance().ApplyAll(
+        [](std::shared_ptr<Log4sp::Logger> logger)
+        {
+            logger->UpdateSinkGroups();
+        }
+    );
     return 0;
 }
 
@@ -67,7 +108,8 @@ static cell_t ShouldLog(SourcePawn::IPluginContext *ctx, const cell_t *params) n
 
 static cell_t Log(SourcePawn::IPluginContext *ctx, const cell_t *params) noexcept
 {
-    READ_SINK_HANDLE_OR_ERROR(params[1]);
+    READ_SINK_HANDLE_SHARED_OR_ERROR(params[1]);
+    CHECK_SINK_NOT_ASYNC_OR_ERROR(params[1], sink);
 
     char *name, *msg, *file, *func;
     CTX_LOCAL_TO_STRING(params[2], &name);
@@ -106,6 +148,7 @@ static cell_t Log(SourcePawn::IPluginContext *ctx, const cell_t *params) noexcep
 static cell_t ToPattern(SourcePawn::IPluginContext *ctx, const cell_t *params) noexcept
 {
     READ_SINK_HANDLE_OR_ERROR(params[1]);
+    CHECK_SINK_NOT_ASYNC_OR_ERROR(params[1], sink);
 
     char *name, *msg, *file, *func;
     CTX_LOCAL_TO_STRING(params[4], &name);
@@ -148,7 +191,8 @@ static cell_t ToPattern(SourcePawn::IPluginContext *ctx, const cell_t *params) n
 
 static cell_t Flush(SourcePawn::IPluginContext *ctx, const cell_t *params) noexcept
 {
-    READ_SINK_HANDLE_OR_ERROR(params[1]);
+    READ_SINK_HANDLE_SHARED_OR_ERROR(params[1]);
+    CHECK_SINK_NOT_ASYNC_OR_ERROR(params[1], sink);
 
     try
     {
@@ -0,0 +1,128 @@
+#include "log4sp/common.h"
+#include "log4sp/adapter/logger_handler.h"
+#include "log4sp/adapter/sink_handler.h"
+#include "log4sp/sinks/split_file_sink.h"
+
+
+/**
+ * 封装读取 split file sink handle 代码
+ * 这会创建 1 个变量: splitFileSink
+ *      读取成功时: 继续执行后续代码
+ *      读取失败时: 抛出错误并结束执行, 返回 0 (与 BAD_HANDLE 相同)
+ */
+#define READ_SPLIT_FILE_SINK_HANDLE_OR_ERROR(handle)                                                \
+    Log4sp::Sinks::SplitFileSinkST *splitFileSink;                                                  \
+    {                                                                                               \
+        SourceMod::HandleSecurity security(nullptr, myself->GetIdentity());                         \
+        SourceMod::HandleError error;                                                               \
+        auto sink = Log4sp::SinkHandler::Instance().ReadHandleRaw(handle, &security, &error);       \
+        if (!sink)                                                                                  \
+        {                                                                                           \
+            ctx->ReportError("Invalid Sink Handle %x (error code: %d)", handle, error);             \
+            return 0;                                                                               \
+        }                                                                                           \
+        splitFileSink = dynamic_cast<Log4sp::Sinks::SplitFileSinkST *>(sink);                       \
+        if (!splitFileSink)                                                                         \
+        {                                                                                           \
+            ctx->ReportError("Invalid SplitFileSink Handle %x.", handle);                           \
+            return 0;                                                                               \
+        }                                                                                           \
+    }
+
+
+static cell_t SplitFileSink(SourcePawn::IPluginContext *ctx, const cell_t *params) noexcept
+{
+    SourceMod::HandleSecurity security(nullptr, myself->GetIdentity());
+    SourceMod::HandleError error;
+
+    auto sink = std::make_shared<Log4sp::Sinks::SplitFileSinkST>();
+    auto handle = Log4sp::SinkHandler::Instance().CreateHandle(sink, &security, nullptr, &error);
+    if (!handle)
+    {
+        ctx->ReportError("Failed to creates a SplitFileSink Handle (error code: %d)", error);
+        return BAD_HANDLE;
+    }
+    return handle;
+}
+
+static cell_t SplitFileSink_AddFile(SourcePawn::IPluginContext *ctx, const cell_t *params) noexcept
+{
+    READ_SPLIT_FILE_SINK_HANDLE_OR_ERROR(params[1]);
+    CHECK_SINK_NOT_ASYNC_OR_ERROR(params[1], splitFileSink);
+
+    char *file;
+    CTX_LOCAL_TO_STRING(params[2], &file);
+
+    char absPath[PLATFORM_MAX_PATH];
+    smutils->BuildPath(Path_Game, absPath, sizeof(absPath), "%s", file);
+
+    auto lvl = Log4sp::NumToLvl(params[3]);
+    auto truncate = static_cast<bool>(params[4]);
+
+    try
+    {
+        splitFileSink->AddFile(absPath, lvl, truncate);
+    }
+    catch (const std::exception &ex)
+    {
+        ctx->ReportError(ex.what());
+        return 0;
+    }
+
+    // sink 的级别随文件改变，sink 可能属于多个 logger，更新它们缓存的 sinks 最低日志级别
+    Log4sp::LoggerHandler::Instance().ApplyAll(
+        [](std::shared_ptr<Log4sp::Logger> logger)
+        {
+            logger->UpdateSinkLevel();
+        }
+    );
+    return 0;
+}
+
+static cell_t SplitFileSink_GetFileCount(SourcePawn::IPluginContext *ctx, const cell_t *params) noexcept
+{
+    READ_SPLIT_FILE_SINK_HANDLE_OR_ERROR(params[1]);
+
+    return static_cast<cell_t>(splitFileSink->GetFileCount());
+}
+
+static cell_t SplitFileSink_GetFilename(SourcePawn::IPluginContext *ctx, const cell_t *params) noexcept
+{
+    READ_SPLIT_FILE_SINK_HANDLE_OR_ERROR(params[1]);
+
+    int index = params[2];
+    if (index < 0 || static_cast<std::size_t>(index) >= splitFileSink->GetFileCount())
+    {
+        ctx->ReportError("Invalid file index %d.", index);
+        return 0;
+    }
+
+    std::size_t bytes = 0;
+    CTX_STRING_TO_LOCAL_UTF8(params[3], params[4], splitFileSink->GetFilename(index).c_str(), &bytes);
+    return static_cast<cell_t>(bytes);
+}
+
+static cell_t SplitFileSink_GetFileLevel(SourcePawn::IPluginContext *ctx, const cell_t *params) noexcept
+{
+    READ_SPLIT_FILE_SINK_HANDLE_OR_ERROR(params[1]);
+
+    int index = params[2];
+    if (index < 0 || static_cast<std::size_t>(index) >= splitFileSink->GetFileCount())
+    {
+        ctx->ReportError("Invalid file index %d.", index);
+        return 0;
+    }
+
+    return static_cast<cell_t>(splitFileSink->GetFileLevel(index));
+}
+
+const sp_nativeinfo_t SplitFileSinkNatives[] =
+{
+    {"SplitFileSink.SplitFileSink",             SplitFileSink},
+    {"SplitFileSink.AddFile",                   SplitFileSink_AddFile},
+    {"SplitFileSink.GetFileCount",              SplitFileSink_GetFileCount},
+    {"SplitFileSink.GetFilename",               SplitFileSink_GetFilename},
+    {"SplitFileSink.GetFileLevel",              SplitFileSink_GetFileLevel},
+
+    {nullptr,                                   nullptr}
+};
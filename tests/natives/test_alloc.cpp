@@ -0,0 +1,87 @@
+#include <cstdlib>
+#include <new>
+
+#include "extension.h"
+
+
+/**
+ * 分配计数模式
+ *
+ * 替换拓展自身的全局 operator new，统计当前线程在计数期间的堆分配次数
+ * 用于证明格式化日志的热路径在稳定状态下不会分配堆内存
+ *
+ * 只统计拓展模块内的分配 (SourceMod 与 SourcePawn 有各自的分配器)
+ */
+static thread_local bool         t_AllocCounting = false;
+static thread_local unsigned int t_AllocCounter  = 0;
+
+
+void *operator new(std::size_t size)
+{
+    if (t_AllocCounting)
+        ++t_AllocCounter;
+
+    if (void *ptr = std::malloc(size ? size : 1))
+        return ptr;
+    throw std::bad_alloc();
+}
+
+void *operator new[](std::size_t size)
+{
+    return ::operator new(size);
+}
+
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept
+{
+    if (t_AllocCounting)
+        ++t_AllocCounter;
+
+    return std::malloc(size ? size : 1);
+}
+
+void *operator new[](std::size_t size, const std::nothrow_t &tag) noexcept
+{
+    return ::operator new(size, tag);
+}
+
+void operator delete(void *ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete[](void *ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void *ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete[](void *ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
+
+
+static cell_t TestAllocCountStart(SourcePawn::IPluginContext *ctx, const cell_t *params) noexcept
+{
+    t_AllocCounter = 0;
+    t_AllocCounting = true;
+    return 0;
+}
+
+static cell_t TestAllocCountStop(SourcePawn::IPluginContext *ctx, const cell_t *params) noexcept
+{
+    t_AllocCounting = false;
+    return static_cast<cell_t>(t_AllocCounter);
+}
+
+const sp_nativeinfo_t TestAllocNatives[] =
+{
+    {"TestAllocCountStart",                         TestAllocCountStart},
+    {"TestAllocCountStop",                          TestAllocCountStop},
+
+    {nullptr,                                       nullptr}
+};
@@ -0,0 +1,25 @@
+#include "log4sp/format.h"
+
+
+static cell_t TestFormatFloat(SourcePawn::IPluginContext *ctx, const cell_t *params) noexcept
+{
+    auto value  = sp_ctof(params[3]);
+    auto width  = static_cast<unsigned int>(params[4]);
+    auto prec   = static_cast<int>(params[5]);
+    auto legacy = static_cast<bool>(params[6]);
+
+    spdlog::memory_buf_t out;
+    Log4sp::FormatFloat(out, value, width, prec, legacy);
+    out.push_back('\0');
+
+    std::size_t bytes = 0;
+    CTX_STRING_TO_LOCAL_UTF8(params[1], params[2], out.data(), &bytes);
+    return static_cast<cell_t>(bytes);
+}
+
+const sp_nativeinfo_t TestFormatNatives[] =
+{
+    {"TestFormatFloat",                             TestFormatFloat},
+
+    {nullptr,                                       nullptr}
+};
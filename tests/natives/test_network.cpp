@@ -0,0 +1,159 @@
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+#ifdef _WIN32
+    #ifndef NOMINMAX
+        #define NOMINMAX
+    #endif
+    #include <winsock2.h>
+    #include <ws2tcpip.h>
+#else
+    #include <arpa/inet.h>
+    #include <netinet/in.h>
+    #include <poll.h>
+    #include <sys/socket.h>
+    #include <unistd.h>
+#endif
+
+#include "log4sp/common.h"
+
+
+/**
+ * 回环地址上的 UDP / TCP 监听端，用于验证 UdpSink 与 TcpSink 实际发送的数据
+ * 同一时间只有一个监听端，接收在游戏线程中阻塞进行 (仅用于测试)
+ */
+#ifdef _WIN32
+using Socket = SOCKET;
+constexpr Socket InvalidSocket = INVALID_SOCKET;
+static void CloseSocket(Socket socket) noexcept { ::closesocket(socket); }
+#else
+using Socket = int;
+constexpr Socket InvalidSocket = -1;
+static void CloseSocket(Socket socket) noexcept { ::close(socket); }
+#endif
+
+static Socket s_Listener = InvalidSocket;
+static Socket s_Connection = InvalidSocket;     // TCP 接受的连接
+static bool s_Tcp = false;
+
+[[nodiscard]]
+static bool WaitReadable(Socket socket, std::chrono::milliseconds timeout) noexcept
+{
+#ifdef _WIN32
+    WSAPOLLFD fd{socket, POLLRDNORM, 0};
+    return ::WSAPoll(&fd, 1, static_cast<INT>(timeout.count())) == 1;
+#else
+    pollfd fd{socket, POLLIN, 0};
+    return ::poll(&fd, 1, static_cast<int>(timeout.count())) == 1;
+#endif
+}
+
+static void CloseListener() noexcept
+{
+    if (s_Connection != InvalidSocket)
+        CloseSocket(s_Connection);
+    if (s_Listener != InvalidSocket)
+    {
+        CloseSocket(s_Listener);
+#ifdef _WIN32
+        ::WSACleanup();
+#endif
+    }
+    s_Connection = InvalidSocket;
+    s_Listener = InvalidSocket;
+}
+
+static cell_t TestNetworkListen(SourcePawn::IPluginContext *ctx, const cell_t *params) noexcept
+{
+    CloseListener();
+
+#ifdef _WIN32
+    WSADATA data;
+    if (::WSAStartup(MAKEWORD(2, 2), &data) != 0)
+    {
+        ctx->ReportError("WSAStartup failed.");
+        return 0;
+    }
+#endif
+
+    s_Tcp = static_cast<bool>(params[1]);
+    s_Listener = ::socket(AF_INET, s_Tcp ? SOCK_STREAM : SOCK_DGRAM, s_Tcp ? IPPROTO_TCP : IPPROTO_UDP);
+
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = 0;                          // 由系统分配端口
+    socklen_t length = sizeof(addr);
+
+    if (s_Listener == InvalidSocket ||
+        ::bind(s_Listener, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) != 0 ||
+        (s_Tcp && ::listen(s_Listener, 1) != 0) ||
+        ::getsockname(s_Listener, reinterpret_cast<sockaddr *>(&addr), &length) != 0)
+    {
+#ifdef _WIN32
+        if (s_Listener == InvalidSocket)
+            ::WSACleanup();
+#endif
+        CloseListener();
+        ctx->ReportError("Failed to create the test listener.");
+        return 0;
+    }
+
+    return static_cast<cell_t>(ntohs(addr.sin_port));
+}
+
+static cell_t TestNetworkReceive(SourcePawn::IPluginContext *ctx, const cell_t *params) noexcept
+{
+    auto maxlen = static_cast<std::size_t>(params[2]);
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(params[3]);
+
+    if (s_Listener == InvalidSocket || maxlen == 0)
+        return 0;
+
+    std::string buffer(maxlen, '\0');
+
+    auto remaining = [deadline]() {
+        auto left = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+        return left.count() > 0 ? left : std::chrono::milliseconds{0};
+    };
+
+    if (s_Tcp && s_Connection == InvalidSocket)
+    {
+        if (WaitReadable(s_Listener, remaining()))
+            s_Connection = ::accept(s_Listener, nullptr, nullptr);
+    }
+
+    // 收到第一段数据后再等待一小段时间，TCP 的数据可能分多次到达
+    Socket socket = s_Tcp ? s_Connection : s_Listener;
+    std::size_t received = 0;
+    while (socket != InvalidSocket && received + 1 < maxlen &&
+           WaitReadable(socket, received ? std::chrono::milliseconds{50} : remaining()))
+    {
+        auto n = ::recv(socket, &buffer[received], static_cast<int>(maxlen - 1 - received), 0);
+        if (n <= 0)
+            break;
+        received += static_cast<std::size_t>(n);
+    }
+
+    buffer.resize(received);
+
+    std::size_t bytes = 0;
+    CTX_STRING_TO_LOCAL_UTF8(params[1], params[2], buffer.c_str(), &bytes);
+    return static_cast<cell_t>(bytes);
+}
+
+static cell_t TestNetworkClose(SourcePawn::IPluginContext *ctx, const cell_t *params) noexcept
+{
+    CloseListener();
+    return 0;
+}
+
+const sp_nativeinfo_t TestNetworkNatives[] =
+{
+    {"TestNetworkListen",                           TestNetworkListen},
+    {"TestNetworkReceive",                          TestNetworkReceive},
+    {"TestNetworkClose",                            TestNetworkClose},
+
+    {nullptr,                                       nullptr}
+};
@@ -5,6 +5,7 @@
 #include "log4sp/adapter/sink_handler.h"
 
 
+// Drain* 会执行插件回调 (回调中插件可能关闭 handle)，所以持有 sink 直到 native 结束
 #define READ_TEST_SINK_HANDLE_OR_ERROR(handle)                                                      \
     SourceMod::HandleSecurity security(nullptr, myself->GetIdentity());                             \
     SourceMod::HandleError error;                                                                   \
@@ -74,15 +74,21 @@ public:
     void SetFlushException(const std::runtime_error &ex) noexcept { m_FlushExceptionPtr = std::make_exception_ptr(ex); }
     void ClearFlushException() noexcept { m_FlushExceptionPtr = nullptr; }
 
+    [[nodiscard]] bool accepts_formatted() const override { return true; }
+
 protected:
     void sink_it_(const LogMsg &msg) override {
+        spdlog::memory_buf_t formatted;
+        spdlog::sinks::base_sink<Mutex>::formatter_->format(msg, formatted);
+        sink_formatted_(msg, formatted);
+    }
+
+    void sink_formatted_(const LogMsg &msg, const spdlog::memory_buf_t &formatted) override {
         if (m_LogExceptionPtr)
             std::rethrow_exception(m_LogExceptionPtr);
 
         m_Msgs.emplace_back(LogMsgBuffer(msg));
 
-        spdlog::memory_buf_t formatted;
-        spdlog::sinks::base_sink<Mutex>::formatter_->format(msg, formatted);
         // save the line without the eol
         auto eol_len = strlen(spdlog::details::os::default_eol);
         m_Lines.emplace_back(formatted.begin(), formatted.end() - eol_len);
@@ -0,0 +1,200 @@
+/**
+ * BinaryFileSink 二进制日志的离线解码工具
+ *
+ * 用法: binlog_decode <file> [pattern]
+ *      pattern     spdlog 的 pattern，默认为 "[%Y-%m-%d %H:%M:%S.%e] [%n] [%l] %v"
+ *
+ * 延迟格式化的消息使用与扩展相同的格式化实现 (log4sp/format_kernel.h) 渲染，输出写入 stdout
+ */
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+#include "spdlog/pattern_formatter.h"
+
+#include "log4sp/format_kernel.h"
+#include "log4sp/sinks/binary_file_sink.h"
+
+
+namespace {
+
+using Log4sp::Sinks::BinaryLog::RecordType;
+
+class Reader final
+{
+public:
+    explicit Reader(std::string_view data) noexcept : m_Data(data) {}
+
+    [[nodiscard]] bool AtEnd() const noexcept { return m_Pos == m_Data.size(); }
+    [[nodiscard]] std::size_t Offset() const noexcept { return m_Pos; }
+
+    template <typename T>
+    [[nodiscard]] T Get() {
+        T value;
+        std::memcpy(&value, Take(sizeof(T)), sizeof(T));
+        return value;
+    }
+
+    [[nodiscard]] std::string_view GetString() {
+        auto size = Get<std::uint32_t>();
+        return {Take(size), size};
+    }
+
+    [[nodiscard]] const char *Take(std::size_t size) {
+        if (m_Data.size() - m_Pos < size)
+            spdlog::throw_spdlog_ex("unexpected end of file");
+
+        const char *data = m_Data.data() + m_Pos;
+        m_Pos += size;
+        return data;
+    }
+
+private:
+    std::string_view m_Data;
+    std::size_t m_Pos{0};
+};
+
+[[nodiscard]]
+spdlog::log_clock::time_point ToTime(std::int64_t ns) noexcept
+{
+    using std::chrono::duration_cast;
+    return spdlog::log_clock::time_point(duration_cast<spdlog::log_clock::duration>(std::chrono::nanoseconds(ns)));
+}
+
+[[nodiscard]]
+spdlog::level::level_enum ToLevel(std::uint8_t lvl)
+{
+    if (lvl >= spdlog::level::n_levels)
+        spdlog::throw_spdlog_ex("invalid level " + std::to_string(lvl));
+    return static_cast<spdlog::level::level_enum>(lvl);
+}
+
+template <typename Map>
+[[nodiscard]]
+const typename Map::mapped_type &Lookup(const Map &map, std::uint32_t id, const char *what)
+{
+    auto iter = map.find(id);
+    if (iter == map.end())
+        spdlog::throw_spdlog_ex(std::string("undefined ") + what + " id " + std::to_string(id));
+    return iter->second;
+}
+
+void Decode(std::string_view data, spdlog::formatter &formatter)
+{
+    using namespace Log4sp;
+
+    Reader reader(data);
+
+    if (std::memcmp(reader.Take(sizeof(Sinks::BinaryLog::Magic)), Sinks::BinaryLog::Magic, sizeof(Sinks::BinaryLog::Magic)) != 0)
+        spdlog::throw_spdlog_ex("not a log4sp binary log");
+
+    auto version = reader.Get<std::uint32_t>();
+    if (version != Sinks::BinaryLog::Version)
+        spdlog::throw_spdlog_ex("unsupported version " + std::to_string(version));
+
+    std::unordered_map<std::uint32_t, std::string> loggers;
+    std::unordered_map<std::uint32_t, std::shared_ptr<const CompiledFormat>> formats;
+    spdlog::memory_buf_t payload;
+    spdlog::memory_buf_t line;
+
+    auto output = [&formatter, &line](const spdlog::details::log_msg &msg)
+    {
+        line.clear();
+        formatter.format(msg, line);
+        std::fwrite(line.data(), 1, line.size(), stdout);
+    };
+
+    while (!reader.AtEnd())
+    {
+        auto offset = reader.Offset();
+        try
+        {
+            auto type = static_cast<RecordType>(reader.Get<std::uint8_t>());
+            switch (type)
+            {
+            case RecordType::Logger:
+                {
+                    auto id = reader.Get<std::uint32_t>();
+                    loggers[id] = std::string(reader.GetString());
+                    break;
+                }
+            case RecordType::Format:
+                {
+                    auto id = reader.Get<std::uint32_t>();
+                    formats[id] = CompileFormat(reader.GetString());
+                    break;
+                }
+            case RecordType::Deferred:
+                {
+                    auto time = ToTime(reader.Get<std::int64_t>());
+                    auto lvl = ToLevel(reader.Get<std::uint8_t>());
+                    const std::string &name = Lookup(loggers, reader.Get<std::uint32_t>(), "logger");
+                    const auto &format = Lookup(formats, reader.Get<std::uint32_t>(), "format");
+                    auto args = reader.GetString();
+
+                    payload.clear();
+                    RenderCaptured(payload, *format, args);
+                    output(spdlog::details::log_msg(time, spdlog::source_loc{}, name, lvl, {payload.data(), payload.size()}));
+                    break;
+                }
+            case RecordType::Text:
+                {
+                    auto time = ToTime(reader.Get<std::int64_t>());
+                    auto lvl = ToLevel(reader.Get<std::uint8_t>());
+                    const std::string &name = Lookup(loggers, reader.Get<std::uint32_t>(), "logger");
+                    auto text = reader.GetString();
+
+                    output(spdlog::details::log_msg(time, spdlog::source_loc{}, name, lvl, {text.data(), text.size()}));
+                    break;
+                }
+            default:
+                spdlog::throw_spdlog_ex("unknown record type " + std::to_string(static_cast<int>(type)));
+            }
+        }
+        catch (const std::exception &ex)
+        {
+            spdlog::throw_spdlog_ex(std::string(ex.what()) + " (record at offset " + std::to_string(offset) + ")");
+        }
+    }
+}
+
+}       // namespace
+
+
+int main(int argc, char **argv)
+{
+    if (argc < 2 || argc > 3)
+    {
+        std::fprintf(stderr, "Usage: %s <file> [pattern]\n", argv[0]);
+        return 2;
+    }
+
+    std::ifstream file(argv[1], std::ios::binary);
+    if (!file)
+    {
+        std::fprintf(stderr, "binlog_decode: failed to open %s\n", argv[1]);
+        return 1;
+    }
+    std::string data{std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+
+    try
+    {
+        auto formatter = (argc == 3) ? std::make_unique<spdlog::pattern_formatter>(argv[2])
+                                     : std::make_unique<spdlog::pattern_formatter>();
+        Decode(data, *formatter);
+    }
+    catch (const std::exception &ex)
+    {
+        std::fflush(stdout);
+        std::fprintf(stderr, "binlog_decode: %s: %s\n", argv[1], ex.what());
+        return 1;
+    }
+    return 0;
+}